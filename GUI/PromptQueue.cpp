@@ -0,0 +1,74 @@
+// ronamsalem4@gmail.com
+#include "PromptQueue.hpp"
+#include <stdexcept>
+
+namespace coup
+{
+    PromptQueue::PromptQueue(std::chrono::milliseconds timeout) : timeout(timeout) {}
+
+    /**
+     * @param seat ---> A seat played by a bot.
+     * @param decide ---> Returns the index of the chosen option.
+     */
+    void PromptQueue::setBot(const Player *seat, Bot decide)
+    {
+        bots[seat] = std::move(decide);
+    }
+
+    /**
+     * Queues a question for a human seat, or lets the seat's bot answer it immediately.
+     * The deadline of a queued question starts counting when it is asked.
+     */
+    void PromptQueue::ask(Player *who, const std::string &question, std::vector<std::string> options, std::size_t defaultOption,
+                          std::function<void(std::size_t)> then)
+    {
+        if (defaultOption >= options.size())
+            throw std::invalid_argument("Default answer is not one of the options.");
+        Prompt prompt{who, question, std::move(options), defaultOption, Clock::now() + timeout, std::move(then)};
+        auto bot = bots.find(who);
+        if (bot != bots.end())
+        {
+            std::size_t choice = bot->second(prompt);
+            prompt.then(choice < prompt.options.size() ? choice : prompt.defaultOption);
+            return;
+        }
+        pending.push_back(std::move(prompt));
+    }
+
+    const PromptQueue::Prompt &PromptQueue::current() const
+    {
+        if (pending.empty())
+            throw std::logic_error("No open question.");
+        return pending.front();
+    }
+
+    /**
+     * The question is removed before its continuation runs, so the continuation may ask a new one.
+     */
+    void PromptQueue::answer(std::size_t option)
+    {
+        if (pending.empty() || option >= pending.front().options.size())
+            throw std::out_of_range("No such answer.");
+        Prompt prompt = std::move(pending.front());
+        pending.pop_front();
+        if (!pending.empty())
+            pending.front().deadline = Clock::now() + timeout; // the next question gets its full time
+        prompt.then(option);
+    }
+
+    bool PromptQueue::update(Clock::time_point now)
+    {
+        if (pending.empty() || now < pending.front().deadline)
+            return false;
+        answer(pending.front().defaultOption);
+        return true;
+    }
+
+    int PromptQueue::secondsLeft(Clock::time_point now) const
+    {
+        if (pending.empty() || now >= pending.front().deadline)
+            return 0;
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(pending.front().deadline - now).count();
+        return static_cast<int>((left + 999) / 1000);
+    }
+}
@@ -0,0 +1,77 @@
+// ronamsalem4@gmail.com
+#ifndef PROMPTQUEUE_HPP
+#define PROMPTQUEUE_HPP
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "../game/Player.hpp"
+
+/**
+ * @class PromptQueue
+ * Questions the GUI asks a player in the middle of someone else's action ("block the coup?", "which action to sanction?").
+ * Instead of waiting on the terminal, a question is queued with a default answer and a deadline; the frame loop
+ * shows the current question in the window, passes clicks to answer(), and calls update() so a question nobody
+ * answered in time resolves to its default. Seats played by bots answer instantly when the question is asked.
+ * Nothing here ever blocks.
+ */
+namespace coup
+{
+    class PromptQueue
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Prompt
+        {
+            Player *who;                           // The player who has to answer.
+            std::string question;                  // Shown in the prompt panel.
+            std::vector<std::string> options;      // The possible answers, e.g. {"yes", "no"}.
+            std::size_t defaultOption;             // Chosen when the deadline passes.
+            Clock::time_point deadline;            // When the default is taken.
+            std::function<void(std::size_t)> then; // Continues the action with the chosen option.
+        };
+
+        using Bot = std::function<std::size_t(const Prompt &)>; // Chooses an option for a bot seat, instantly.
+
+        /**
+         * @param timeout ---> How long a human player has to answer before the default is taken.
+         */
+        explicit PromptQueue(std::chrono::milliseconds timeout);
+
+        void setBot(const Player *seat, Bot decide); // From now on the seat's questions are answered by decide().
+
+        /**
+         * Asks a question. A bot seat answers right away (then runs before ask() returns);
+         * otherwise the question waits in the queue until answered or timed out.
+         */
+        void ask(Player *who, const std::string &question, std::vector<std::string> options, std::size_t defaultOption,
+                 std::function<void(std::size_t)> then);
+
+        bool active() const { return !pending.empty(); } // @return ---> true while a question waits for an answer.
+        const Prompt &current() const;                     // @return ---> The question shown now. @throws ---> logic_error if none.
+
+        /**
+         * Answers the current question and runs its continuation.
+         * @throws ---> out_of_range for an invalid option; whatever the continuation throws.
+         */
+        void answer(std::size_t option);
+
+        /**
+         * Takes the default answer of the current question if its deadline passed.
+         * @return ---> true if a question was resolved.
+         */
+        bool update(Clock::time_point now = Clock::now());
+
+        int secondsLeft(Clock::time_point now = Clock::now()) const; // @return ---> Whole seconds until the current default (0 if none).
+
+    private:
+        std::chrono::milliseconds timeout;
+        std::deque<Prompt> pending;
+        std::map<const Player *, Bot> bots;
+    };
+}
+
+#endif
@@ -0,0 +1,114 @@
+// ronamsalem4@gmail.com
+#include "TextBatch.hpp"
+#include <algorithm>
+
+/**
+ * Decodes the next UTF-8 code point of the text; invalid bytes are returned as they are.
+ * @param it ---> Position in the text, moved past the code point.
+ */
+static sf::Uint32 nextCodePoint(std::string::const_iterator &it, std::string::const_iterator end)
+{
+    unsigned char lead = static_cast<unsigned char>(*it++);
+    int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+    sf::Uint32 cp = extra == 0 ? lead : lead & (0x3F >> extra);
+    for (; extra > 0 && it != end; --extra)
+        cp = (cp << 6) | (static_cast<unsigned char>(*it++) & 0x3F);
+    return cp;
+}
+
+TextBatch::TextBatch(const sf::Font &font) : font(font), vertices(sf::Triangles)
+{
+    for (sf::Uint32 c = 32; c < 127; ++c)
+    {
+        font.getGlyph(c, BASE_SIZE, false);
+        font.getGlyph(c, BASE_SIZE, true);
+    }
+}
+
+void TextBatch::clear()
+{
+    vertices.clear();
+}
+
+/**
+ * Lays out the glyphs on a baseline at position.y + characterSize, as sf::Text does,
+ * scaling the atlas glyphs by characterSize / BASE_SIZE.
+ */
+sf::FloatRect TextBatch::add(const std::string &text, sf::Vector2f position, unsigned characterSize, const sf::Color &color, bool bold)
+{
+    float scale = static_cast<float>(characterSize) / BASE_SIZE;
+    float lineSpacing = font.getLineSpacing(BASE_SIZE) * scale;
+    float x = position.x;
+    float y = position.y + characterSize;
+    float right = x, bottom = y;
+    sf::Uint32 previous = 0;
+
+    for (std::string::const_iterator it = text.begin(); it != text.end();)
+    {
+        sf::Uint32 c = nextCodePoint(it, text.end());
+        if (c == '\n')
+        {
+            x = position.x;
+            y += lineSpacing;
+            previous = 0;
+            continue;
+        }
+        x += font.getKerning(previous, c, BASE_SIZE) * scale;
+        previous = c;
+
+        const sf::Glyph &glyph = font.getGlyph(c, BASE_SIZE, bold); // already in the atlas for ASCII
+        float left = x + glyph.bounds.left * scale;
+        float top = y + glyph.bounds.top * scale;
+        float w = glyph.bounds.width * scale;
+        float h = glyph.bounds.height * scale;
+        float u = static_cast<float>(glyph.textureRect.left);
+        float v = static_cast<float>(glyph.textureRect.top);
+        float uw = static_cast<float>(glyph.textureRect.width);
+        float vh = static_cast<float>(glyph.textureRect.height);
+
+        sf::Vertex a(sf::Vector2f(left, top), color, sf::Vector2f(u, v));
+        sf::Vertex b(sf::Vector2f(left + w, top), color, sf::Vector2f(u + uw, v));
+        sf::Vertex d(sf::Vector2f(left + w, top + h), color, sf::Vector2f(u + uw, v + vh));
+        sf::Vertex e(sf::Vector2f(left, top + h), color, sf::Vector2f(u, v + vh));
+        vertices.append(a);
+        vertices.append(b);
+        vertices.append(d);
+        vertices.append(a);
+        vertices.append(d);
+        vertices.append(e);
+
+        x += glyph.advance * scale;
+        right = std::max(right, x);
+        bottom = std::max(bottom, top + h);
+    }
+    return sf::FloatRect(position.x, position.y, right - position.x, bottom - position.y);
+}
+
+void TextBatch::draw(sf::RenderTarget &target) const
+{
+    sf::RenderStates states;
+    states.texture = &font.getTexture(BASE_SIZE);
+    target.draw(vertices, states);
+}
+
+void appendQuad(sf::VertexArray &batch, const sf::FloatRect &rect, const sf::Color &color)
+{
+    sf::Vector2f a(rect.left, rect.top), b(rect.left + rect.width, rect.top);
+    sf::Vector2f c(rect.left + rect.width, rect.top + rect.height), d(rect.left, rect.top + rect.height);
+    batch.append(sf::Vertex(a, color));
+    batch.append(sf::Vertex(b, color));
+    batch.append(sf::Vertex(c, color));
+    batch.append(sf::Vertex(a, color));
+    batch.append(sf::Vertex(c, color));
+    batch.append(sf::Vertex(d, color));
+}
+
+void appendRect(sf::VertexArray &batch, const sf::RectangleShape &shape)
+{
+    sf::Vector2f pos = shape.getPosition();
+    sf::Vector2f size = shape.getSize();
+    float t = shape.getOutlineThickness();
+    if (t > 0)
+        appendQuad(batch, sf::FloatRect(pos.x - t, pos.y - t, size.x + 2 * t, size.y + 2 * t), shape.getOutlineColor());
+    appendQuad(batch, sf::FloatRect(pos.x, pos.y, size.x, size.y), shape.getFillColor());
+}
@@ -0,0 +1,59 @@
+// ronamsalem4@gmail.com
+#ifndef TEXTBATCH_HPP
+#define TEXTBATCH_HPP
+#include <SFML/Graphics.hpp>
+#include <string>
+
+/**
+ * @class TextBatch
+ * Draws many strings with a single draw call.
+ * All glyphs come from one atlas: the font's texture page of BASE_SIZE, prebuilt with the printable ASCII
+ * characters (regular and bold) when the batch is created. Other character sizes are the same glyphs scaled,
+ * so every string of the HUD shares one texture and ends up in one sf::VertexArray.
+ */
+class TextBatch
+{
+public:
+    static constexpr unsigned BASE_SIZE = 32; // Character size of the atlas; other sizes are scaled from it.
+
+    /**
+     * Prebuilds the atlas of the given font.
+     * @param font ---> The font to draw with; must outlive the batch.
+     */
+    explicit TextBatch(const sf::Font &font);
+
+    void clear(); // Removes all strings (keeps the vertex memory).
+
+    /**
+     * Appends a string, laid out like an sf::Text with the same position and character size.
+     * @param text ---> UTF-8 text; '\n' starts a new line.
+     * @param position ---> Top-left corner of the text.
+     * @param characterSize ---> Size in pixels, as for sf::Text::setCharacterSize.
+     * @param color ---> Fill color.
+     * @param bold ---> Use the bold glyphs.
+     * @return ---> Bounds of the appended text.
+     */
+    sf::FloatRect add(const std::string &text, sf::Vector2f position, unsigned characterSize, const sf::Color &color, bool bold = false);
+
+    void draw(sf::RenderTarget &target) const; // Draws every appended string (one draw call).
+
+    std::size_t size() const { return vertices.getVertexCount() / 6; } // @return ---> Number of glyph quads in the batch.
+
+private:
+    const sf::Font &font;
+    sf::VertexArray vertices;
+};
+
+/**
+ * Appends a filled rectangle (two triangles) to an sf::Triangles vertex array.
+ */
+void appendQuad(sf::VertexArray &batch, const sf::FloatRect &rect, const sf::Color &color);
+
+/**
+ * Appends a rectangle shape (outline first, then fill) to an sf::Triangles vertex array,
+ * so many boxes can be drawn with a single draw call.
+ * @param shape ---> The rectangle to copy position, size, colors and outline thickness from.
+ */
+void appendRect(sf::VertexArray &batch, const sf::RectangleShape &shape);
+
+#endif
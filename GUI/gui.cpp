@@ -2,11 +2,11 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <map>
 #include <thread>
 #include <chrono>
 #include <cstdlib>
-#include <set>
+#include <mutex>
+#include <condition_variable>
 #include "../game/Game.hpp"
 #include "../roles/Governor.hpp"
 #include "../roles/Spy.hpp"
@@ -14,6 +14,14 @@
 #include "../roles/General.hpp"
 #include "../roles/Judge.hpp"
 #include "Merchant.hpp"
+#include "TextBatch.hpp"
+#include "PromptQueue.hpp"
+#include "../sim/GameState.hpp"
+#include "../sim/TripleBuffer.hpp"
+#include "../sim/RandomBot.hpp"
+#include "../game/Moves.hpp"
+#include "../game/Logger.hpp"
+#include <functional>
 /**
  *  Graphical User Interface for the Coup strategy game.
  * This file implements the main graphical interface of the game using the SFML library.
@@ -27,7 +35,10 @@
  * - Rule enforcement (e.g. blocking, sanctions, extra turns)
  * It also includes logic for handling user input (mouse clicks), displaying win popups,
  * and coordinating GUI elements with the underlying game logic.
- *A player's choice of whether to block any action is made through the terminal.
+ *A player's choice of whether to block any action is made in the window (see PromptQueue); unanswered questions time out to a default.
+ * Threads: the engine thread owns the Game, the prompts and the AI seats, and publishes an immutable GUISnapshot
+ * through a TripleBuffer after every change. The render thread only reads snapshots and sends clicks back as
+ * UICommands, so an AI seat that thinks for seconds never stalls the frame loop.
  */
 
 using namespace coup;
@@ -36,165 +47,226 @@ using namespace std;
 const int WIDTH = 1280;
 const int HEIGHT = 900;
 
-Player *lastArrestedBy = nullptr;
-Player *lastArrestedTarget = nullptr;
+struct GUIPlayer
+{
+    size_t seat;
+    sf::RectangleShape box;
+};
 
-string lastPlayerWatchedCoins = "";
-set<string> arrestedBanSet;
+/**
+ * Everything the render thread draws, copied by the engine thread after each change.
+ * The render thread never touches the Game: it reads the snapshot it last took from the TripleBuffer.
+ */
+struct GUISnapshot
+{
+    GameState table;
+    bool showCoins[Game::MAX_PLAYERS] = {}; // coins revealed by a Spy's watch
+    string log;
+    string winnerName;
+    bool showPopup = false;
+    string thinking; // name of the AI seat choosing its move, empty otherwise
+    bool promptActive = false;
+    string promptQuestion;
+    vector<string> promptOptions;
+    size_t promptDefault = 0;
+    int promptSecondsLeft = 0;
+};
 
-string lastTurnPlayer = "";
-int turnCounter = 0;
-map<string, pair<string, int>> blockedActions; // player -> (action, unblock turn)
+/**
+ * A click, already hit-tested by the render thread, for the engine thread to act on.
+ */
+struct UICommand
+{
+    enum Kind
+    {
+        Button,      // index: the action button
+        Target,      // index: the seat of the clicked player
+        PromptOption // index: the answer of the open question
+    } kind;
+    size_t index;
+};
 
-struct GUIPlayer
+/**
+ * Commands from the render thread to the engine thread. Clicks are rare, so a mutex is enough here.
+ */
+class CommandQueue
 {
-    Player *logic;
-    sf::RectangleShape box;
-    sf::Text nameText, roleText, coinText;
-    bool showCoins = false;
+public:
+    void push(const UICommand &command)
+    {
+        {
+            lock_guard<mutex> lock(m);
+            pending.push_back(command);
+        }
+        ready.notify_one();
+    }
+
+    /**
+     * Waits up to `timeout` for commands (or close()), then moves all queued commands into `out`.
+     * @return ---> false once the queue was closed.
+     */
+    bool waitAndTake(vector<UICommand> &out, chrono::milliseconds timeout)
+    {
+        unique_lock<mutex> lock(m);
+        ready.wait_for(lock, timeout, [this]
+                       { return !pending.empty() || closed; });
+        out.swap(pending);
+        pending.clear();
+        return !closed;
+    }
+
+    void close()
+    {
+        {
+            lock_guard<mutex> lock(m);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+private:
+    mutex m;
+    condition_variable ready;
+    vector<UICommand> pending;
+    bool closed = false;
 };
 
-GUIPlayer createGUIPlayer(Player *player, sf::Font &font, float x, float y, const sf::Color &color)
+GUIPlayer createGUIPlayer(size_t seat, float x, float y, const sf::Color &color)
 {
     GUIPlayer gui;
-    gui.logic = player;
+    gui.seat = seat;
     gui.box.setSize(sf::Vector2f(200, 90));
     gui.box.setPosition(x, y);
     gui.box.setFillColor(color);
     gui.box.setOutlineColor(sf::Color::Black);
     gui.box.setOutlineThickness(2);
-    gui.nameText.setFont(font);
-    gui.nameText.setCharacterSize(18);
-    gui.nameText.setFillColor(sf::Color::Black);
-    gui.nameText.setString(player->GetName());
-    gui.nameText.setPosition(x + 10, y + 10);
-    gui.roleText.setFont(font);
-    gui.roleText.setCharacterSize(16);
-    gui.roleText.setFillColor(sf::Color(70, 70, 200));
-    gui.roleText.setString("Role: " + player->GetRole());
-    gui.roleText.setPosition(x + 10, y + 35);
-    gui.coinText.setFont(font);
-    gui.coinText.setCharacterSize(16);
-    gui.coinText.setFillColor(sf::Color::Green);
-    gui.coinText.setPosition(x + 10, y + 60);
     return gui;
 }
 
-sf::RectangleShape createButton(float x, float y, const string &label, sf::Font &font, sf::Text &outText)
+/**
+ * Appends a player's name, role and (when revealed) coins to the text batch, inside the player's box.
+ */
+void appendPlayerText(TextBatch &text, const GUIPlayer &gp, const GUISnapshot &view)
+{
+    sf::Vector2f pos = gp.box.getPosition();
+    const SeatState &seat = view.table.seats[gp.seat];
+    text.add(seat.name, sf::Vector2f(pos.x + 10, pos.y + 10), 18, sf::Color::Black);
+    text.add(string("Role: ") + roleName(seat.role), sf::Vector2f(pos.x + 10, pos.y + 35), 16, sf::Color(70, 70, 200));
+    if (view.showCoins[gp.seat])
+        text.add("Coins: " + to_string(seat.coins), sf::Vector2f(pos.x + 10, pos.y + 60), 16, sf::Color::Green);
+}
+
+sf::RectangleShape createButton(float x, float y)
 {
     sf::RectangleShape button(sf::Vector2f(140, 40));
     button.setPosition(x, y);
     button.setFillColor(sf::Color(215, 235, 255));
     button.setOutlineColor(sf::Color(160, 160, 160));
     button.setOutlineThickness(1);
-    outText.setFont(font);
-    outText.setString(label);
-    outText.setCharacterSize(18);
-    outText.setFillColor(sf::Color::Black);
-    outText.setPosition(x + 10, y + 8);
     return button;
 }
 
+// Logs the players still in the game (through the Logger, so the engine thread never waits on the terminal).
 void printGameState(const vector<Player *> &players)
 {
-    cout << "====================\n";
+    Logger &logger = Logger::instance();
+    if (!logger.enabled(LogLevel::Info))
+        return;
+    logger.log(LogLevel::Info, "====================");
     for (const auto &p : players)
     {
         if (!p->Getstillingame())
             continue;
-        cout << p->GetName() << " (" << p->GetRole() << ") - Coins: " << p->coins() << endl;
+        logger.log(LogLevel::Info, p->GetName(), " (", p->GetRole(), ") - Coins: ", p->coins());
     }
-    cout << "====================\n"
-         << endl;
+    logger.log(LogLevel::Info, "====================");
 }
 
-void showWinnerPopup(sf::RenderWindow &window, const std::string &winner, sf::Font &font)
+/**
+ * Appends the winner popup to its own shape and text batches (drawn on top of the scene).
+ */
+void appendWinnerPopup(sf::VertexArray &shapes, TextBatch &text, const std::string &winner)
 {
     sf::RectangleShape popup(sf::Vector2f(500, 200));
     popup.setFillColor(sf::Color(255, 255, 255));
     popup.setOutlineColor(sf::Color::Red);
     popup.setOutlineThickness(5);
     popup.setPosition(WIDTH / 2 - 250, HEIGHT / 2 - 100);
+    appendRect(shapes, popup);
 
-    sf::Text title("\xF0\x9F\x8E\x89 WINNER \xF0\x9F\x8E\x89", font, 36);
-    title.setFillColor(sf::Color::Red);
-    title.setStyle(sf::Text::Bold);
-    title.setPosition(WIDTH / 2 - 110, HEIGHT / 2 - 90);
-
-    sf::Text name(winner + " wins the game!", font, 26);
-    name.setFillColor(sf::Color::Black);
-    name.setPosition(WIDTH / 2 - 160, HEIGHT / 2 - 20);
-
-    sf::Text hint("Click anywhere to close", font, 18);
-    hint.setFillColor(sf::Color(100, 100, 100));
-    hint.setPosition(WIDTH / 2 - 100, HEIGHT / 2 + 60);
-
-    window.draw(popup);
-    window.draw(title);
-    window.draw(name);
-    window.draw(hint);
+    text.add("\xF0\x9F\x8E\x89 WINNER \xF0\x9F\x8E\x89", sf::Vector2f(WIDTH / 2 - 110, HEIGHT / 2 - 90), 36, sf::Color::Red, true);
+    text.add(winner + " wins the game!", sf::Vector2f(WIDTH / 2 - 160, HEIGHT / 2 - 20), 26, sf::Color::Black);
+    text.add("Click anywhere to close", sf::Vector2f(WIDTH / 2 - 100, HEIGHT / 2 + 60), 18, sf::Color(100, 100, 100));
 }
 
-bool askGeneralToBlockCoup(Player *general, const string &targetName)
+/**
+ * Asks the players who may block a move (see canBlock) one after the other; stops at the first who blocks.
+ * Must be called while the actor still holds the turn, before the move is played.
+ * @param next ---> Seat to start asking from.
+ * @param then ---> Continues the move with the seat of the blocker, or NO_SEAT if nobody blocked (the default of every question).
+ */
+void askBlockers(PromptQueue &prompts, Game &game, const Move &move, size_t next, function<void(size_t)> then)
 {
-    if (general->coins() < 5)
+    while (next < game.numPlayers() && !canBlock(game, next, move))
+        ++next;
+    if (next >= game.numPlayers())
     {
-        return false;
+        then(NO_SEAT);
+        return;
     }
-    cout << "General (" << general->GetName() << ") – do you want to block the coup on " << targetName << "? (y/n): ";
-    string response;
-    cin >> response;
-    return (response == "y" || response == "Y");
-}
-
-bool askGovernorToBlockTax(Player *governor, const string &playerName)
-{
-    cout << "Governor (" << governor->GetName() << ") – do you want to block the tax from " << playerName << "? (y/n): ";
-    string response;
-    cin >> response;
-    return (response == "y" || response == "Y");
-}
-
-bool askJudgeToBlockBribe(Player *judge, const string &briberName)
-{
-    cout << "Judge (" << judge->GetName() << ") – do you want to block the bribe from " << briberName << "? (y/n): ";
-    string response;
-    cin >> response;
-    return (response == "y" || response == "Y");
+    Player &blocker = game.getPlayer(next);
+    string question = blocker.GetRole() + " (" + blocker.GetName() + ") - do you want to block the " + actionName(move.action) +
+                      " from " + game.turn() + (move.target == NO_SEAT ? "" : " on " + game.nameRef(move.target)) + "?";
+    prompts.ask(&blocker, question, {"yes", "no"}, 1, [&prompts, &game, move, next, then](size_t choice)
+                {
+                    if (choice == 0)
+                        then(next);
+                    else
+                        askBlockers(prompts, game, move, next + 1, then); });
 }
 
-void handleMerchantArrested(Player *arrestedPlayer)
+/**
+ * @return ---> The button of the i-th answer of the open question (used for drawing and for hit testing).
+ */
+sf::RectangleShape promptOptionBox(size_t i)
 {
-    if (arrestedPlayer->GetRole() == "Merchant")
-    {
-        Merchant *merchant = dynamic_cast<Merchant *>(arrestedPlayer);
-        if (merchant != nullptr)
-        {
-            merchant->getArrested();
-        }
-    }
+    sf::RectangleShape box(sf::Vector2f(120, 40));
+    box.setPosition(WIDTH / 2 - 260 + i * 140, HEIGHT / 2 + 20);
+    box.setFillColor(sf::Color(215, 235, 255));
+    box.setOutlineColor(sf::Color(160, 160, 160));
+    box.setOutlineThickness(1);
+    return box;
 }
 
-void advanceTurn(Game &game)
+/**
+ * Appends the open question (panel, text, answer buttons and countdown) to the popup batches.
+ */
+void appendPrompt(sf::VertexArray &shapes, TextBatch &text, const GUISnapshot &view)
 {
-    ++turnCounter;
-    lastArrestedTarget = nullptr; // reset arrested target
-    for (auto it = blockedActions.begin(); it != blockedActions.end();)
+    sf::RectangleShape panel(sf::Vector2f(640, 180));
+    panel.setFillColor(sf::Color(255, 255, 255));
+    panel.setOutlineColor(sf::Color(120, 80, 160));
+    panel.setOutlineThickness(4);
+    panel.setPosition(WIDTH / 2 - 320, HEIGHT / 2 - 90);
+    appendRect(shapes, panel);
+
+    text.add(view.promptQuestion, sf::Vector2f(WIDTH / 2 - 300, HEIGHT / 2 - 70), 18, sf::Color::Black);
+    text.add("Default: " + view.promptOptions[view.promptDefault] + " in " + to_string(view.promptSecondsLeft) + "s",
+             sf::Vector2f(WIDTH / 2 - 300, HEIGHT / 2 - 30), 16, sf::Color(100, 100, 100));
+    for (size_t i = 0; i < view.promptOptions.size(); ++i)
     {
-        if (it->second.second <= turnCounter)
-        {
-            cout << "[DEBUG] Unblocking " << it->first << " from action '" << it->second.first << "' at turn " << turnCounter << endl;
-            it = blockedActions.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+        sf::RectangleShape box = promptOptionBox(i);
+        appendRect(shapes, box);
+        text.add(view.promptOptions[i], box.getPosition() + sf::Vector2f(10, 8), 18, sf::Color::Black);
     }
-    game.advanceTurn();
 }
 
-int main()
+/**
+ * Usage: coup_game [--bot=<name>]... [--ai=<name>]... [--think_ms=1500]
+ * Seats named with --bot answer block questions instantly with the default decision.
+ * Seats named with --ai also play their own turns (a random legal move, chosen after think_ms on the engine thread).
+ */
+int main(int argc, char **argv)
 {
     Game game;
     Governor governor(game, "Moshe");
@@ -206,6 +278,33 @@ int main()
 
     vector<Player *> players = {&governor, &spy, &baron, &general, &judge, &merchant};
 
+    // Questions to other players during an action are asked in the window and never block the frame loop.
+    PromptQueue prompts(chrono::seconds(10));
+    vector<bool> aiSeat(players.size(), false);
+    chrono::milliseconds thinkTime(1500);
+    for (int a = 1; a < argc; ++a)
+    {
+        string arg = argv[a];
+        if (arg.rfind("--think_ms=", 0) == 0)
+        {
+            thinkTime = chrono::milliseconds(max(0, stoi(arg.substr(11))));
+            continue;
+        }
+        bool ai = arg.rfind("--ai=", 0) == 0;
+        if (!ai && arg.rfind("--bot=", 0) != 0)
+            continue;
+        string name = arg.substr(ai ? 5 : 6);
+        for (size_t s = 0; s < players.size(); ++s)
+        {
+            if (players[s]->GetName() != name)
+                continue;
+            prompts.setBot(players[s], [](const PromptQueue::Prompt &prompt)
+                           { return prompt.defaultOption; });
+            if (ai)
+                aiSeat[s] = true;
+        }
+    }
+
     vector<sf::Color> pastelColors = {
         sf::Color(255, 204, 204),
         sf::Color(204, 255, 229),
@@ -229,563 +328,366 @@ int main()
     {
         float rowX = baseX + (i % 3) * spacing;
         float rowY = baseY + (i / 3) * 150;
-        guiPlayers.push_back(createGUIPlayer(players[i], font, rowX, rowY, pastelColors[i % pastelColors.size()]));
+        guiPlayers.push_back(createGUIPlayer(i, rowX, rowY, pastelColors[i % pastelColors.size()]));
     }
 
-    sf::Text turnText, logText;
-    turnText.setFont(font);
-    turnText.setCharacterSize(28);
-    turnText.setFillColor(sf::Color(120, 80, 160));
-    turnText.setPosition(50, 30);
-
-    logText.setFont(font);
-    logText.setCharacterSize(20);
-    logText.setFillColor(sf::Color(80, 80, 100));
-    logText.setPosition(50, HEIGHT - 40);
+    // All HUD text is laid out from one glyph atlas into a single vertex array.
+    TextBatch hudText(font);
+    TextBatch popupText(font);
+    sf::VertexArray popupShapes(sf::Triangles);
 
-    vector<string> actions = {"gather", "tax", "bribe", "arrest", "sanction", "coup", "watch", "invest"};
+    vector<ActionType> actions = {ActionType::Gather, ActionType::Tax, ActionType::Bribe, ActionType::Arrest,
+                                  ActionType::Sanction, ActionType::Coup, ActionType::Watch, ActionType::Invest};
     vector<sf::RectangleShape> buttons;
-    vector<sf::Text> buttonLabels;
 
     for (size_t i = 0; i < actions.size(); ++i)
     {
-        sf::Text lbl;
-        sf::RectangleShape btn = createButton(WIDTH - 220, 100 + i * 50, actions[i], font, lbl);
-        buttons.push_back(btn);
-        buttonLabels.push_back(lbl);
+        buttons.push_back(createButton(WIDTH - 220, 100 + i * 50));
     }
 
-    string log = "";
-    Player *pendingTargetAction = nullptr;
-    string pendingAction = "";
-    string winnerName = "";
-    bool showPopup = false;
-
-    while (window.isOpen())
-    {
-        sf::Event event;
-        while (window.pollEvent(event))
-        {
-            if (event.type == sf::Event::Closed)
-                window.close();
-
-            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
-            {
-                if (showPopup)
-                {
-                    window.close();
-                    continue;
-                }
-
-                sf::Vector2f mouse(event.mouseButton.x, event.mouseButton.y);
-
-                if (!pendingAction.empty())
-                {
-                    for (auto &gp : guiPlayers)
-                    {
-                        if (!gp.logic->Getstillingame())
-                            continue;
-                        if (gp.box.getGlobalBounds().contains(mouse) && gp.logic->GetName() != game.turn())
-                        {
-                            try
-                            {
-                                Player *current = nullptr;
-                                for (auto *p : players)
-                                    if (p->GetName() == game.turn())
-                                        current = p;
-
-                                if (pendingAction == "coup")
-                                {
-                                    if (current->coins() < 7)
-                                    {
-                                        log = current->GetName() + " has less than 7 coins and cannot coup.";
-                                        cout << log << endl;
-                                        logText.setString(log);
-                                    }
-                                    else if (askGeneralToBlockCoup(&general, gp.logic->GetName()))
-                                    {
-                                        if (general.coins() >= 5)
-                                        {
-
-                                            general.DecreaseCoins(5);
-                                            current->DecreaseCoins(7);
-                                            log = "General blocked the coup on " + gp.logic->GetName();
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                            advanceTurn(game);
-                                        }
-                                        else
-                                        {
-                                            log = "General tried to block but doesn't have enough coins. Skipping block.";
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                            current->coup(*gp.logic);
-                                            game.advanceTurn();
-                                        }
-                                    }
-                                    else
-                                    {
-                                        current->coup(*gp.logic);
-                                        log = current->GetName() + " used coup on " + gp.logic->GetName();
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                    }
-                                }
-                                else if (pendingAction == "tax")
+    CommandQueue commands;
+    TripleBuffer<GUISnapshot> view;
+    Logger::instance().start(); // the engine thread's log lines are written to the terminal off the frame loop
+
+    // ---------------- Engine thread: owns the game, the prompts and the AI seats ----------------
+    // Every rule is checked by the engine: moves come from legalMoves(), blocks from canBlock(), and the log line
+    // and revealed coins are taken from the events the engine publishes.
+    thread engine([&]
+                  {
+        string log = "";
+        ActionType pendingAction = ActionType::None; // an action waiting for its target to be clicked
+        string winnerName = "";
+        bool showPopup = false;
+        bool showCoins[Game::MAX_PLAYERS] = {};
+        string thinking = "";
+        int shownSecondsLeft = -1;
+        bool changed = true;
+        RandomBot bot(random_device{}());
+
+        game.events().subscribe([&](const GameEvent &e)
                                 {
-                                    Player *governorPtr = nullptr;
-                                    for (auto *p : players)
+                                    changed = true;
+                                    string actor = e.actor < game.numPlayers() ? game.nameRef(e.actor) : "";
+                                    string target = e.target < game.numPlayers() ? game.nameRef(e.target) : "";
+                                    switch (e.type)
                                     {
-                                        if (p->GetRole() == "Governor" && p->Getstillingame() && p != current)
+                                    case EventType::ActionPerformed:
+                                        if (e.action == ActionType::Watch)
                                         {
-                                            governorPtr = p;
+                                            showCoins[e.target] = true;
+                                            log = target + " has " + to_string(game.getPlayer(e.target).coins()) + " coins";
                                             break;
                                         }
-                                    }
-                                    if (governorPtr != nullptr)
-                                    {
-                                        if (askGovernorToBlockTax(governorPtr, current->GetName()))
-                                        {
-                                            log = "Governor blocked tax by " + current->GetName();
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                            game.advanceTurn();
-                                            pendingAction = ""; // קודם מאפסים
-                                            game.advanceTurn(); // ואז עוברים תור
-                                            break;              // מסיימים את הטיפול הנוכחי
-                                        }
-                                        else
-                                        {
-                                            current->tax();
-                                            log = current->GetName() + " used tax";
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                            pendingAction = ""; // במקרה שהטקס מצליח, גם כן לא לשכוח
-                                        }
-                                    }
-
-                                    else
-                                    {
-                                        current->tax();
-                                        log = current->GetName() + " used tax";
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                    }
-                                }
-                                else if (pendingAction == "watch")
-                                {
-                                    if (current->GetRole() == "Spy")
-                                    {
-                                        log = gp.logic->GetName() + " has " + to_string(gp.logic->coins()) + " coins";
-                                        for (auto &g : guiPlayers)
-                                            if (g.logic == gp.logic)
-                                                g.showCoins = true;
-
-                                        // הוספה לסט איסור arrest לתור הבא
-                                        arrestedBanSet.insert(gp.logic->GetName());
-
-                                        lastPlayerWatchedCoins = gp.logic->GetName();
-                                    }
-                                    else
-                                    {
-                                        log = current->GetName() + " cannot perform watch: not a Spy";
-                                    }
-                                    logText.setString(log);
-                                    cout << log << endl;
-                                }
-                                else if (pendingAction == "arrest")
-                                {
-                                    // בדיקה אם השחקן כבר נעצר לאחרונה
-                                    if (lastArrestedTarget && gp.logic->GetName() == lastArrestedTarget->GetName())
-                                    {
-                                        log = gp.logic->GetName() + " was recently arrested and cannot be arrested again immediately.";
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                        pendingAction = ""; // ← זה השורה החשובה!
+                                        for (bool &shown : showCoins)
+                                            shown = false;
+                                        log = actor + " used " + actionName(e.action) + (target.empty() ? "" : " on " + target);
                                         break;
-                                    }
-                                    if (arrestedBanSet.find(current->GetName()) != arrestedBanSet.end())
-                                    {
-                                        log = current->GetName() + " cannot perform arrest this turn because someone watched their coins last turn.";
-                                        cout << log << endl;
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                        // הסרת האיסור כדי שיפוג בתור הבא
-                                        arrestedBanSet.erase(current->GetName());
+                                    case EventType::Blocked:
+                                        log = actor + " blocked the " + actionName(e.action) + (e.action == ActionType::Coup ? " on " : " of ") + target;
                                         break;
-                                    }
-                                    else
-                                    {
-                                        current->arrest(*gp.logic);
-                                        lastArrestedBy = current;
-                                        lastArrestedTarget = gp.logic;
-                                        handleMerchantArrested(gp.logic);
-                                        if (gp.logic->GetRole() == "General")
-                                        {
-                                            General *gen = dynamic_cast<General *>(gp.logic);
-                                            if (gen != nullptr)
-                                            {
-                                                gen->Gotarrested();
-                                                log += " | General received 1 coin back due to arrest.";
-                                                logText.setString(log);
-                                            }
-                                        }
-                                    }
-                                }
-                                else if (pendingAction == "sanction")
-                                {
-                                    log = "Choose which action to block for " + gp.logic->GetName() + " (gather/tax): ";
-                                    logText.setString(log);
-                                    cout << log;
-                                    string chosenBlock;
-                                    cin >> chosenBlock;
-                                    if (chosenBlock == "gather" || chosenBlock == "tax")
-                                    {
-                                        current->DecreaseCoins(3);
-                                        blockedActions[gp.logic->GetName()] = {chosenBlock, turnCounter + 1};
-
-                                        // Baron compensation
-                                        if (gp.logic->GetRole() == "Baron")
-                                        {
-                                            Baron *baronTarget = dynamic_cast<Baron *>(gp.logic);
-                                            if (baronTarget)
-                                            {
-                                                baronTarget->onSanction();
-                                                log += " | Baron received 1 coin compensation.";
-                                            }
-                                        }
+                                    case EventType::Eliminated:
+                                        log += " | " + target + " is out";
+                                        break;
+                                    case EventType::GameOver:
+                                        // The engine announces the end of the game; no per-frame winner() query (and exception).
+                                        winnerName = actor;
+                                        showPopup = true;
+                                        break;
+                                    default:
+                                        break;
+                                    } });
 
-                                        // Judge penalty
-                                        if (gp.logic->GetRole() == "Judge")
-                                        {
-                                            Judge *judgeTarget = dynamic_cast<Judge *>(gp.logic);
-                                            if (judgeTarget)
-                                            {
-                                                judgeTarget->gotSanctioned(*current);
-                                                log += " | Judge triggered extra penalty: attacker pays 1 coin to the bank.";
-                                            }
-                                        }
+        // Copies the state the window draws into the back slot of the triple buffer and hands it over.
+        auto publishView = [&]
+        {
+            GUISnapshot &v = view.back();
+            captureState(game, v.table);
+            for (size_t s = 0; s < Game::MAX_PLAYERS; ++s)
+                v.showCoins[s] = showCoins[s];
+            v.log = log;
+            v.winnerName = winnerName;
+            v.showPopup = showPopup;
+            v.thinking = thinking;
+            v.promptActive = prompts.active();
+            if (v.promptActive)
+            {
+                const PromptQueue::Prompt &prompt = prompts.current();
+                v.promptQuestion = prompt.question;
+                v.promptOptions = prompt.options;
+                v.promptDefault = prompt.defaultOption;
+                v.promptSecondsLeft = prompts.secondsLeft();
+            }
+            view.publish();
+        };
 
-                                        log = current->GetName() + " used sanction on " + gp.logic->GetName() + ", blocking " + chosenBlock + " until the end of their next turn";
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                    }
-                                    else
-                                    {
-                                        log = "Invalid action to block. Sanction cancelled.";
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                    }
-                                    pendingAction = "";
-                                    game.advanceTurn();
-                                    if (gp.logic->GetRole() == "Judge")
-                                    {
-                                        Judge *judge = dynamic_cast<Judge *>(gp.logic);
-                                        if (judge != nullptr)
-                                        {
-                                            log += " | Judge triggered extra penalty: attacker pays 1 coin to the bank.";
-                                            logText.setString(log);
-                                            log += " | Judge triggered extra penalty: attacker pays 1 coin to the bank.";
-                                            logText.setString(log);
-                                        }
-                                    }
-                                }
-                                printGameState(players);
+        // Plays a legal move of the current player once every player who may block it has answered.
+        auto play = [&](const Move &move)
+        {
+            size_t actor = game.turnSeat();
+            askBlockers(prompts, game, move, 0, [&, move, actor](size_t blocker)
+                        {
+                            try
+                            {
+                                applyMove(game, move);
+                                if (blocker != NO_SEAT)
+                                    applyBlock(game, blocker, actor, move);
                             }
                             catch (const exception &e)
                             {
                                 log = string("[Error] ") + e.what();
-                                logText.setString(log);
-                                cout << log << endl;
+                                Logger::instance().log(LogLevel::Error, log);
                             }
-                            pendingAction = "";
-                        }
+                            printGameState(players); });
+        };
+
+        // The one legality check of the GUI: the move must be one of legalMoves().
+        auto isLegal = [&](const Move &move)
+        {
+            if (legalMoves(game).contains(move))
+                return true;
+            Player &current = game.getPlayer(game.turnSeat());
+            log = current.GetName() + " cannot " + actionName(move.action) +
+                  (move.target == NO_SEAT ? "" : " " + game.nameRef(move.target)) + " now";
+            if (current.coins() >= 10)
+                log += ": with 10 or more coins a coup is mandatory";
+            Logger::instance().log(LogLevel::Info, log);
+            return false;
+        };
+
+        vector<UICommand> batch;
+        while (commands.waitAndTake(batch, chrono::milliseconds(50)))
+        {
+            for (const UICommand &command : batch)
+            {
+                changed = true;
+                if (showPopup)
+                    continue;
+                if (aiSeat[game.turnSeat()] && !prompts.active())
+                {
+                    log = game.turn() + " is an AI seat; wait for its move.";
+                    continue;
+                }
+
+                if (command.kind == UICommand::PromptOption)
+                {
+                    // While a question is open only its answers can be clicked.
+                    if (!prompts.active())
+                        continue;
+                    try
+                    {
+                        prompts.answer(command.index);
+                    }
+                    catch (const exception &e)
+                    {
+                        log = string("[Error] ") + e.what();
+                        Logger::instance().log(LogLevel::Error, log);
                     }
                 }
-                else
+                else if (prompts.active())
                 {
-                    for (size_t i = 0; i < buttons.size(); ++i)
+                    continue;
+                }
+                else if (command.kind == UICommand::Target)
+                {
+                    if (pendingAction == ActionType::None || command.index == game.turnSeat())
+                        continue;
+                    ActionType action = pendingAction;
+                    pendingAction = ActionType::None;
+                    Move move{action, static_cast<uint8_t>(command.index), 0};
+                    Player &current = game.getPlayer(game.turnSeat());
+                    try
                     {
-                        if (buttons[i].getGlobalBounds().contains(mouse))
+                        if (action == ActionType::Watch)
                         {
-                            string action = actions[i];
-                            Player *current = nullptr;
-                            for (auto *p : players)
-                                if (p->GetName() == game.turn())
-                                    current = p;
-
-                            try
-                            {
-                                // --- איפוס איסור arrest בתחילת תור חדש ---
-                                string currentTurn = game.turn();
-                                if (currentTurn != lastTurnPlayer)
-                                {
-                                    lastTurnPlayer = currentTurn;
-                                    for (auto it = arrestedBanSet.begin(); it != arrestedBanSet.end();)
-                                    {
-                                        if (*it == currentTurn)
-                                        {
-                                            ++it; // נשאר בתור
-                                        }
-                                        else
-                                        {
-                                            it = arrestedBanSet.erase(it); // מוחקים אחרים
-                                        }
-                                    }
-                                    // לא מוחקים ישירות את השם כי רק מי שצפו עליו יישאר בסט
-                                    // מוחקים רק את השמות של כל השחקנים שלא תורם כעת
-                                    for (auto it = arrestedBanSet.begin(); it != arrestedBanSet.end();)
-                                    {
-                                        if (*it == currentTurn)
-                                        {
-                                            ++it; // נשאר בתור
-                                        }
-                                        else
-                                        {
-                                            it = arrestedBanSet.erase(it); // מוחקים אחרים
-                                        }
-                                    }
-                                    lastTurnPlayer = currentTurn;
-                                }
-
-                                if (current->GetName() == lastPlayerWatchedCoins && action == "arrest")
-                                {
-                                    log = current->GetName() + " cannot perform arrest this turn because someone watched their coins last turn.";
-                                    cout << log << endl;
-                                    logText.setString(log);
-                                    lastPlayerWatchedCoins = ""; // שחרור חסימה לאחר תור אחד
-                                    break;
-                                }
-                                if (current->coins() >= 10 && action != "coup")
-                                {
-                                    log = current->GetName() + " has less than 10 coins and cannot coup.";
-                                    cout << log << endl;
-                                    logText.setString(log);
-                                    cout << log << endl;
-                                    break;
-                                }
-
-                                if (action == "gather")
-                                {
-                                    if (blockedActions.count(current->GetName()) && blockedActions[current->GetName()].first == "gather")
-                                    {
-                                        log = current->GetName() + " is blocked from performing gather due to sanction.";
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                        // Remove one-time block
-                                        blockedActions.erase(current->GetName());
-                                        break;
-                                    }
-                                    current->gather();
-                                    log = current->GetName() + " used gather";
-                                    logText.setString(log);
-                                    cout << log << endl;
-                                }
-                                else if (action == "tax")
-                                {
-                                    if (blockedActions.count(current->GetName()) && blockedActions[current->GetName()].first == "tax")
-                                    {
-                                        log = current->GetName() + " is blocked from performing tax due to sanction.";
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                        // Remove one-time block
-                                        blockedActions.erase(current->GetName());
-                                        break;
-                                    }
-                                    Player *governorPtr = nullptr;
-                                    for (auto *p : players)
-                                    {
-                                        if (p->GetRole() == "Governor" && p->Getstillingame() && p != current)
-                                        {
-                                            governorPtr = p;
-                                            break;
-                                        }
-                                    }
-                                    if (governorPtr != nullptr)
-                                    {
-                                        if (askGovernorToBlockTax(governorPtr, current->GetName()))
-                                        {
-                                            log = "Governor blocked tax by " + current->GetName();
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                            game.advanceTurn();
-                                        }
-                                        else
-                                        {
-                                            current->tax();
-                                            log = current->GetName() + " used tax";
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                        }
-                                    }
-                                    else
-                                    {
-                                        current->tax();
-                                        log = current->GetName() + " used tax";
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                    }
-                                }
-                                else if (action == "bribe")
-                                {
-                                    bool blocked = false;
-                                    for (auto *p : players)
-                                    {
-                                        if (p->GetRole() == "Judge" && p->Getstillingame())
-                                        {
-                                            Judge *judge = dynamic_cast<Judge *>(p);
-                                            if (judge && askJudgeToBlockBribe(judge, current->GetName()))
-                                            {
-                                                log = "Judge blocked the bribe from " + current->GetName();
-                                                logText.setString(log);
-                                                cout << log << endl;
-                                                current->DecreaseCoins(4);
-                                                game.advanceTurn();
-                                                pendingAction = "";
-                                                blocked = true;
-                                                break;
-                                            }
-                                        }
-                                    }
-                                    if (!blocked)
-                                    {
-                                        try
-                                        {
-                                            current->bribe();
-                                            if (current->GetRole() == "Merchant")
+                            // Watching is free and does not use the turn, so it is not one of the turn moves.
+                            if (current.GetRoleType() == RoleType::Spy)
+                                static_cast<Spy &>(current).watchCoins(game.getPlayer(command.index));
+                            else
+                                log = current.GetName() + " cannot perform watch: not a Spy";
+                        }
+                        else if (action == ActionType::Sanction)
+                        {
+                            if (isLegal(move))
+                                prompts.ask(&current, "Choose which action to block for " + game.nameRef(command.index) + " (gather/tax)",
+                                            {"gather", "tax"}, 0, [&, move](size_t choice) mutable
                                             {
-                                                log += " | Merchant received 1 bonus coin.";
-                                            }
-                                            log = current->GetName() + " used bribe and gets another turn.";
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                            printGameState(players);
-                                        }
-                                        catch (const std::exception &e)
-                                        {
-                                            log = string("[Error] ") + e.what();
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                        }
-                                        pendingAction = "";
-                                    }
-                                }
-                                else if (action == "invest")
-                                {
-                                    Baron *baron = dynamic_cast<Baron *>(current);
-                                    if (baron != nullptr)
-                                    {
-                                        try
-                                        {
-                                            baron->invest();
-                                            log = baron->GetName() + " used invest";
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                        }
-                                        catch (const std::exception &e)
-                                        {
-                                            log = string("[Error] ") + e.what();
-                                            logText.setString(log);
-                                            cout << log << endl;
-                                        }
-                                    }
-                                    else
-                                    {
-                                        log = current->GetName() + " cannot invest: not a Baron";
-                                        logText.setString(log);
-                                        cout << log << endl;
-                                    }
-                                }
-                                else
-                                {
-                                    pendingAction = action;
-                                    log = "Select a player for action: " + action;
-                                    logText.setString(log);
-                                    cout << log << endl;
-                                }
-
-                                if (action != "watch")
-                                {
-                                    for (auto &g : guiPlayers)
-                                        g.showCoins = false;
-                                }
-
-                                if (action == "gather")
-                                {
-                                    log = current->GetName() + " used " + action;
-                                    logText.setString(log);
-                                    cout << log << endl;
-                                }
-
-                                printGameState(players);
-                            }
-                            catch (const exception &e)
-                            {
-                                log = string("[Error] ") + e.what();
-                                logText.setString(log);
-                                cout << log << endl;
-                            }
+                                                move.option = static_cast<uint8_t>(choice);
+                                                if (isLegal(move))
+                                                    play(move); });
+                        }
+                        else if (isLegal(move))
+                        {
+                            play(move);
                         }
                     }
+                    catch (const exception &e)
+                    {
+                        log = string("[Error] ") + e.what();
+                        Logger::instance().log(LogLevel::Error, log);
+                    }
+                }
+                else if (pendingAction == ActionType::None)
+                {
+                    ActionType action = actions[command.index];
+                    if (action == ActionType::Arrest || action == ActionType::Sanction || action == ActionType::Coup || action == ActionType::Watch)
+                    {
+                        pendingAction = action;
+                        log = string("Select a player for action: ") + actionName(action);
+                        Logger::instance().log(LogLevel::Info, log);
+                    }
+                    else if (isLegal(Move{action, NO_SEAT, 0}))
+                    {
+                        play(Move{action, NO_SEAT, 0});
+                    }
                 }
             }
-        }
 
-        for (auto *p : players)
-        {
-            Baron *baron = dynamic_cast<Baron *>(p);
-            if (baron)
+            if (prompts.active())
             {
-                baron->resetInvestFlag();
+                try
+                {
+                    if (prompts.update())
+                        changed = true; // nobody answered in time: the default was taken
+                }
+                catch (const exception &e)
+                {
+                    log = string("[Error] ") + e.what();
+                    Logger::instance().log(LogLevel::Error, log);
+                    changed = true;
+                }
+                int left = prompts.active() ? prompts.secondsLeft() : -1;
+                if (left != shownSecondsLeft)
+                {
+                    shownSecondsLeft = left;
+                    changed = true;
+                }
             }
-        }
 
-        try
+            // An AI seat thinks here, on the engine thread; the window keeps drawing the last snapshot meanwhile.
+            size_t seat = game.turnSeat();
+            if (aiSeat[seat] && !showPopup && !prompts.active())
+            {
+                pendingAction = ActionType::None;
+                thinking = game.turn();
+                publishView();
+                bool open = true;
+                auto deadline = chrono::steady_clock::now() + thinkTime;
+                for (auto now = chrono::steady_clock::now(); open && now < deadline; now = chrono::steady_clock::now())
+                {
+                    open = commands.waitAndTake(batch, chrono::duration_cast<chrono::milliseconds>(deadline - now));
+                    batch.clear(); // clicks during the AI's turn are not for it
+                }
+                if (!open)
+                    break; // the window was closed while the AI was thinking
+                thinking = "";
+                play(bot.choose(game));
+                changed = true;
+            }
+
+            game.events().poll();
+            if (changed)
+            {
+                publishView();
+                changed = false;
+            }
+        } });
+
+    // ---------------- Render thread: draws the newest snapshot, turns clicks into commands ----------------
+    // Retained scene: text and geometry are rebuilt only when a new snapshot arrived or the window needs it.
+    bool sceneDirty = true;
+    sf::VertexArray shapeBatch(sf::Triangles);
+    window.setFramerateLimit(60);
+
+    while (window.isOpen())
+    {
+        const GUISnapshot &shown = view.front();
+        sf::Event event;
+        while (window.pollEvent(event))
         {
-            winnerName = game.winner();
-            showPopup = true;
+            if (event.type != sf::Event::MouseMoved)
+                sceneDirty = true;
+
+            if (event.type == sf::Event::Closed)
+                window.close();
+
+            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
+            {
+                if (shown.showPopup)
+                {
+                    window.close();
+                    continue;
+                }
+
+                sf::Vector2f mouse(event.mouseButton.x, event.mouseButton.y);
+                if (shown.promptActive)
+                {
+                    for (size_t i = 0; i < shown.promptOptions.size(); ++i)
+                        if (promptOptionBox(i).getGlobalBounds().contains(mouse))
+                            commands.push({UICommand::PromptOption, i});
+                    continue;
+                }
+                for (const auto &gp : guiPlayers)
+                    if (shown.table.seats[gp.seat].alive && gp.box.getGlobalBounds().contains(mouse))
+                        commands.push({UICommand::Target, gp.seat});
+                for (size_t i = 0; i < buttons.size(); ++i)
+                    if (buttons[i].getGlobalBounds().contains(mouse))
+                        commands.push({UICommand::Button, i});
+            }
         }
-        catch (...)
+
+        if (view.update())
+            sceneDirty = true;
+        if (!sceneDirty || !window.isOpen())
         {
+            this_thread::sleep_for(chrono::milliseconds(1000 / 60)); // nothing new: check again next frame
+            continue;
         }
 
-        turnText.setString("Current Player: " + game.turn());
-
-        window.clear(sf::Color(255, 239, 239));
-        window.draw(turnText);
-
-        for (auto &gp : guiPlayers)
+        // Rebuild the shape and text batches only now that something changed.
+        const GUISnapshot &v = view.front();
+        shapeBatch.clear();
+        hudText.clear();
+        if (v.table.turn < v.table.numSeats)
+            hudText.add(string("Current Player: ") + v.table.seats[v.table.turn].name, sf::Vector2f(50, 30), 28, sf::Color(120, 80, 160));
+        if (!v.thinking.empty())
+            hudText.add(v.thinking + " is thinking...", sf::Vector2f(50, 75), 20, sf::Color(100, 100, 100));
+        for (const auto &gp : guiPlayers)
         {
-            if (!gp.logic->Getstillingame())
+            if (gp.seat >= v.table.numSeats || !v.table.seats[gp.seat].alive)
                 continue;
-            gp.roleText.setString("Role: " + gp.logic->GetRole());
-            if (gp.showCoins)
-                gp.coinText.setString("Coins: " + to_string(gp.logic->coins()));
-            else
-                gp.coinText.setString("");
-
-            window.draw(gp.box);
-            window.draw(gp.nameText);
-            window.draw(gp.roleText);
-            if (gp.showCoins)
-                window.draw(gp.coinText);
+            appendRect(shapeBatch, gp.box);
+            appendPlayerText(hudText, gp, v);
         }
-
         for (size_t i = 0; i < buttons.size(); ++i)
         {
-            window.draw(buttons[i]);
-            window.draw(buttonLabels[i]);
+            appendRect(shapeBatch, buttons[i]);
+            sf::Vector2f pos = buttons[i].getPosition();
+            hudText.add(actionName(actions[i]), sf::Vector2f(pos.x + 10, pos.y + 8), 18, sf::Color::Black);
         }
+        hudText.add(v.log, sf::Vector2f(50, HEIGHT - 40), 20, sf::Color(80, 80, 100));
 
-        window.draw(logText);
+        popupShapes.clear();
+        popupText.clear();
+        if (v.showPopup && !v.winnerName.empty())
+            appendWinnerPopup(popupShapes, popupText, v.winnerName);
+        else if (v.promptActive)
+            appendPrompt(popupShapes, popupText, v);
 
-        if (showPopup && !winnerName.empty())
+        // Two draw calls for the scene, two more while the winner popup or a question is shown.
+        window.clear(sf::Color(255, 239, 239));
+        window.draw(shapeBatch);
+        hudText.draw(window);
+        if (popupShapes.getVertexCount() > 0)
         {
-            showWinnerPopup(window, winnerName, font);
+            window.draw(popupShapes);
+            popupText.draw(window);
         }
 
         window.display();
+        sceneDirty = false;
     }
 
+    commands.close();
+    engine.join();
     return 0;
 }
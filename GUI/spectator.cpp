@@ -0,0 +1,224 @@
+// ronamsalem4@gmail.com
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "TextBatch.hpp"
+#include "../sim/Simulator.hpp"
+#include "../game/Logger.hpp"
+
+/**
+ * Spectator view: a grid of live tables played by bot simulator threads.
+ * Every frame the render loop takes the newest GameState of each table (lock-free, see TripleBuffer) and rebuilds
+ * one shape batch and one text batch only if some table changed, so the whole grid is two draw calls.
+ * Level of detail: when tiles are small (zoomed out) a table is drawn as compact coin bars without text;
+ * large tiles show names, roles, coins and the last move.
+ * Controls: mouse wheel or +/- to zoom, Up/Down to scroll.
+ * Usage: coup_spectator [--tables=64] [--threads=N] [--interval_ms=50]
+ */
+
+using namespace coup;
+using namespace std;
+
+const int WIDTH = 1600;
+const int HEIGHT = 900;
+const float HEADER = 40;           // Height of the stats line above the grid.
+const float DETAIL_MIN_WIDTH = 250; // Tiles at least this wide are drawn with text.
+
+/**
+ * @return ---> The color of a role's coin bar / name.
+ */
+sf::Color roleColor(RoleType role)
+{
+    static const sf::Color colors[ROLE_COUNT] = {
+        sf::Color(120, 80, 160),  // Governor
+        sf::Color(60, 140, 200),  // Spy
+        sf::Color(210, 160, 40),  // Baron
+        sf::Color(200, 70, 70),   // General
+        sf::Color(70, 150, 90),   // Judge
+        sf::Color(220, 120, 180)}; // Merchant
+    return colors[static_cast<size_t>(role)];
+}
+
+/**
+ * Compact tile: one bar per seat, height by coins, dimmed when eliminated, underlined on its turn.
+ */
+void appendCompactTable(sf::VertexArray &shapes, const GameState &state, const sf::FloatRect &tile)
+{
+    appendQuad(shapes, tile, state.winner == NO_SEAT ? sf::Color(250, 246, 240) : sf::Color(225, 240, 225));
+    if (state.numSeats == 0)
+        return;
+    float pad = 4;
+    float slot = (tile.width - 2 * pad) / state.numSeats;
+    float maxBar = tile.height - 2 * pad - 4;
+    for (uint8_t s = 0; s < state.numSeats; ++s)
+    {
+        const SeatState &seat = state.seats[s];
+        float x = tile.left + pad + s * slot;
+        float h = maxBar * std::min<int>(seat.coins, 12) / 12.0f + 2;
+        sf::Color color = seat.alive ? roleColor(seat.role) : sf::Color(190, 190, 190);
+        appendQuad(shapes, sf::FloatRect(x + 1, tile.top + pad + maxBar - h, slot - 2, h), color);
+        if (s == state.turn && state.winner == NO_SEAT)
+            appendQuad(shapes, sf::FloatRect(x + 1, tile.top + tile.height - pad - 2, slot - 2, 2), sf::Color::Black);
+    }
+}
+
+/**
+ * Detailed tile: header, one line per seat (name, role, coins) and the last move.
+ */
+void appendDetailedTable(sf::VertexArray &shapes, TextBatch &text, const GameState &state, size_t index, const sf::FloatRect &tile)
+{
+    appendQuad(shapes, tile, state.winner == NO_SEAT ? sf::Color(250, 246, 240) : sf::Color(225, 240, 225));
+    float x = tile.left + 8, y = tile.top + 6;
+    unsigned size = static_cast<unsigned>(std::max(11.0f, std::min(18.0f, tile.height / 12)));
+    float line = size * 1.35f;
+
+    text.add("Table " + to_string(index + 1) + "   games " + to_string(state.gamesPlayed) + "   moves " + to_string(state.version),
+             sf::Vector2f(x, y), size, sf::Color(80, 80, 100));
+    y += line * 1.2f;
+    for (uint8_t s = 0; s < state.numSeats; ++s)
+    {
+        const SeatState &seat = state.seats[s];
+        sf::Color color = seat.alive ? roleColor(seat.role) : sf::Color(170, 170, 170);
+        string marker = (s == state.winner) ? "* " : (s == state.turn && state.winner == NO_SEAT) ? "> " : "  ";
+        text.add(marker + seat.name, sf::Vector2f(x, y), size, color, s == state.turn);
+        text.add(roleName(seat.role), sf::Vector2f(x + tile.width * 0.45f, y), size, color);
+        text.add(to_string(seat.coins), sf::Vector2f(tile.left + tile.width - 36, y), size, color);
+        y += line;
+    }
+    if (state.lastAction != ActionType::None && state.lastActor < state.numSeats)
+    {
+        string last = string(state.seats[state.lastActor].name) + " " + actionName(state.lastAction);
+        if (state.lastTarget < state.numSeats)
+            last += " " + string(state.seats[state.lastTarget].name);
+        text.add(last, sf::Vector2f(x, tile.top + tile.height - line - 4), size, sf::Color(100, 100, 100));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t tables = 64;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    int intervalMs = 50;
+    for (int a = 1; a < argc; ++a)
+    {
+        string arg = argv[a];
+        if (arg.rfind("--tables=", 0) == 0)
+            tables = std::max(1, stoi(arg.substr(9)));
+        else if (arg.rfind("--threads=", 0) == 0)
+            threads = std::max(1, stoi(arg.substr(10)));
+        else if (arg.rfind("--interval_ms=", 0) == 0)
+            intervalMs = std::max(0, stoi(arg.substr(14)));
+    }
+
+    Logger::instance().setLevel(LogLevel::Off); // the tables are watched, not read in the terminal
+    Simulator sim(tables, threads, 1);
+    sim.setMoveInterval(chrono::milliseconds(intervalMs));
+    sim.start();
+
+    sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), "Coup - Spectator");
+    window.setFramerateLimit(60);
+    sf::Font font;
+    if (!font.loadFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf"))
+    {
+        cerr << "Font load error\n";
+        return 1;
+    }
+    TextBatch text(font);
+    sf::VertexArray shapes(sf::Triangles);
+
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(tables * 16.0 / 9.0)));
+    float scroll = 0;
+    bool layoutChanged = true;
+    sf::Clock statsClock;
+    uint64_t lastMoves = 0;
+    int frames = 0;
+    string stats;
+
+    while (window.isOpen())
+    {
+        sf::Event event;
+        while (window.pollEvent(event))
+        {
+            if (event.type == sf::Event::Closed)
+                window.close();
+            else if (event.type == sf::Event::MouseWheelScrolled)
+            {
+                columns = event.mouseWheelScroll.delta > 0 ? std::max<size_t>(1, columns - 1) : std::min<size_t>(tables, columns + 1);
+                layoutChanged = true;
+            }
+            else if (event.type == sf::Event::KeyPressed)
+            {
+                if (event.key.code == sf::Keyboard::Add || event.key.code == sf::Keyboard::Equal)
+                    columns = std::max<size_t>(1, columns - 1);
+                else if (event.key.code == sf::Keyboard::Subtract || event.key.code == sf::Keyboard::Hyphen)
+                    columns = std::min<size_t>(tables, columns + 1);
+                else if (event.key.code == sf::Keyboard::Down)
+                    scroll += 100;
+                else if (event.key.code == sf::Keyboard::Up)
+                    scroll = std::max(0.0f, scroll - 100);
+                layoutChanged = true;
+            }
+        }
+
+        ++frames;
+        if (statsClock.getElapsedTime().asSeconds() >= 1)
+        {
+            float seconds = statsClock.restart().asSeconds();
+            uint64_t moves = sim.movesPlayed();
+            stats = to_string(tables) + " tables   " + to_string(static_cast<long long>((moves - lastMoves) / seconds)) + " moves/s   " +
+                    to_string(sim.gamesFinished()) + " games   " + to_string(static_cast<int>(frames / seconds)) + " fps";
+            lastMoves = moves;
+            frames = 0;
+            layoutChanged = true;
+        }
+
+        // Take the newest snapshot of every table; rebuild the batches only if one of them moved.
+        bool changed = layoutChanged;
+        for (size_t t = 0; t < tables; ++t)
+        {
+            bool fresh = false;
+            sim.latest(t, &fresh);
+            changed = changed || fresh;
+        }
+        if (!changed)
+        {
+            this_thread::sleep_for(chrono::milliseconds(1000 / 60));
+            continue;
+        }
+        layoutChanged = false;
+
+        float gap = 6;
+        float tileW = (WIDTH - gap * (columns + 1)) / columns;
+        float tileH = tileW * 0.62f;
+        bool detailed = tileW >= DETAIL_MIN_WIDTH;
+        size_t rows = (tables + columns - 1) / columns;
+        scroll = std::min(scroll, std::max(0.0f, rows * (tileH + gap) + HEADER - HEIGHT));
+
+        shapes.clear();
+        text.clear();
+        text.add(stats, sf::Vector2f(gap, 8), 20, sf::Color(80, 80, 100));
+        for (size_t t = 0; t < tables; ++t)
+        {
+            sf::FloatRect tile(gap + (t % columns) * (tileW + gap), HEADER + gap + (t / columns) * (tileH + gap) - scroll, tileW, tileH);
+            if (tile.top + tile.height < HEADER || tile.top > HEIGHT)
+                continue; // off screen
+            const GameState &state = sim.latest(t);
+            if (detailed)
+                appendDetailedTable(shapes, text, state, t, tile);
+            else
+                appendCompactTable(shapes, state, tile);
+        }
+
+        window.clear(sf::Color(235, 230, 225));
+        window.draw(shapes);
+        text.draw(window);
+        window.display();
+    }
+
+    sim.stop();
+    return 0;
+}
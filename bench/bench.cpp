@@ -0,0 +1,627 @@
+// ronamsalem4@gmail.com
+#include "benchmark.hpp"
+#include "../game/Game.hpp"
+#include "../game/Player.hpp"
+#include "../game/GamePool.hpp"
+#include "../game/Logger.hpp"
+#include "../game/Moves.hpp"
+#include "../sim/RandomBot.hpp"
+#include "../roles/Governor.hpp"
+#include "../roles/Spy.hpp"
+#include "../roles/Baron.hpp"
+#include "../roles/General.hpp"
+#include "../roles/Judge.hpp"
+#include "../roles/Merchant.hpp"
+
+using namespace std;
+using namespace coup;
+
+/**
+ * Microbenchmarks of the game engine.
+ * Every benchmark keeps its game legal for an unlimited number of iterations: coins are topped up
+ * or drained with AddCoins/DecreaseCoins between actions, so the measured loop only runs real rules code.
+ * Run with "make bench"; results are written as JSON (see bench/benchmark.hpp for the flags).
+ */
+
+/**
+ * A game with the six roles in the same seating order as main.cpp (or its first n seats).
+ * The players live in the game's own arena (Game::emplace).
+ */
+static void seatRoles(Game &game, vector<Player *> &seats, size_t n)
+{
+    const string names[] = {"Moshe", "Yossi", "Meirav", "Reut", "Gilad", "Dana"};
+    seats.clear();
+    for (size_t i = 0; i < n; ++i)
+    {
+        switch (i)
+        {
+        case 0:
+            seats.push_back(&game.emplace<Governor>(names[i]));
+            break;
+        case 1:
+            seats.push_back(&game.emplace<Spy>(names[i]));
+            break;
+        case 2:
+            seats.push_back(&game.emplace<Baron>(names[i]));
+            break;
+        case 3:
+            seats.push_back(&game.emplace<General>(names[i]));
+            break;
+        case 4:
+            seats.push_back(&game.emplace<Judge>(names[i]));
+            break;
+        default:
+            seats.push_back(&game.emplace<Merchant>(names[i]));
+            break;
+        }
+    }
+}
+
+struct Table
+{
+    Game game;
+    vector<Player *> seats;
+
+    explicit Table(size_t n = 6)
+    {
+        seatRoles(game, seats, n);
+    }
+
+    Player &operator[](size_t i) { return *seats[i % seats.size()]; }
+    size_t size() const { return seats.size(); }
+};
+
+/**
+ * Drains a player's coins back to the given amount so that the "must coup at 10" rule never triggers.
+ */
+static void capCoins(Player &p, int max)
+{
+    if (p.coins() > max)
+        p.DecreaseCoins(p.coins() - max);
+}
+
+static void BM_AdvanceTurn(bench::State &state)
+{
+    Table t(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+        t.game.advanceTurn();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AdvanceTurn)->DenseRange(2, 6);
+
+static void BM_IsPlayerTurn(bench::State &state)
+{
+    Table t;
+    size_t i = 0;
+    for (auto _ : state)
+        bench::DoNotOptimize(t.game.isPlayerTurn(t[i++]));
+}
+BENCHMARK(BM_IsPlayerTurn);
+
+static void BM_Turn(bench::State &state)
+{
+    Table t;
+    for (auto _ : state)
+        bench::DoNotOptimize(t.game.turn());
+}
+BENCHMARK(BM_Turn);
+
+static void BM_TurnName(bench::State &state)
+{
+    Table t;
+    for (auto _ : state)
+        bench::DoNotOptimize(t.game.turnName());
+}
+BENCHMARK(BM_TurnName);
+
+static void BM_Players(bench::State &state)
+{
+    Table t(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+        bench::DoNotOptimize(t.game.players());
+}
+BENCHMARK(BM_Players)->DenseRange(2, 6);
+
+static void BM_Winner(bench::State &state)
+{
+    Table t(2);
+    t[1].eliminated();
+    for (auto _ : state)
+        bench::DoNotOptimize(t.game.winner());
+}
+BENCHMARK(BM_Winner);
+
+// winner() while the game is still running: this is what a render loop polling for the end pays.
+static void BM_WinnerNoWinnerYet(bench::State &state)
+{
+    Table t;
+    for (auto _ : state)
+    {
+        try
+        {
+            bench::DoNotOptimize(t.game.winner());
+        }
+        catch (const exception &)
+        {
+        }
+    }
+}
+BENCHMARK(BM_WinnerNoWinnerYet);
+
+// The non-throwing query a render loop should use instead.
+static void BM_TryWinnerNoWinnerYet(bench::State &state)
+{
+    Table t;
+    for (auto _ : state)
+        bench::DoNotOptimize(t.game.tryWinner());
+}
+BENCHMARK(BM_TryWinnerNoWinnerYet);
+
+static void BM_Gather(bench::State &state)
+{
+    Table t;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        Player &p = t[i++];
+        capCoins(p, 5);
+        p.gather();
+    }
+}
+BENCHMARK(BM_Gather);
+
+static void BM_Tax(bench::State &state)
+{
+    Table t;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        Player &p = t[i++];
+        capCoins(p, 5);
+        p.tax();
+    }
+}
+BENCHMARK(BM_Tax);
+
+// bribe + the extra turn it buys (gather), for every seat in turn.
+static void BM_Bribe(bench::State &state)
+{
+    Table t;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        Player &p = t[i++];
+        capCoins(p, 0);
+        p.AddCoins(4);
+        p.bribe();
+        p.gather();
+        p.gather();
+    }
+}
+BENCHMARK(BM_Bribe);
+
+static void BM_Arrest(bench::State &state)
+{
+    Table t;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        Player &p = t[i];
+        Player &target = t[i + 1];
+        ++i;
+        capCoins(p, 5);
+        if (target.coins() < 2)
+            target.AddCoins(2);
+        p.arrest(target);
+    }
+}
+BENCHMARK(BM_Arrest);
+
+static void BM_Sanction(bench::State &state)
+{
+    Table t;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        Player &p = t[i];
+        Player &target = t[i + 1];
+        ++i;
+        capCoins(p, 0);
+        p.AddCoins(4);
+        p.sanction(target, (i & 1) ? "tax" : "gather");
+    }
+}
+BENCHMARK(BM_Sanction);
+
+// Two players: the victim is put back with returnToGame() so the same coup can repeat.
+static void BM_Coup(bench::State &state)
+{
+    Table t(2);
+    for (auto _ : state)
+    {
+        t[0].AddCoins(7);
+        t[0].coup(t[1]);
+        t[1].returnToGame();
+    }
+}
+BENCHMARK(BM_Coup);
+
+static void BM_BaronInvest(bench::State &state)
+{
+    Table t(3);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        Player &p = t[i++];
+        capCoins(p, 3);
+        if (Baron *baron = dynamic_cast<Baron *>(&p))
+        {
+            if (baron->coins() < 3)
+                baron->AddCoins(3);
+            baron->invest();
+        }
+        else
+            p.gather();
+    }
+}
+BENCHMARK(BM_BaronInvest);
+
+static void BM_GovernorUndo(bench::State &state)
+{
+    Table t(2);
+    Governor &governor = static_cast<Governor &>(t[0]);
+    for (auto _ : state)
+    {
+        capCoins(governor, 5);
+        governor.gather();
+        capCoins(t[1], 5);
+        t[1].tax();
+        governor.undo(t[1]);
+    }
+}
+BENCHMARK(BM_GovernorUndo);
+
+static void BM_SpyWatchCoins(bench::State &state)
+{
+    Table t(2);
+    Spy &spy = static_cast<Spy &>(t[1]);
+    for (auto _ : state)
+        spy.watchCoins(t[0]);
+}
+BENCHMARK(BM_SpyWatchCoins);
+
+static void BM_GeneralBlockCoup(bench::State &state)
+{
+    Table t(4);
+    General &general = static_cast<General &>(t[3]);
+    for (auto _ : state)
+    {
+        // Seat 0 coups seat 1, the General pays to bring seat 1 back; then seats 1..3 pass.
+        t[0].AddCoins(7);
+        t[0].coup(t[1]);
+        general.AddCoins(5);
+        general.BlockCoup(t[1]);
+        capCoins(t[1], 5);
+        t[1].gather();
+        capCoins(t[2], 5);
+        t[2].gather();
+        capCoins(general, 5);
+        general.gather();
+        capCoins(t[0], 0);
+    }
+}
+BENCHMARK(BM_GeneralBlockCoup);
+
+static void BM_JudgeBlockBribe(bench::State &state)
+{
+    Table t(5);
+    Judge &judge = static_cast<Judge &>(t[4]);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        // The seat in turn bribes and the Judge cancels it, which passes the turn.
+        Player &p = t[i++];
+        if (&p == &judge)
+        {
+            capCoins(judge, 5);
+            judge.gather();
+            continue;
+        }
+        capCoins(p, 0);
+        p.AddCoins(4);
+        p.bribe();
+        judge.blockBribe(p);
+    }
+}
+BENCHMARK(BM_JudgeBlockBribe);
+
+/**
+ * The two scripted games of main.cpp, action for action, without the printing.
+ */
+static void playMainScript()
+{
+    Game game_1{};
+    Governor governor(game_1, "Moshe");
+    Spy spy(game_1, "Yossi");
+    Baron baron(game_1, "Meirav");
+    General general(game_1, "Reut");
+    Judge judge(game_1, "Gilad");
+    Merchant merchant(game_1, "Dana");
+
+    governor.tax();
+    spy.tax();
+    governor.undo(spy);
+    baron.tax();
+    general.gather();
+    judge.gather();
+    merchant.gather();
+    governor.tax();
+    spy.watchCoins(governor);
+    spy.tax();
+    baron.tax();
+    general.tax();
+    judge.tax();
+    merchant.tax();
+    try
+    {
+        governor.arrest(baron);
+    }
+    catch (const std::exception &)
+    {
+    }
+    governor.tax();
+    spy.tax();
+    baron.gather();
+    general.gather();
+    judge.gather();
+    merchant.gather();
+    governor.arrest(spy);
+    spy.gather();
+    baron.invest();
+    general.tax();
+    judge.sanction(baron, "tax");
+    merchant.gather();
+    try
+    {
+        governor.tax();
+    }
+    catch (const std::exception &)
+    {
+    }
+    governor.coup(spy);
+    general.BlockCoup(spy);
+    try
+    {
+        baron.arrest(general);
+    }
+    catch (const std::exception &)
+    {
+    }
+    spy.tax();
+    baron.arrest(general);
+    general.gather();
+    judge.gather();
+    merchant.sanction(judge, "tax");
+    governor.tax();
+    spy.bribe();
+    judge.blockBribe(spy);
+    baron.coup(governor);
+    general.arrest(merchant);
+
+    Game game_2{};
+    Governor governor1(game_2, "Ron");
+    Spy spy1(game_2, "Or");
+    Baron baron1(game_2, "Shir");
+    General general1(game_2, "Yoram");
+    Judge judge1(game_2, "Tali");
+    Merchant merchant1(game_2, "Dor");
+
+    governor1.tax();
+    spy1.tax();
+    baron1.gather();
+    try
+    {
+        judge.gather();
+    }
+    catch (const std::exception &)
+    {
+    }
+    general1.tax();
+    judge1.tax();
+    merchant1.tax();
+    governor1.tax();
+    spy1.arrest(general1);
+    baron1.tax();
+    general1.tax();
+    judge1.tax();
+    merchant1.tax();
+    governor1.bribe();
+    governor1.tax();
+    governor1.tax();
+    spy1.gather();
+    baron1.arrest(governor1);
+    try
+    {
+        general1.arrest(governor1);
+    }
+    catch (const std::exception &)
+    {
+    }
+    general1.arrest(judge);
+    judge1.arrest(governor1);
+    merchant1.tax();
+    governor1.tax();
+    spy1.tax();
+    baron1.sanction(general1, "tax");
+    try
+    {
+        general1.tax();
+    }
+    catch (const std::exception &)
+    {
+    }
+    general1.gather();
+    judge1.tax();
+    merchant1.tax();
+    governor1.tax();
+    spy1.tax();
+    baron1.tax();
+    general1.tax();
+    judge1.coup(baron1);
+    merchant1.coup(judge1);
+    governor1.coup(merchant1);
+    spy1.coup(general1);
+    governor1.tax();
+    spy1.tax();
+    governor1.coup(spy1);
+    bench::DoNotOptimize(game_2.winner());
+}
+
+// Setting up a 6-player table from scratch: a new Game plus six heap-allocated roles.
+static void BM_SetupHeapPlayers(bench::State &state)
+{
+    for (auto _ : state)
+    {
+        Game game;
+        Governor *a = new Governor(game, "Moshe");
+        Spy *b = new Spy(game, "Yossi");
+        Baron *c = new Baron(game, "Meirav");
+        General *d = new General(game, "Reut");
+        Judge *e = new Judge(game, "Gilad");
+        Merchant *f = new Merchant(game, "Dana");
+        bench::DoNotOptimize(game.turn());
+        delete a;
+        delete b;
+        delete c;
+        delete d;
+        delete e;
+        delete f;
+    }
+}
+BENCHMARK(BM_SetupHeapPlayers);
+
+// The same table built in a reused game: clear() keeps the arena, emplace() constructs in place.
+static void BM_SetupArenaReuse(bench::State &state)
+{
+    Game game;
+    vector<Player *> seats;
+    seats.reserve(Game::MAX_PLAYERS);
+    for (auto _ : state)
+    {
+        game.clear();
+        seatRoles(game, seats, 6);
+        bench::DoNotOptimize(game.turn());
+    }
+}
+BENCHMARK(BM_SetupArenaReuse);
+
+static void BM_ScriptedMainGames(bench::State &state)
+{
+    for (auto _ : state)
+        playMainScript();
+}
+BENCHMARK(BM_ScriptedMainGames);
+
+/**
+ * Plays a game to the end with a fixed policy:
+ * coup the next live player when possible, otherwise tax.
+ * @return ---> Number of actions played.
+ */
+static int64_t playToEnd(Game &game)
+{
+    int64_t actions = 0;
+    size_t n = game.numPlayers();
+    size_t i = 0;
+    int alive = static_cast<int>(n);
+    while (alive > 1)
+    {
+        Player &p = game.getPlayer(i % n);
+        if (!game.isPlayerTurn(p))
+        {
+            ++i;
+            continue;
+        }
+        if (p.coins() >= 7)
+        {
+            size_t j = i + 1;
+            while (!game.getPlayer(j % n).Getstillingame())
+                ++j;
+            p.coup(game.getPlayer(j % n));
+            --alive;
+        }
+        else
+            p.tax();
+        ++actions;
+    }
+    return actions;
+}
+
+static void BM_FullGame(bench::State &state)
+{
+    int64_t actions = 0;
+    for (auto _ : state)
+    {
+        Table t;
+        actions += playToEnd(t.game);
+        bench::DoNotOptimize(t.game.winner());
+    }
+    state.SetItemsProcessed(actions);
+}
+BENCHMARK(BM_FullGame);
+
+// Back-to-back games from the thread's pool: setup is a reset in place instead of a new table.
+static void BM_FullGamePooled(bench::State &state)
+{
+    const vector<RoleType> layout = {RoleType::Governor, RoleType::Spy, RoleType::Baron,
+                                     RoleType::General, RoleType::Judge, RoleType::Merchant};
+    GamePool &pool = GamePool::local();
+    int64_t actions = 0;
+    uint64_t seed = 0;
+    for (auto _ : state)
+    {
+        GamePool::Handle game = pool.acquire(++seed, layout);
+        actions += playToEnd(*game);
+        bench::DoNotOptimize(game->winner());
+    }
+    state.SetItemsProcessed(actions);
+}
+BENCHMARK(BM_FullGamePooled);
+
+static void BM_LegalMoves(bench::State &state)
+{
+    Table t;
+    for (size_t i = 0; i < t.seats.size(); ++i)
+        t[i].AddCoins(4);
+    for (auto _ : state)
+        bench::DoNotOptimize(legalMoves(t.game));
+}
+BENCHMARK(BM_LegalMoves);
+
+// A whole 6-player game of random legal moves, as played by the simulator's bots.
+static void BM_RandomBotGame(bench::State &state)
+{
+    const vector<RoleType> layout = {RoleType::Governor, RoleType::Spy, RoleType::Baron,
+                                     RoleType::General, RoleType::Judge, RoleType::Merchant};
+    Game game;
+    RandomBot bot(1);
+    int64_t moves = 0;
+    uint64_t seed = 0;
+    for (auto _ : state)
+    {
+        game.reset(++seed, layout);
+        while (!game.isOver())
+        {
+            applyMove(game, bot.choose(game));
+            ++moves;
+        }
+    }
+    state.SetItemsProcessed(moves);
+}
+BENCHMARK(BM_RandomBotGame);
+
+int main(int argc, char **argv)
+{
+    // Simulations run silent: the engine's messages would otherwise end up in the report.
+    coup::Logger::instance().setLevel(coup::LogLevel::Off);
+    return bench::RunAll(argc, argv);
+}
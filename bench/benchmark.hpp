@@ -0,0 +1,311 @@
+// ronamsalem4@gmail.com
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <time.h>
+#include <vector>
+using namespace std;
+
+/**
+ * @file benchmark.hpp
+ * A small microbenchmark harness that follows the Google Benchmark API shape
+ * (State, range-for timing loop, BENCHMARK(fn)->DenseRange(...)) without requiring the library.
+ * The JSON it writes uses the same layout as Google Benchmark's --benchmark_out, so results of
+ * two commits can be compared with the usual tools, or with --baseline=<file> of this harness.
+ */
+
+namespace bench
+{
+    /**
+     * Prevents the compiler from optimizing away a value computed inside a benchmark loop.
+     * @param value ---> The value that must be considered "used".
+     */
+    template <typename T>
+    inline void DoNotOptimize(T const &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+     * Per-run state handed to every benchmark function.
+     * The function iterates over the state ("for (auto _ : state)"), and only the time spent
+     * inside that loop (minus paused sections) is measured, both on the wall clock and as CPU time of the
+     * process (all its threads).
+     */
+    class State
+    {
+    private:
+        using Clock = chrono::steady_clock;
+        uint64_t maxIterations;
+        vector<int64_t> args;
+        Clock::time_point startTime;
+        Clock::duration paused{0};
+        Clock::time_point pauseStart;
+        double cpuStart = 0, cpuPaused = 0, cpuPauseStart = 0;
+        double elapsedNs = 0, cpuNs = 0;
+        int64_t itemsProcessed = 0;
+
+        static double cpuNow() // @return ---> CPU time used by the process so far, in nanoseconds.
+        {
+            timespec ts;
+            clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+            return ts.tv_sec * 1e9 + ts.tv_nsec;
+        }
+
+    public:
+        State(uint64_t iterations, const vector<int64_t> &args) : maxIterations(iterations), args(args) {}
+
+        // The loop variable of "for (auto _ : state)"; the user-provided destructor keeps -Wunused quiet.
+        struct Value
+        {
+            ~Value() {}
+        };
+
+        struct Iterator
+        {
+            State *state;
+            uint64_t left;
+            bool operator!=(const Iterator &) const
+            {
+                if (left != 0)
+                    return true;
+                state->finish();
+                return false;
+            }
+            void operator++() { --left; }
+            Value operator*() const { return Value(); }
+        };
+
+        Iterator begin()
+        {
+            cpuStart = cpuNow();
+            startTime = Clock::now();
+            return Iterator{this, maxIterations};
+        }
+        Iterator end() { return Iterator{this, 0}; }
+
+        void finish()
+        {
+            elapsedNs = chrono::duration<double, nano>(Clock::now() - startTime - paused).count();
+            cpuNs = cpuNow() - cpuStart - cpuPaused;
+        }
+
+        // Stops the clocks (setup work that should not be measured).
+        void PauseTiming()
+        {
+            pauseStart = Clock::now();
+            cpuPauseStart = cpuNow();
+        }
+
+        // Restarts the clocks after PauseTiming().
+        void ResumeTiming()
+        {
+            paused += Clock::now() - pauseStart;
+            cpuPaused += cpuNow() - cpuPauseStart;
+        }
+
+        int64_t range(size_t i = 0) const { return args.at(i); }          // @return ---> The i-th argument of this run.
+        uint64_t iterations() const { return maxIterations; }             // @return ---> Number of loop iterations of this run.
+        void SetItemsProcessed(int64_t items) { itemsProcessed = items; } // Reports a throughput counter (items/s in the output).
+        double elapsed() const { return elapsedNs; }                      // @return ---> Measured wall-clock time of this run, in nanoseconds.
+        double cpuTime() const { return cpuNs; }                          // @return ---> Measured CPU time of this run, in nanoseconds.
+        int64_t items() const { return itemsProcessed; }                  // @return ---> Value set by SetItemsProcessed.
+    };
+
+    /**
+     * A registered benchmark: a function and the argument lists it is run with.
+     */
+    class Benchmark
+    {
+    public:
+        string name;
+        function<void(State &)> fn;
+        vector<vector<int64_t>> argSets;
+
+        Benchmark(const string &name, function<void(State &)> fn) : name(name), fn(std::move(fn)) {}
+
+        Benchmark *Arg(int64_t a)
+        {
+            argSets.push_back({a});
+            return this;
+        }
+
+        Benchmark *DenseRange(int64_t from, int64_t to)
+        {
+            for (int64_t a = from; a <= to; ++a)
+                argSets.push_back({a});
+            return this;
+        }
+    };
+
+    inline deque<Benchmark> &registry()
+    {
+        static deque<Benchmark> benchmarks; // deque: registered entries never move
+        return benchmarks;
+    }
+
+    inline Benchmark *RegisterBenchmark(const string &name, function<void(State &)> fn)
+    {
+        registry().emplace_back(name, std::move(fn));
+        return &registry().back();
+    }
+
+    /**
+     * The result of one benchmark/argument combination.
+     */
+    struct Result
+    {
+        string name;
+        uint64_t iterations;
+        double nsPerIteration;    // wall clock ("real_time")
+        double cpuNsPerIteration; // CPU time of the process, all threads ("cpu_time")
+        double itemsPerSecond;
+    };
+
+    /**
+     * Runs one benchmark with growing iteration counts until it takes at least minTime seconds.
+     */
+    inline Result runOne(Benchmark &b, const vector<int64_t> &args, double minTime)
+    {
+        uint64_t iterations = 1;
+        while (true)
+        {
+            State state(iterations, args);
+            b.fn(state);
+            double seconds = state.elapsed() / 1e9;
+            if (seconds >= minTime || iterations >= (1ULL << 32))
+            {
+                string name = b.name;
+                for (int64_t a : args)
+                    name += "/" + to_string(a);
+                double ips = state.items() > 0 ? state.items() / seconds : 0;
+                return Result{name, iterations, state.elapsed() / iterations, state.cpuTime() / iterations, ips};
+            }
+            // Aim directly for minTime (with some headroom), but never grow more than 10x per step.
+            double factor = seconds > 0 ? minTime * 1.4 / seconds : 10;
+            if (factor > 10)
+                factor = 10;
+            if (factor < 2)
+                factor = 2;
+            iterations = static_cast<uint64_t>(iterations * factor);
+        }
+    }
+
+    /**
+     * Reads the "name" -> real_time pairs of a JSON file previously written by writeJson
+     * (the time the report table prints and compares).
+     */
+    inline map<string, double> readBaseline(const string &path)
+    {
+        map<string, double> times;
+        ifstream in(path);
+        string line, name;
+        while (getline(in, line))
+        {
+            size_t key = line.find("\"name\": \"");
+            if (key != string::npos)
+            {
+                size_t from = key + 9;
+                name = line.substr(from, line.find('"', from) - from);
+            }
+            key = line.find("\"real_time\": ");
+            if (key != string::npos && !name.empty())
+                times[name] = stod(line.substr(key + 13));
+        }
+        return times;
+    }
+
+    inline void writeJson(const string &path, const vector<Result> &results)
+    {
+        ofstream out(path);
+        out << "{\n  \"context\": {\n    \"library_build_type\": \"release\",\n    \"executable\": \"coup_bench\"\n  },\n";
+        out << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result &r = results[i];
+            out << "    {\n";
+            out << "      \"name\": \"" << r.name << "\",\n";
+            out << "      \"run_type\": \"iteration\",\n";
+            out << "      \"iterations\": " << r.iterations << ",\n";
+            out << "      \"real_time\": " << r.nsPerIteration << ",\n";
+            out << "      \"cpu_time\": " << r.cpuNsPerIteration << ",\n";
+            if (r.itemsPerSecond > 0)
+                out << "      \"items_per_second\": " << r.itemsPerSecond << ",\n";
+            out << "      \"time_unit\": \"ns\"\n";
+            out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    /**
+     * Entry point of a benchmark binary.
+     * Flags: --filter=<substring>, --min_time=<seconds>, --out=<file.json>, --baseline=<file.json>.
+     * @param report ---> Where the human readable table is printed.
+     * @return ---> Process exit code.
+     */
+    inline int RunAll(int argc, char **argv, ostream &report = cout)
+    {
+        string filter, out = "bench_results.json", baseline;
+        double minTime = 0.2;
+        for (int i = 1; i < argc; ++i)
+        {
+            string arg = argv[i];
+            if (arg.rfind("--filter=", 0) == 0)
+                filter = arg.substr(9);
+            else if (arg.rfind("--min_time=", 0) == 0)
+                minTime = stod(arg.substr(11));
+            else if (arg.rfind("--out=", 0) == 0)
+                out = arg.substr(6);
+            else if (arg.rfind("--baseline=", 0) == 0)
+                baseline = arg.substr(11);
+        }
+
+        map<string, double> old;
+        if (!baseline.empty())
+            old = readBaseline(baseline);
+
+        vector<Result> results;
+        report << left << setw(40) << "Benchmark" << right << setw(14) << "Time(ns)" << setw(14) << "Iterations";
+        report << (old.empty() ? "" : "      vs base") << "\n";
+        report << string(old.empty() ? 68 : 82, '-') << "\n";
+        for (Benchmark &b : registry())
+        {
+            vector<vector<int64_t>> sets = b.argSets.empty() ? vector<vector<int64_t>>{{}} : b.argSets;
+            for (const vector<int64_t> &args : sets)
+            {
+                string name = b.name;
+                for (int64_t a : args)
+                    name += "/" + to_string(a);
+                if (!filter.empty() && name.find(filter) == string::npos)
+                    continue;
+                Result r = runOne(b, args, minTime);
+                results.push_back(r);
+                report << left << setw(40) << r.name << right << setw(14) << fixed << setprecision(1) << r.nsPerIteration
+                     << setw(14) << r.iterations;
+                auto it = old.find(r.name);
+                if (it != old.end() && it->second > 0)
+                    report << setw(12) << showpos << (r.nsPerIteration / it->second - 1) * 100 << noshowpos << "%";
+                report << "\n";
+            }
+        }
+        writeJson(out, results);
+        report << "\nResults written to " << out << "\n";
+        return 0;
+    }
+}
+
+#define BENCH_CONCAT2(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT2(a, b)
+#define BENCHMARK(fn) \
+    static ::bench::Benchmark *BENCH_CONCAT(bench_registration_, __LINE__) = ::bench::RegisterBenchmark(#fn, fn)
+
+#endif
@@ -0,0 +1,187 @@
+// ronamsalem4@gmail.com
+#include "OpeningBook.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
+
+namespace coup
+{
+    static constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'B', 'O', 'O', 'K'};
+    static constexpr uint32_t BOOK_FORMAT = 1;
+    static constexpr size_t HEADER_SIZE = 16;
+
+    /**
+     * Mixes the eight words of an image (seed cleared) with the splitmix64 finalizer.
+     */
+    static uint64_t imageKey(GameImage image)
+    {
+        image.seed = 0;
+        uint64_t words[sizeof(GameImage) / 8];
+        memcpy(words, &image, sizeof(GameImage));
+        uint64_t hash = 0x9E3779B97F4A7C15ULL;
+        for (uint64_t word : words)
+        {
+            hash ^= word;
+            hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+            hash ^= hash >> 31;
+        }
+        return hash;
+    }
+
+    uint64_t positionKey(const Game &game)
+    {
+        GameImage image;
+        game.captureImage(image);
+        return imageKey(image);
+    }
+
+    /**
+     * Level by level: the positions of one ply are searched on the threads (each with its own bot, reseeded per
+     * position so the book does not depend on the thread count), and their children not seen before make the next
+     * ply.
+     */
+    vector<BookEntry> buildOpeningBook(const vector<RoleType> &layout, unsigned plies, size_t playouts, size_t threads,
+                                       uint64_t seed)
+    {
+        threads = threads == 0 ? 1 : threads;
+        Game game;
+        game.reset(0, layout);
+        vector<GameImage> level(1);
+        game.captureImage(level[0]);
+        unordered_set<uint64_t> seen{imageKey(level[0])};
+        vector<BookEntry> book;
+
+        for (unsigned ply = 0; ply < plies && !level.empty(); ++ply)
+        {
+            vector<BookEntry> entries(level.size());
+            vector<vector<GameImage>> children(level.size());
+            bool expand = ply + 1 < plies;
+            atomic<size_t> next{0};
+            vector<thread> workers;
+            for (size_t t = 0; t < threads; ++t)
+                workers.emplace_back([&]
+                                     {
+                    Game position;
+                    RolloutBot bot(seed, playouts);
+                    for (size_t i; (i = next.fetch_add(1)) < level.size();)
+                    {
+                        position.restoreImage(level[i]);
+                        if (position.isOver())
+                            continue;
+                        double value;
+                        bot.reseed(seed ^ imageKey(level[i]));
+                        Move move = bot.choose(position, &value);
+                        entries[i] = BookEntry{imageKey(level[i]), static_cast<uint8_t>(move.action), move.target,
+                                               move.option, 0, static_cast<float>(value)};
+                        if (!expand)
+                            continue;
+                        for (const Move &reply : legalMoves(position))
+                        {
+                            position.restoreImage(level[i]);
+                            applyMove(position, reply);
+                            children[i].emplace_back();
+                            position.captureImage(children[i].back());
+                        }
+                    } });
+            for (thread &worker : workers)
+                worker.join();
+
+            vector<GameImage> nextLevel;
+            for (size_t i = 0; i < level.size(); ++i)
+            {
+                if (entries[i].key != 0)
+                    book.push_back(entries[i]);
+                for (const GameImage &child : children[i])
+                    if (seen.insert(imageKey(child)).second)
+                        nextLevel.push_back(child);
+            }
+            level.swap(nextLevel);
+        }
+        std::sort(book.begin(), book.end(), [](const BookEntry &a, const BookEntry &b)
+                  { return a.key < b.key; });
+        return book;
+    }
+
+    void writeOpeningBook(const string &path, const vector<BookEntry> &entries)
+    {
+        ofstream file(path, ios::binary | ios::trunc);
+        uint32_t header[2] = {BOOK_FORMAT, static_cast<uint32_t>(entries.size())};
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(entries.data()), static_cast<streamsize>(entries.size() * sizeof(BookEntry)));
+        if (!file)
+            throw runtime_error("Cannot write " + path);
+    }
+
+    OpeningBook::OpeningBook(const string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw runtime_error("Cannot open " + path);
+        struct stat info{};
+        fstat(fd, &info);
+        mappedSize = static_cast<size_t>(info.st_size);
+        mapped = mappedSize >= HEADER_SIZE ? mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (mapped == MAP_FAILED)
+            throw runtime_error("Not an opening book: " + path);
+
+        const uint8_t *data = static_cast<const uint8_t *>(mapped);
+        uint32_t header[2];
+        memcpy(header, data + sizeof(MAGIC), sizeof(header));
+        count = header[1];
+        if (memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || header[0] != BOOK_FORMAT ||
+            mappedSize != HEADER_SIZE + count * sizeof(BookEntry))
+        {
+            munmap(mapped, mappedSize);
+            throw runtime_error("Not an opening book: " + path);
+        }
+        entries = reinterpret_cast<const BookEntry *>(data + HEADER_SIZE); // 16-aligned in the page-aligned map
+    }
+
+    OpeningBook::~OpeningBook()
+    {
+        munmap(mapped, mappedSize);
+    }
+
+    const BookEntry *OpeningBook::find(uint64_t key) const
+    {
+        const BookEntry *end = entries + count;
+        const BookEntry *it = std::lower_bound(entries, end, key, [](const BookEntry &entry, uint64_t k)
+                                               { return entry.key < k; });
+        return it != end && it->key == key ? it : nullptr;
+    }
+
+    /**
+     * A key shared by two positions is unlikely but possible, so the move is checked against the rules.
+     */
+    optional<Move> OpeningBook::lookup(const Game &game) const
+    {
+        const BookEntry *entry = find(positionKey(game));
+        if (entry == nullptr)
+            return nullopt;
+        Move move{static_cast<ActionType>(entry->action), entry->target, entry->option};
+        if (!legalMoves(game).contains(move))
+            return nullopt;
+        return move;
+    }
+
+    Move BookBot::choose(const Game &game)
+    {
+        if (optional<Move> move = book.lookup(game))
+        {
+            ++fromBook;
+            return *move;
+        }
+        return search.choose(game);
+    }
+}
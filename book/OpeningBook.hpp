@@ -0,0 +1,98 @@
+// ronamsalem4@gmail.com
+#ifndef OPENINGBOOK_HPP
+#define OPENINGBOOK_HPP
+#include "../game/Game.hpp"
+#include "../game/Moves.hpp"
+#include "../sim/RolloutBot.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @file OpeningBook.hpp
+ * Precomputed best moves for the first plies of a game.
+ * A position is keyed by a 64-bit hash of its GameImage (role layout, seat to move, coins, statuses; the seed is
+ * left out), so the same position reached by different move orders shares one entry.
+ * The book is built offline: every position reachable in the first plies from a role layout is searched with a
+ * RolloutBot. The file is "COUPBOOK", u32 format, u32 entry count, then 16-byte entries sorted by
+ * key; OpeningBook maps it and finds a position by binary search, without reading or allocating anything else.
+ */
+namespace coup
+{
+    struct BookEntry
+    {
+        uint64_t key = 0;
+        uint8_t action = 0, target = NO_SEAT, option = 0, reserved = 0; // the move
+        float value = 0; // share of the move's playouts the player won
+    };
+    static_assert(sizeof(BookEntry) == 16, "BookEntry is a file format");
+
+    uint64_t positionKey(const Game &game); // @return ---> The book key of the game's current position.
+
+    /**
+     * Searches every position reachable from a role layout in the first plies (blocks aside).
+     * @param layout ---> Roles of the seats, in turn order.
+     * @param plies ---> Depth of the book: positions with fewer moves played than this get an entry.
+     * @param playouts ---> Playouts per legal move of each search (see RolloutBot).
+     * @param threads ---> Search threads.
+     * @param seed ---> Seed of the searches.
+     * @return ---> The entries, sorted by key (one per position).
+     */
+    vector<BookEntry> buildOpeningBook(const vector<RoleType> &layout, unsigned plies, size_t playouts, size_t threads,
+                                       uint64_t seed);
+
+    /**
+     * Writes entries (sorted by buildOpeningBook, or merged books sorted again) to a book file.
+     * @throws ---> runtime_error if the file cannot be written.
+     */
+    void writeOpeningBook(const string &path, const vector<BookEntry> &entries);
+
+    class OpeningBook
+    {
+    public:
+        /**
+         * Maps a book file read-only.
+         * @throws ---> runtime_error if it cannot be mapped or is not a whole book file.
+         */
+        explicit OpeningBook(const string &path);
+        ~OpeningBook();
+        OpeningBook(const OpeningBook &) = delete;
+        OpeningBook &operator=(const OpeningBook &) = delete;
+
+        size_t size() const { return count; }                // @return ---> Number of positions.
+        const BookEntry *find(uint64_t key) const;           // @return ---> The entry of a key, or nullptr.
+
+        /**
+         * @param game ---> A started game that is not over.
+         * @return ---> The book move of the current position, if the book has it and it is legal there.
+         */
+        optional<Move> lookup(const Game &game) const;
+
+    private:
+        void *mapped = nullptr;
+        size_t mappedSize = 0;
+        const BookEntry *entries = nullptr;
+        size_t count = 0;
+    };
+
+    /**
+     * @class BookBot
+     * Plays the book move while the game is in the book, and searches (RolloutBot) once it is out.
+     */
+    class BookBot
+    {
+    public:
+        BookBot(const OpeningBook &book, uint64_t seed, size_t playouts = 32) : book(book), search(seed, playouts) {}
+
+        Move choose(const Game &game);                       // @return ---> The move to play.
+        uint64_t bookMoves() const { return fromBook; }      // @return ---> Moves that came from the book.
+
+    private:
+        const OpeningBook &book;
+        RolloutBot search;
+        uint64_t fromBook = 0;
+    };
+}
+
+#endif
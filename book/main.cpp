@@ -0,0 +1,76 @@
+// ronamsalem4@gmail.com
+#include "OpeningBook.hpp"
+#include "../game/Logger.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ * coup_book: builds an opening book for a role layout (by default the six roles of main.cpp, in its order).
+ * Usage: coup_book [--out=opening.book] [--roles=Governor,Spy,Baron,General,Judge,Merchant] [--plies=6]
+ *                  [--playouts=32] [--threads=N] [--seed=1]
+ */
+
+using namespace coup;
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    string path = "opening.book";
+    vector<RoleType> layout = {RoleType::Governor, RoleType::Spy, RoleType::Baron,
+                               RoleType::General, RoleType::Judge, RoleType::Merchant};
+    unsigned plies = 6;
+    size_t playouts = 32, threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 1;
+    try
+    {
+        for (int a = 1; a < argc; ++a)
+        {
+            string arg = argv[a];
+            size_t eq = arg.find('=');
+            string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+            if (key == "--out")
+                path = value;
+            else if (key == "--roles")
+            {
+                layout.clear();
+                for (size_t from = 0; from <= value.size();)
+                {
+                    size_t comma = std::min(value.find(',', from), value.size());
+                    layout.push_back(roleFromName(value.substr(from, comma - from)));
+                    from = comma + 1;
+                }
+            }
+            else if (key == "--plies")
+                plies = static_cast<unsigned>(stoul(value));
+            else if (key == "--playouts")
+                playouts = stoul(value);
+            else if (key == "--threads")
+                threads = std::max<size_t>(1, stoul(value));
+            else if (key == "--seed")
+                seed = stoull(value);
+            else
+            {
+                cerr << "Unknown option " << arg << endl;
+                return 2;
+            }
+        }
+        if (layout.size() < 2 || layout.size() > Game::MAX_PLAYERS)
+            throw invalid_argument("A layout has 2 to 6 roles");
+        Logger::instance().setLevel(LogLevel::Off); // the playouts run the rules millions of times
+
+        auto start = chrono::steady_clock::now();
+        vector<BookEntry> entries = buildOpeningBook(layout, plies, playouts, threads, seed);
+        writeOpeningBook(path, entries);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << entries.size() << " positions (" << plies << " plies, " << playouts << " playouts per move) written to "
+             << path << " in " << seconds << " s" << endl;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
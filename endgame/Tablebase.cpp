@@ -0,0 +1,421 @@
+// ronamsalem4@gmail.com
+#include "Tablebase.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace coup
+{
+    static constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'T', 'B', 'A', 'S'};
+    static constexpr uint32_t TABLEBASE_FORMAT = 1;
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t TABLES = ROLE_COUNT * ROLE_COUNT;
+    static constexpr uint8_t MAX_DISTANCE = 63;
+    static constexpr int MAX_OWED_TURNS = 3;
+
+    static uint8_t packEntry(EndgameResult result, uint32_t distance)
+    {
+        return static_cast<uint8_t>(static_cast<uint8_t>(result) | std::min<uint32_t>(distance, MAX_DISTANCE) << 2);
+    }
+
+    static EndgameProbe unpackEntry(uint8_t entry)
+    {
+        return EndgameProbe{static_cast<EndgameResult>(entry & 3), static_cast<uint8_t>(entry >> 2)};
+    }
+
+    /**
+     * Mixed radix, first digit lowest: mover's coins (16), other's coins (16), mover's sanctions (4: gather, tax),
+     * other's sanctions (4), turns the mover owes itself (4), last arrested player (3: none, mover, other),
+     * last actions that were arrests (4: mover, other).
+     */
+    optional<uint32_t> tablebaseIndex(const GameImage &image)
+    {
+        if (!image.started || image.numSeats < 2 || image.numSeats > Game::MAX_PLAYERS || image.turn >= image.numSeats)
+            return nullopt;
+        size_t mover = image.turn, other = NO_SEAT, alive = 0;
+        for (size_t s = 0; s < image.numSeats; ++s)
+            if (image.seats[s].flags & SeatImage::InGame)
+            {
+                ++alive;
+                if (s != mover)
+                    other = s;
+            }
+        if (alive != 2 || other == NO_SEAT || !(image.seats[mover].flags & SeatImage::InGame))
+            return nullopt;
+
+        const SeatImage &m = image.seats[mover], &o = image.seats[other];
+        if (((m.flags | o.flags) & SeatImage::ArrestTurnBlocked) || m.coins < 0 || m.coins > TABLEBASE_MAX_COINS ||
+            o.coins < 0 || o.coins > TABLEBASE_MAX_COINS || m.owedTurns < 0 || m.owedTurns > MAX_OWED_TURNS ||
+            o.owedTurns != 0 || static_cast<size_t>(m.role) >= ROLE_COUNT || static_cast<size_t>(o.role) >= ROLE_COUNT)
+            return nullopt;
+
+        auto sanctions = [](const SeatImage &seat)
+        {
+            return uint32_t((seat.flags & SeatImage::SanctionGather) ? 1 : 0) | ((seat.flags & SeatImage::SanctionTax) ? 2 : 0);
+        };
+        uint32_t victim = image.lastArrestedVictim == mover ? 1 : image.lastArrestedVictim == other ? 2 : 0;
+        uint32_t arrests = uint32_t(m.lastAction == ActionType::Arrest) | uint32_t(o.lastAction == ActionType::Arrest) << 1;
+        uint32_t position = static_cast<uint32_t>(m.coins) +
+                            16 * (static_cast<uint32_t>(o.coins) +
+                                  16 * (sanctions(m) + 4 * (sanctions(o) + 4 * (static_cast<uint32_t>(m.owedTurns) + 4 * (victim + 3 * arrests)))));
+        uint32_t table = static_cast<uint32_t>(m.role) * ROLE_COUNT + static_cast<uint32_t>(o.role);
+        return table * TABLEBASE_POSITIONS + position;
+    }
+
+    /**
+     * The position at an index, as a two-seat game with the mover in seat 0.
+     */
+    static GameImage positionImage(uint32_t index)
+    {
+        uint32_t table = index / TABLEBASE_POSITIONS, position = index % TABLEBASE_POSITIONS;
+        auto digit = [&position](uint32_t radix)
+        {
+            uint32_t value = position % radix;
+            position /= radix;
+            return value;
+        };
+        GameImage image;
+        image.numSeats = 2;
+        image.turn = 0;
+        image.started = 1;
+        SeatImage &m = image.seats[0], &o = image.seats[1];
+        m.role = static_cast<RoleType>(table / ROLE_COUNT);
+        o.role = static_cast<RoleType>(table % ROLE_COUNT);
+        m.coins = static_cast<int16_t>(digit(16));
+        o.coins = static_cast<int16_t>(digit(16));
+        for (SeatImage *seat : {&m, &o})
+        {
+            uint32_t sanctions = digit(4);
+            seat->flags = static_cast<uint8_t>(SeatImage::InGame | ((sanctions & 1) ? SeatImage::SanctionGather : 0) |
+                                               ((sanctions & 2) ? SeatImage::SanctionTax : 0));
+        }
+        m.owedTurns = static_cast<int8_t>(digit(4));
+        uint32_t victim = digit(3), arrests = digit(4);
+        image.lastArrestedVictim = victim == 0 ? NO_SEAT : static_cast<uint8_t>(victim - 1);
+        m.lastAction = (arrests & 1) ? ActionType::Arrest : ActionType::None;
+        o.lastAction = (arrests & 2) ? ActionType::Arrest : ActionType::None;
+        return image;
+    }
+
+    static constexpr uint32_t TERMINAL = 0xFFFFFFFF; // the move ends the game (the mover wins)
+    static constexpr uint32_t OUTSIDE = 0xFFFFFFFE;  // the move leaves the tables
+    static constexpr uint32_t OTHER_MOVES = 1u << 31; // flag of a successor where the other player moves
+
+    /**
+     * Solves the tables of the pair {a, b}: both orders, since every turn passes from one to the other.
+     * The moves of every position are expanded once into successors (two per move: the one the other player gets
+     * by not blocking and by blocking, the same twice if it cannot block). Then rounds: in round r a position is
+     * won if one of its moves wins against both answers in positions solved before round r, and lost if every move
+     * has an answer that wins for the other player; r is then its distance.
+     */
+    static void solvePair(RoleType a, RoleType b, vector<uint8_t> &entries)
+    {
+        uint32_t tables[2] = {static_cast<uint32_t>(static_cast<size_t>(a) * ROLE_COUNT + static_cast<size_t>(b)),
+                              static_cast<uint32_t>(static_cast<size_t>(b) * ROLE_COUNT + static_cast<size_t>(a))};
+        uint32_t count = tables[0] == tables[1] ? TABLEBASE_POSITIONS : 2 * TABLEBASE_POSITIONS;
+        auto local = [&](uint32_t index)
+        {
+            uint32_t table = index / TABLEBASE_POSITIONS;
+            return (table == tables[0] ? 0 : TABLEBASE_POSITIONS) + index % TABLEBASE_POSITIONS;
+        };
+        auto global = [&](uint32_t l)
+        {
+            return tables[l / TABLEBASE_POSITIONS] * TABLEBASE_POSITIONS + l % TABLEBASE_POSITIONS;
+        };
+
+        Game game;
+        GameImage image;
+        auto successor = [&]() -> uint32_t
+        {
+            if (game.isOver())
+                return TERMINAL;
+            game.captureImage(image);
+            optional<uint32_t> index = tablebaseIndex(image);
+            if (!index)
+                return OUTSIDE;
+            return local(*index) | (game.turnSeat() != 0 ? OTHER_MOVES : 0);
+        };
+
+        vector<uint32_t> firstMove(count + 1, 0);
+        vector<uint32_t> answers; // two per move
+        for (uint32_t l = 0; l < count; ++l)
+        {
+            firstMove[l] = static_cast<uint32_t>(answers.size() / 2);
+            GameImage start = positionImage(global(l));
+            game.restoreImage(start);
+            for (const Move &move : legalMoves(game))
+            {
+                game.restoreImage(start);
+                bool blockable = canBlock(game, 1, move);
+                try
+                {
+                    applyMove(game, move);
+                }
+                catch (const invalid_argument &)
+                {
+                    continue; // the rules refused it after all
+                }
+                uint32_t played = successor(), blocked = played;
+                if (blockable)
+                {
+                    try
+                    {
+                        applyBlock(game, 1, 0, move);
+                        blocked = successor();
+                    }
+                    catch (const invalid_argument &)
+                    {
+                    }
+                }
+                answers.push_back(played);
+                answers.push_back(blocked);
+            }
+        }
+        firstMove[count] = static_cast<uint32_t>(answers.size() / 2);
+
+        vector<EndgameResult> result(count, EndgameResult::Draw);
+        vector<uint32_t> round(count, 0); // 0: not solved yet
+        for (uint32_t r = 1;; ++r)
+        {
+            bool changed = false;
+            for (uint32_t l = 0; l < count; ++l)
+            {
+                if (round[l] != 0 || firstMove[l] == firstMove[l + 1])
+                    continue;
+                bool win = false, loss = true;
+                for (uint32_t m = firstMove[l]; m < firstMove[l + 1] && !win; ++m)
+                {
+                    bool moveWins = true, moveLoses = false;
+                    for (uint32_t answer : {answers[2 * m], answers[2 * m + 1]})
+                    {
+                        if (answer == TERMINAL)
+                            continue;
+                        uint32_t next = answer & ~OTHER_MOVES;
+                        if (answer == OUTSIDE || round[next] == 0 || round[next] >= r)
+                        {
+                            moveWins = false;
+                            continue;
+                        }
+                        bool nextWins = (result[next] == EndgameResult::Win) != ((answer & OTHER_MOVES) != 0);
+                        moveWins = moveWins && nextWins;
+                        moveLoses = moveLoses || !nextWins;
+                    }
+                    win = moveWins && !moveLoses;
+                    loss = loss && moveLoses;
+                }
+                if (win || loss)
+                {
+                    result[l] = win ? EndgameResult::Win : EndgameResult::Loss;
+                    round[l] = r;
+                    changed = true;
+                }
+            }
+            if (!changed)
+                break;
+        }
+        for (uint32_t l = 0; l < count; ++l)
+            entries[global(l)] = packEntry(result[l], round[l]);
+    }
+
+    /**
+     * Pairs are taken by the threads from a shared counter; each pair writes only its own two tables.
+     */
+    vector<uint8_t> buildTablebase(size_t threads, const vector<RoleType> &roles)
+    {
+        vector<RoleType> chosen = roles;
+        if (chosen.empty())
+            for (size_t r = 0; r < ROLE_COUNT; ++r)
+                chosen.push_back(static_cast<RoleType>(r));
+        std::sort(chosen.begin(), chosen.end());
+        chosen.erase(std::unique(chosen.begin(), chosen.end()), chosen.end());
+        vector<pair<RoleType, RoleType>> pairs;
+        for (size_t i = 0; i < chosen.size(); ++i)
+            for (size_t j = i; j < chosen.size(); ++j)
+                pairs.emplace_back(chosen[i], chosen[j]);
+
+        vector<uint8_t> entries(TABLES * TABLEBASE_POSITIONS, packEntry(EndgameResult::Unsolved, 0));
+        threads = std::clamp<size_t>(threads, 1, pairs.size());
+        atomic<size_t> next{0};
+        vector<thread> workers;
+        for (size_t t = 0; t < threads; ++t)
+            workers.emplace_back([&]
+                                 {
+                for (size_t p; (p = next.fetch_add(1)) < pairs.size();)
+                    solvePair(pairs[p].first, pairs[p].second, entries); });
+        for (thread &worker : workers)
+            worker.join();
+        return entries;
+    }
+
+    void writeTablebase(const string &path, const vector<uint8_t> &entries)
+    {
+        if (entries.size() != TABLES * TABLEBASE_POSITIONS)
+            throw invalid_argument("Not a whole tablebase");
+        ofstream file(path, ios::binary | ios::trunc);
+        uint32_t header[2] = {TABLEBASE_FORMAT, TABLEBASE_POSITIONS};
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(entries.data()), static_cast<streamsize>(entries.size()));
+        if (!file)
+            throw runtime_error("Cannot write " + path);
+    }
+
+    Tablebase::Tablebase(const string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw runtime_error("Cannot open " + path);
+        struct stat info{};
+        fstat(fd, &info);
+        mappedSize = static_cast<size_t>(info.st_size);
+        mapped = mappedSize >= HEADER_SIZE ? mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (mapped == MAP_FAILED)
+            throw runtime_error("Not a tablebase: " + path);
+
+        const uint8_t *data = static_cast<const uint8_t *>(mapped);
+        uint32_t header[2];
+        memcpy(header, data + sizeof(MAGIC), sizeof(header));
+        if (memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || header[0] != TABLEBASE_FORMAT || header[1] != TABLEBASE_POSITIONS ||
+            mappedSize != HEADER_SIZE + TABLES * TABLEBASE_POSITIONS)
+        {
+            munmap(mapped, mappedSize);
+            throw runtime_error("Not a tablebase: " + path);
+        }
+        entries = data + HEADER_SIZE;
+    }
+
+    Tablebase::~Tablebase()
+    {
+        munmap(mapped, mappedSize);
+    }
+
+    EndgameProbe Tablebase::entry(uint32_t index) const
+    {
+        return unpackEntry(entries[index]);
+    }
+
+    optional<EndgameProbe> Tablebase::probe(const Game &game) const
+    {
+        GameImage image;
+        game.captureImage(image);
+        optional<uint32_t> index = tablebaseIndex(image);
+        if (!index)
+            return nullopt;
+        EndgameProbe found = entry(*index);
+        if (found.result == EndgameResult::Unsolved)
+            return nullopt;
+        return found;
+    }
+
+    /**
+     * Scores a position for one side: a win in d moves scores 100 - d, a loss -100 + d, a draw (or a position
+     * outside the tables) 0, and a finished game 101 / -101.
+     */
+    static int sideScore(const Tablebase &tables, const Game &position, size_t side)
+    {
+        if (position.isOver())
+            return position.winnerSeat() == side ? 101 : -101;
+        optional<EndgameProbe> found = tables.probe(position);
+        int value = !found || found->result == EndgameResult::Draw ? 0
+                    : found->result == EndgameResult::Win       ? 100 - found->distance
+                                                                : -100 + found->distance;
+        return position.turnSeat() == side ? value : -value;
+    }
+
+    /**
+     * A move is scored by the position it leads to; the other player picks the lower score of blocking or not.
+     */
+    optional<Move> Tablebase::bestMove(const Game &game, Game &scratch) const
+    {
+        if (!probe(game))
+            return nullopt;
+        GameImage start;
+        game.captureImage(start);
+        size_t mover = game.turnSeat(), other = mover;
+        for (size_t s = 0; s < start.numSeats; ++s)
+            if (s != mover && (start.seats[s].flags & SeatImage::InGame))
+                other = s;
+
+        optional<Move> best;
+        int bestScore = -1000;
+        for (const Move &move : legalMoves(game))
+        {
+            bool blockable = canBlock(game, other, move);
+            int moveScore;
+            try
+            {
+                scratch.restoreImage(start);
+                applyMove(scratch, move);
+                moveScore = sideScore(*this, scratch, mover);
+            }
+            catch (const invalid_argument &)
+            {
+                continue;
+            }
+            if (blockable)
+            {
+                try
+                {
+                    applyBlock(scratch, other, mover, move);
+                    moveScore = std::min(moveScore, sideScore(*this, scratch, mover));
+                }
+                catch (const invalid_argument &)
+                {
+                    // the rules refuse the block: the move stands
+                }
+            }
+            if (moveScore > bestScore)
+            {
+                bestScore = moveScore;
+                best = move;
+            }
+        }
+        return best;
+    }
+
+    optional<bool> Tablebase::bestBlock(const Game &game, size_t blocker, const Move &move, Game &scratch) const
+    {
+        if (!probe(game) || !canBlock(game, blocker, move))
+            return nullopt;
+        GameImage start;
+        game.captureImage(start);
+        size_t actor = game.turnSeat();
+        try
+        {
+            scratch.restoreImage(start);
+            applyMove(scratch, move);
+            int played = sideScore(*this, scratch, blocker);
+            applyBlock(scratch, blocker, actor, move);
+            return sideScore(*this, scratch, blocker) > played;
+        }
+        catch (const invalid_argument &)
+        {
+            return nullopt;
+        }
+    }
+
+    Move EndgameBot::choose(const Game &game)
+    {
+        if (optional<Move> move = tables.bestMove(game, scratch))
+        {
+            ++fromTables;
+            return *move;
+        }
+        return search.choose(game);
+    }
+
+    bool EndgameBot::block(const Game &game, size_t blocker, const Move &move)
+    {
+        if (optional<bool> answer = tables.bestBlock(game, blocker, move, scratch))
+            return *answer;
+        return canBlock(game, blocker, move);
+    }
+}
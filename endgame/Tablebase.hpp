@@ -0,0 +1,131 @@
+// ronamsalem4@gmail.com
+#ifndef TABLEBASE_HPP
+#define TABLEBASE_HPP
+#include "../game/Game.hpp"
+#include "../game/GameImage.hpp"
+#include "../game/Moves.hpp"
+#include "../sim/RolloutBot.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @file Tablebase.hpp
+ * Solved endings: every position with two players left, for every pair of roles.
+ * A position is seen from the player to move and holds what the rules read on the following turns: both roles,
+ * both players' coins (0 to TABLEBASE_MAX_COINS), their sanctions, the turns the mover still owes itself from a bribe (0 to 3),
+ * the last arrested player and whether each player's last action was an arrest. Seats, names and eliminated players
+ * do not matter, so one table serves an ending of any game. Anything else (a Spy's arrest block, more coins) is
+ * outside the tables and probes return nothing.
+ * The tables are solved by retrograde analysis over the engine's own moves (legalMoves / applyMove): positions
+ * won on the first move, then those whose moves all lose or one of which wins against every answer, and so on;
+ * the blocks the other player may answer with (Governor undo, Judge block) count as its choice. Positions
+ * neither side can force are draws.
+ * Each position is one byte, result in the low 2 bits and distance (moves to the end with best play) in the high 6.
+ * The file is "COUPTBAS", u32 format, u32 positions per table, then the ROLE_COUNT * ROLE_COUNT tables, the
+ * table of (mover role, other role) at index mover * ROLE_COUNT + other. Tablebase maps it and probes in O(1).
+ */
+namespace coup
+{
+    static constexpr int TABLEBASE_MAX_COINS = 15;
+    static constexpr uint32_t TABLEBASE_POSITIONS = 16 * 16 * 4 * 4 * 4 * 3 * 4; // positions per pair of roles
+
+    enum class EndgameResult : uint8_t
+    {
+        Unsolved, // a table that was not built
+        Win,      // for the player to move
+        Loss,
+        Draw
+    };
+
+    struct EndgameProbe
+    {
+        EndgameResult result = EndgameResult::Unsolved;
+        uint8_t distance = 0; // moves until the game ends (Win / Loss; saturates at 63)
+    };
+
+    /**
+     * @param image ---> A game image.
+     * @return ---> Index of its position in the whole tablebase (table * TABLEBASE_POSITIONS + position), or
+     *              nullopt if the game is not a two-player ending the tables cover.
+     */
+    optional<uint32_t> tablebaseIndex(const GameImage &image);
+
+    /**
+     * Solves the tables of every pair of the given roles (all roles by default), each pair on one of the threads.
+     * @return ---> ROLE_COUNT * ROLE_COUNT * TABLEBASE_POSITIONS entries; those of other pairs stay Unsolved.
+     */
+    vector<uint8_t> buildTablebase(size_t threads, const vector<RoleType> &roles = {});
+
+    /**
+     * Writes the entries of buildTablebase to a file.
+     * @throws ---> runtime_error if the file cannot be written.
+     */
+    void writeTablebase(const string &path, const vector<uint8_t> &entries);
+
+    class Tablebase
+    {
+    public:
+        /**
+         * Maps a tablebase file read-only.
+         * @throws ---> runtime_error if it cannot be mapped or is not a whole tablebase.
+         */
+        explicit Tablebase(const string &path);
+        ~Tablebase();
+        Tablebase(const Tablebase &) = delete;
+        Tablebase &operator=(const Tablebase &) = delete;
+
+        EndgameProbe entry(uint32_t index) const; // @return ---> The entry at a tablebase index.
+
+        /**
+         * @return ---> The result of the game for the player to move, or nullopt outside the tables.
+         */
+        optional<EndgameProbe> probe(const Game &game) const;
+
+        /**
+         * The move with the best result: the quickest win, else a draw, else the longest loss; a move the other
+         * player may block counts with its worse answer.
+         * @param game ---> A started game that is not over.
+         * @param scratch ---> A game the moves are tried on (its state is overwritten).
+         * @return ---> The move, or nullopt outside the tables.
+         */
+        optional<Move> bestMove(const Game &game, Game &scratch) const;
+
+        /**
+         * Whether blocking a move of the player to move is the better answer for the blocker.
+         * @param game ---> The game before the move is played.
+         * @param scratch ---> A game the answers are tried on (its state is overwritten).
+         * @return ---> true to block, or nullopt outside the tables or if the player cannot block the move.
+         */
+        optional<bool> bestBlock(const Game &game, size_t blocker, const Move &move, Game &scratch) const;
+
+    private:
+        void *mapped = nullptr;
+        size_t mappedSize = 0;
+        const uint8_t *entries = nullptr;
+    };
+
+    /**
+     * @class EndgameBot
+     * Plays the tablebase move once two players are left and searches (RolloutBot) before that. Outside the tables
+     * it blocks whenever it can.
+     */
+    class EndgameBot
+    {
+    public:
+        EndgameBot(const Tablebase &tables, uint64_t seed, size_t playouts = 32) : tables(tables), search(seed, playouts) {}
+
+        Move choose(const Game &game);                       // @return ---> The move to play.
+        bool block(const Game &game, size_t blocker, const Move &move); // @return ---> true to block the move.
+        uint64_t tableMoves() const { return fromTables; }   // @return ---> Moves that came from the tablebase.
+
+    private:
+        const Tablebase &tables;
+        RolloutBot search;
+        Game scratch;
+        uint64_t fromTables = 0;
+    };
+}
+
+#endif
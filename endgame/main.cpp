@@ -0,0 +1,73 @@
+// ronamsalem4@gmail.com
+#include "Tablebase.hpp"
+#include "../game/Logger.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ * coup_tablebase: solves the two-player endings of every pair of roles (or of the listed roles) and writes them.
+ * Usage: coup_tablebase [--out=endgame.tb] [--roles=Governor,Judge] [--threads=N]
+ */
+
+using namespace coup;
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    string path = "endgame.tb";
+    vector<RoleType> roles;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    try
+    {
+        for (int a = 1; a < argc; ++a)
+        {
+            string arg = argv[a];
+            size_t eq = arg.find('=');
+            string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+            if (key == "--out")
+                path = value;
+            else if (key == "--roles")
+            {
+                for (size_t from = 0; from <= value.size();)
+                {
+                    size_t comma = std::min(value.find(',', from), value.size());
+                    roles.push_back(roleFromName(value.substr(from, comma - from)));
+                    from = comma + 1;
+                }
+            }
+            else if (key == "--threads")
+                threads = std::max<size_t>(1, stoul(value));
+            else
+            {
+                cerr << "Unknown option " << arg << endl;
+                return 2;
+            }
+        }
+        Logger::instance().setLevel(LogLevel::Off); // every position's moves run through the rules
+
+        auto start = chrono::steady_clock::now();
+        vector<uint8_t> entries = buildTablebase(threads, roles);
+        writeTablebase(path, entries);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        uint64_t counts[4] = {};
+        unsigned longest = 0;
+        for (uint8_t entry : entries)
+        {
+            ++counts[entry & 3];
+            if ((entry & 3) == static_cast<uint8_t>(EndgameResult::Win))
+                longest = std::max(longest, static_cast<unsigned>(entry >> 2));
+        }
+        cout << counts[1] + counts[2] + counts[3] << " positions solved (" << counts[1] << " wins, " << counts[2]
+             << " losses, " << counts[3] << " draws for the player to move, longest win " << longest
+             << " moves), written to " << path << " in " << seconds << " s" << endl;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+// ronamsalem4@gmail.com
+#ifndef ACTIONTYPE_HPP
+#define ACTIONTYPE_HPP
+#include <cstdint>
+
+/**
+ * Compact identifiers of everything a player can do in the game: the six general actions,
+ * the role abilities, and the blocking / undo reactions.
+ */
+namespace coup
+{
+    enum class ActionType : std::uint8_t
+    {
+        None,
+        Gather,
+        Tax,
+        Bribe,
+        Arrest,
+        Sanction,
+        Coup,
+        Invest,     // Baron
+        Watch,      // Spy: watch coins (also blocks the target's next arrest)
+        BlockArrest, // Spy: block the target's next arrest without watching
+        Undo,       // Governor undoes a tax / Judge undo on a Spy
+        BlockCoup,  // General
+        BlockBribe  // Judge
+    };
+
+    constexpr std::size_t ACTION_COUNT = 13; // Number of values in ActionType.
+
+    /**
+     * @return ---> The action's name as used in the rules ("gather", "tax", ...).
+     */
+    inline const char *actionName(ActionType action)
+    {
+        switch (action)
+        {
+        case ActionType::None:
+            return "none";
+        case ActionType::Gather:
+            return "gather";
+        case ActionType::Tax:
+            return "tax";
+        case ActionType::Bribe:
+            return "bribe";
+        case ActionType::Arrest:
+            return "arrest";
+        case ActionType::Sanction:
+            return "sanction";
+        case ActionType::Coup:
+            return "coup";
+        case ActionType::Invest:
+            return "invest";
+        case ActionType::Watch:
+            return "watch";
+        case ActionType::BlockArrest:
+            return "block arrest";
+        case ActionType::Undo:
+            return "undo";
+        case ActionType::BlockCoup:
+            return "block coup";
+        case ActionType::BlockBribe:
+            return "block bribe";
+        }
+        return "unknown";
+    }
+}
+
+#endif
@@ -0,0 +1,151 @@
+// ronamsalem4@gmail.com
+#include "Events.hpp"
+#include <chrono>
+#include <stdexcept>
+
+namespace coup
+{
+    /**
+     * @return ---> The name of the event type.
+     */
+    const char *eventName(EventType type)
+    {
+        switch (type)
+        {
+        case EventType::ActionPerformed:
+            return "ActionPerformed";
+        case EventType::Blocked:
+            return "Blocked";
+        case EventType::Eliminated:
+            return "Eliminated";
+        case EventType::TurnAdvanced:
+            return "TurnAdvanced";
+        case EventType::GameOver:
+            return "GameOver";
+        }
+        return "Unknown";
+    }
+
+    /**
+     * Stops the dispatcher (if any) and delivers whatever is still in the ring.
+     */
+    EventBus::~EventBus()
+    {
+        stopDispatcher();
+        poll();
+    }
+
+    /**
+     * Adds a subscriber and allocates the ring on first use.
+     * @param subscriber ---> Callback for every event.
+     * @throws ---> logic_error while the dispatcher thread is running.
+     */
+    void EventBus::subscribe(Subscriber subscriber)
+    {
+        if (running.load())
+            throw logic_error("Subscribe before starting the event dispatcher.");
+        if (!ring)
+            ring.reset(new GameEvent[CAPACITY]);
+        subscribers.push_back(std::move(subscriber));
+    }
+
+    /**
+     * Writes one event into the ring (producer side).
+     * When the ring is full the producer waits for the dispatcher, or drops the event if there is none:
+     * draining the ring here would make the producer a second consumer next to the poll() thread.
+     * @param event ---> The event to queue.
+     */
+    void EventBus::push(const GameEvent &event)
+    {
+        size_t h = head.load(memory_order_relaxed);
+        while (h - tail.load(memory_order_acquire) >= CAPACITY)
+        {
+            if (!running.load(memory_order_relaxed))
+            {
+                ++droppedCount;
+                return;
+            }
+            this_thread::yield();
+        }
+        ring[h & (CAPACITY - 1)] = event;
+        head.store(h + 1, memory_order_release);
+    }
+
+    /**
+     * Delivers the queued events to every subscriber, in order (consumer side).
+     * @return ---> Number of events delivered.
+     */
+    size_t EventBus::poll()
+    {
+        if (!ring)
+            return 0;
+        size_t t = tail.load(memory_order_relaxed);
+        size_t h = head.load(memory_order_acquire);
+        size_t delivered = h - t;
+        for (; t != h; ++t)
+        {
+            const GameEvent &event = ring[t & (CAPACITY - 1)];
+            for (const Subscriber &subscriber : subscribers)
+                subscriber(event);
+            tail.store(t + 1, memory_order_release);
+        }
+        return delivered;
+    }
+
+    /**
+     * Starts the background thread that delivers events. It sleeps briefly whenever the ring is empty.
+     */
+    void EventBus::startDispatcher()
+    {
+        if (running.exchange(true))
+            return;
+        dispatcher = thread([this]
+                            {
+                                while (running.load(memory_order_acquire))
+                                {
+                                    if (poll() == 0)
+                                        this_thread::sleep_for(chrono::microseconds(200));
+                                }
+                                poll(); });
+    }
+
+    /**
+     * Stops the dispatcher thread; everything queued before the call is delivered first.
+     */
+    void EventBus::stopDispatcher()
+    {
+        if (!running.exchange(false))
+            return;
+        if (dispatcher.joinable())
+            dispatcher.join();
+    }
+
+    /**
+     * Stops the dispatcher, then forgets the subscribers and whatever is queued.
+     */
+    void EventBus::clear()
+    {
+        stopDispatcher();
+        subscribers.clear();
+        head.store(0, memory_order_relaxed);
+        tail.store(0, memory_order_relaxed);
+        nextSequence = 0;
+        droppedCount = 0;
+    }
+
+    /**
+     * Waits until all published events were delivered.
+     */
+    void EventBus::flush()
+    {
+        if (!ring)
+            return;
+        if (!running.load())
+        {
+            poll();
+            return;
+        }
+        while (tail.load(memory_order_acquire) != head.load(memory_order_acquire))
+            this_thread::yield();
+    }
+}
@@ -0,0 +1,130 @@
+// ronamsalem4@gmail.com
+#ifndef EVENTS_HPP
+#define EVENTS_HPP
+#include "ActionType.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+using namespace std;
+
+/**
+ * @file Events.hpp
+ * Typed game events and the per-game event bus.
+ * The rules code publishes what happened (an action, a block, an elimination, a turn change) instead of
+ * printing it; GUI, logging and analytics subscribe to the game's bus once and receive every event.
+ * Events go through a fixed-size lock-free single-producer / single-consumer ring buffer, so the game
+ * thread only copies a few bytes per event, and subscribers run on a dispatcher thread or wherever poll()
+ * is called. With no subscribers publish() returns right away and nothing is allocated.
+ */
+namespace coup
+{
+    enum class EventType : uint8_t
+    {
+        ActionPerformed, // actor did action (on target, if any)
+        Blocked,         // actor blocked or undid target's action
+        Eliminated,      // target left the game during actor's turn
+        TurnAdvanced,    // the turn passed to actor
+        GameOver         // actor is the only player left (published after the last Eliminated event)
+    };
+
+    constexpr uint8_t NO_SEAT = 0xFF; // Seat value of an event without actor or target.
+
+    /**
+     * One event. Players are identified by seat; names can be read with Game::nameOf(seat),
+     * which does not change while a game is being played.
+     */
+    struct GameEvent
+    {
+        EventType type;
+        ActionType action;   // The action performed or blocked (None for turn / elimination events).
+        uint8_t actor;       // Seat of the player who acted (NO_SEAT if none).
+        uint8_t target;      // Seat of the player acted upon (NO_SEAT if none).
+        int32_t coins;       // The actor's coins after the event (the target's, for Eliminated).
+        uint64_t sequence;   // Position of the event on its bus, starting at 0.
+    };
+
+    const char *eventName(EventType type); // @return ---> "ActionPerformed", "Blocked", ...
+
+    /**
+     * @class EventBus
+     * Delivers a game's events to its subscribers through a lock-free SPSC ring buffer.
+     * Producer: the thread that plays the game. Consumer: either the bus's dispatcher thread
+     * (startDispatcher) or a thread that calls poll() itself, never both at once.
+     */
+    class EventBus
+    {
+    public:
+        using Subscriber = function<void(const GameEvent &)>;
+        static constexpr size_t CAPACITY = 1024; // Events the ring can hold (power of two).
+
+        EventBus() = default;
+        ~EventBus(); // Stops the dispatcher thread and delivers the events still queued.
+        EventBus(const EventBus &) = delete;
+        EventBus &operator=(const EventBus &) = delete;
+
+        /**
+         * Registers a subscriber. Subscribers are registered once, before events start flowing;
+         * the ring buffer is allocated by the first subscription.
+         * @param subscriber ---> Called for every event, on the consuming thread.
+         * @throws ---> logic_error if the dispatcher thread is running.
+         */
+        void subscribe(Subscriber subscriber);
+
+        bool hasSubscribers() const { return !subscribers.empty(); } // @return ---> true if anyone listens.
+
+        /**
+         * Queues an event for the subscribers. Does nothing when there are none.
+         * If the ring is full, waits for the dispatcher thread to make room; with no dispatcher the event is
+         * dropped and counted (see dropped()), since only the poll() thread may consume. Its sequence number
+         * is still used, so subscribers see the gap.
+         */
+        void publish(EventType type, ActionType action, uint8_t actor, uint8_t target, int32_t coins)
+        {
+            if (subscribers.empty())
+                return;
+            push(GameEvent{type, action, actor, target, coins, nextSequence++});
+        }
+
+        /**
+         * Delivers all queued events to the subscribers on the calling thread.
+         * @return ---> Number of events delivered.
+         */
+        size_t poll();
+
+        void startDispatcher(); // Starts a thread that delivers events as they arrive.
+        void stopDispatcher();  // Stops that thread after it delivered everything queued.
+
+        /**
+         * Waits until every event published so far has been delivered
+         * (polls on this thread when there is no dispatcher).
+         */
+        void flush();
+
+        /**
+         * Returns the bus to its newly constructed state, keeping the ring's memory: stops the dispatcher,
+         * discards the queued events without delivering them, unregisters every subscriber and restarts the
+         * sequence and drop counters at 0.
+         */
+        void clear();
+
+        uint64_t published() const { return nextSequence; } // @return ---> Number of events published so far.
+        uint64_t dropped() const { return droppedCount; }   // @return ---> Events lost to a full ring (no dispatcher).
+
+    private:
+        void push(const GameEvent &event);
+
+        vector<Subscriber> subscribers;
+        unique_ptr<GameEvent[]> ring; // CAPACITY slots, allocated on the first subscribe().
+        alignas(64) atomic<size_t> head{0}; // Next slot to write (producer).
+        alignas(64) atomic<size_t> tail{0}; // Next slot to read (consumer).
+        uint64_t nextSequence = 0;
+        uint64_t droppedCount = 0; // Producer side, like nextSequence.
+        atomic<bool> running{false};
+        thread dispatcher;
+    };
+}
+
+#endif
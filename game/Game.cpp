@@ -1,6 +1,8 @@
 // ronamsalem4@gmail.com
 #include "Game.hpp"
 #include "Player.hpp"
+#include "../roles/RoleFactory.hpp"
+#include <algorithm>
 
 namespace coup
 {
@@ -8,21 +10,192 @@ namespace coup
      * Constructs a new Game object.
      * Initializes turn index to 0 and sets the game as not started.
      */
-    Game::Game() : index(0), startGame(false) {}
+    Game::Game() : index(0), startGame(false)
+    {
+        list_players.reserve(MAX_PLAYERS);
+        aliveNames.reserve(MAX_PLAYERS);
+    }
+
+    /**
+     * Destroys the players created in the arena by emplace().
+     */
+    Game::~Game()
+    {
+        destroyOwned();
+    }
+
+    /**
+     * Runs the destructors of the arena players, newest first.
+     * The arena memory stays with the game and is reused by the next emplace().
+     */
+    void Game::destroyOwned()
+    {
+        while (ownedCount > 0)
+        {
+            owned[--ownedCount]->~Player();
+        }
+    }
+
+    /**
+     * Returns the game to the state of a newly constructed Game, keeping all of its memory.
+     * Arena players are destroyed, every player is unregistered, the event bus loses its subscribers and
+     * queued events, and the turn index, start flag, extra turns and last arrested victim are reset.
+     */
+    void Game::clear()
+    {
+        bus.clear();
+        destroyOwned();
+        list_players.clear();
+        aliveMask = 0;
+        aliveCount = 0;
+        aliveNamesStale = true;
+        std::fill(extra_turns, extra_turns + MAX_PLAYERS, 0);
+        index = 0;
+        startGame = false;
+        lastArrestedVictim = nullptr;
+    }
+
+    /**
+     * Resets the game for a new match with the given seating.
+     * Matching seats are reset in place; the first seat whose role differs and every seat after it
+     * are destroyed and re-created in the same arena slots.
+     * @param seed ---> Seed of the new match.
+     * @param roleLayout ---> The role of each seat, in turn order.
+     * @throws ---> invalid_argument if the layout is too long or a caller-owned player would have to be rebuilt.
+     */
+    void Game::reset(uint64_t seed, const vector<RoleType> &roleLayout)
+    {
+        if (roleLayout.size() > MAX_PLAYERS)
+            throw invalid_argument("Maximum 6 players allowed.");
+
+        size_t keep = 0;
+        while (keep < list_players.size() && keep < roleLayout.size() && list_players[keep]->GetRoleType() == roleLayout[keep])
+            ++keep;
+
+        size_t oldSize = list_players.size();
+        if (keep < oldSize)
+        {
+            // Seats are rebuilt in their own arena slots, which only works when the game owns every seat.
+            bool allOwned = ownedCount == oldSize;
+            for (size_t i = 0; allOwned && i < oldSize; ++i)
+                allOwned = owned[i] == list_players[i];
+            if (!allOwned)
+                throw invalid_argument("Only players created with emplace() can be rebuilt by reset.");
+
+            while (ownedCount > keep)
+                owned[--ownedCount]->~Player();
+            list_players.resize(keep);
+            for (size_t i = keep; i < oldSize; ++i)
+                updateAlive(i, false);
+        }
+
+        for (size_t i = 0; i < keep; ++i)
+            list_players[i]->resetForNewGame();
+        // A rebuilt seat is re-registered under the name still in its slot of the name table.
+        for (size_t i = keep; i < roleLayout.size(); ++i)
+            emplaceRole(*this, roleLayout[i], i < oldSize ? name_table[i] : "Player " + to_string(i + 1));
+
+        std::fill(extra_turns, extra_turns + MAX_PLAYERS, 0);
+        index = 0;
+        startGame = list_players.size() >= 2;
+        lastArrestedVictim = nullptr;
+        this->seed = seed;
+    }
+
+    void Game::captureImage(GameImage &out) const
+    {
+        out = GameImage{};
+        out.seed = seed;
+        out.numSeats = static_cast<uint8_t>(list_players.size());
+        out.turn = static_cast<uint8_t>(index);
+        out.started = startGame ? 1 : 0;
+        out.lastArrestedVictim = lastArrestedVictim ? static_cast<uint8_t>(lastArrestedVictim->GetSeat()) : NO_SEAT;
+        for (size_t s = 0; s < list_players.size(); ++s)
+        {
+            list_players[s]->saveImage(out.seats[s]);
+            out.seats[s].owedTurns = static_cast<int8_t>(extra_turns[s]);
+        }
+    }
+
+    void Game::restoreImage(const GameImage &image)
+    {
+        if (image.numSeats > MAX_PLAYERS || (image.numSeats > 0 && image.turn >= image.numSeats) ||
+            (image.lastArrestedVictim != NO_SEAT && image.lastArrestedVictim >= image.numSeats))
+            throw invalid_argument("Malformed game image");
+        vector<RoleType> layout(image.numSeats);
+        for (size_t s = 0; s < layout.size(); ++s)
+        {
+            if (static_cast<size_t>(image.seats[s].role) >= ROLE_COUNT)
+                throw invalid_argument("Unknown role in game image");
+            layout[s] = image.seats[s].role;
+        }
+        reset(image.seed, layout);
+        for (size_t s = 0; s < layout.size(); ++s)
+        {
+            list_players[s]->loadImage(image.seats[s]);
+            extra_turns[s] = image.seats[s].owedTurns;
+        }
+        index = image.turn;
+        startGame = image.started != 0;
+        lastArrestedVictim = image.lastArrestedVictim == NO_SEAT ? nullptr : list_players[image.lastArrestedVictim];
+    }
+
+    /**
+     * @return ---> The game's event bus. Subscribe before the game is played.
+     */
+    EventBus &Game::events()
+    {
+        return bus;
+    }
+
+    /**
+     * @return ---> The seed of the current match, as given to reset().
+     */
+    uint64_t Game::getSeed() const
+    {
+        return seed;
+    }
+
+    /**
+     * @param seat ---> Seat number, 0 is the first player who joined.
+     * @return ---> The player in that seat, whether or not still in the game.
+     * @throws ---> out_of_range if there is no such seat.
+     */
+    Player &Game::getPlayer(size_t seat) const
+    {
+        return *list_players.at(seat);
+    }
+
+    /**
+     * @return ---> Number of players who joined the game.
+     */
+    size_t Game::numPlayers() const
+    {
+        return list_players.size();
+    }
 
     /**
      * Adds a player to the game before it starts.
      * If the number of players reaches 2 or more, the game is marked as started.
+     * The name is copied once into the seat's entry of the name table (reusing that entry's buffer).
      * @param player ---> Pointer to the Player to add.
+     * @param name ---> The player's name.
+     * @return ---> The seat of the new player.
      * @throws ---> invalid_argument if there are already 6 players.
      */
-    void Game::addPlayer(Player *player)
+    size_t Game::addPlayer(Player *player, const string &name)
     {
-        if (list_players.size() >= 6)
+        if (list_players.size() >= MAX_PLAYERS)
             throw invalid_argument("Maximum 6 players allowed.");
+        size_t seat = list_players.size();
+        name_table[seat] = name;
+        extra_turns[seat] = 0;
         list_players.push_back(player);
+        aliveNamesStale = true; // the seat may keep its bit from a previous player with another name
+        updateAlive(seat, true);
         if (list_players.size() >= 2)
             startGame = true;
+        return seat;
     }
 
     /**
@@ -67,12 +240,13 @@ namespace coup
 
     /**
      * Checks if it's currently the given player's turn.
+     * Compares identities rather than names, so no string is built or compared on this hot path.
      * @param player ---> Reference to the player to check.
      * @return ---> true if it's their turn, false otherwise.
      */
     bool Game::isPlayerTurn(const Player &player) const
     {
-        return list_players.at(index)->GetName() == player.GetName();
+        return list_players.at(index) == &player;
     }
 
     /**
@@ -96,9 +270,10 @@ namespace coup
             resetLastArrestedVictim();
         }
 
-        if (hasExtraTurn(current->GetName()))
+        if (hasExtraTurn(index))
         {
-            useExtraTurn(current->GetName());
+            useExtraTurn(index);
+            publish(EventType::TurnAdvanced, ActionType::None, index, NO_SEAT, list_players[index]->coins());
             return;
         }
 
@@ -107,19 +282,58 @@ namespace coup
         {
             index = (index + 1) % list_players.size();
         } while (!list_players.at(index)->Getstillingame() && index != originalIndex);
+        publish(EventType::TurnAdvanced, ActionType::None, index, NO_SEAT, list_players[index]->coins());
     }
 
     /**
      * Returns a list of names of all players still in the game.
+     * The list is cached and rebuilt from the alive bitmask only after the alive set changed.
      * @return ---> Vector of strings with active player names.
      */
-    vector<string> Game::players() const
+    const vector<string> &Game::players() const
+    {
+        if (aliveNamesStale)
+        {
+            // Assigning into the existing entries reuses their buffers.
+            aliveNames.resize(aliveCount);
+            size_t i = 0;
+            for (size_t seat = 0; seat < MAX_PLAYERS; ++seat)
+                if (aliveMask & (1u << seat))
+                    aliveNames[i++] = name_table[seat];
+            aliveNamesStale = false;
+        }
+        return aliveNames;
+    }
+
+    /**
+     * Updates the alive bitmask and count for one seat.
+     * @param seat ---> The seat whose player entered or left the game.
+     * @param alive ---> true if the player is in the game now.
+     */
+    void Game::updateAlive(size_t seat, bool alive)
+    {
+        uint8_t bit = static_cast<uint8_t>(1u << seat);
+        if (alive == ((aliveMask & bit) != 0))
+            return;
+        aliveMask ^= bit;
+        aliveCount += alive ? 1 : -1;
+        aliveNamesStale = true;
+    }
+
+    /**
+     * @return ---> How many players are still in the game.
+     */
+    size_t Game::alivePlayers() const
+    {
+        return aliveCount;
+    }
+
+    /**
+     * @return ---> true if the game started and exactly one player is left.
+     */
+    bool Game::isOver() const
     {
-        vector<string> names;
-        for (Player *p : list_players)
-            if (p->Getstillingame())
-                names.push_back(p->GetName());
-        return names;
+        return startGame && hasEnoughPlayers() && aliveCount == 1;
     }
 
     /**
@@ -127,7 +341,62 @@ namespace coup
      */
     string Game::turn() const
     {
-        return list_players.at(index)->GetName();
+        return string(turnName());
+    }
+
+    /**
+     * @return ---> A view of the current player's name in the name table.
+     * @throws ---> out_of_range if no players are in the game.
+     */
+    string_view Game::turnName() const
+    {
+        return nameOf(turnSeat());
+    }
+
+    /**
+     * @return ---> The seat whose turn it is.
+     * @throws ---> out_of_range if no players are in the game.
+     */
+    size_t Game::turnSeat() const
+    {
+        if (index >= list_players.size())
+            throw out_of_range("No players in the game.");
+        return index;
+    }
+
+    /**
+     * @param seat ---> A seat number.
+     * @return ---> A view of that seat's interned name, valid as long as the game.
+     * @throws ---> out_of_range if there is no such seat.
+     */
+    string_view Game::nameOf(size_t seat) const
+    {
+        return nameRef(seat);
+    }
+
+    /**
+     * @param seat ---> A seat number.
+     * @return ---> That seat's interned name.
+     * @throws ---> out_of_range if there is no such seat.
+     */
+    const string &Game::nameRef(size_t seat) const
+    {
+        if (seat >= list_players.size())
+            throw out_of_range("No such seat.");
+        return name_table[seat];
+    }
+
+    /**
+     * @param seat ---> A seat number.
+     * @param name ---> The seat's new name.
+     * @throws ---> out_of_range if there is no such seat.
+     */
+    void Game::setName(size_t seat, string_view name)
+    {
+        if (seat >= list_players.size())
+            throw out_of_range("No such seat.");
+        name_table[seat] = name;
+        aliveNamesStale = true;
     }
 
     /**
@@ -139,68 +408,121 @@ namespace coup
     {
         if (!hasEnoughPlayers())
             throw invalid_argument("At least 2 players required.");
-        int aliveCount = 0;
-        Player *potentialWinner = nullptr;
-        for (Player *p : list_players)
-        {
-            if (p->Getstillingame())
-            {
-                aliveCount++;
-                potentialWinner = p;
-            }
-        }
         if (aliveCount == 1 && startGame)
         {
-            return potentialWinner->GetName();
+            return name_table[__builtin_ctz(aliveMask)]; // the only bit left is the winner's seat
         }
         throw invalid_argument("No winner yet!");
     }
 
     /**
-     * Adds extra turns to the given player.
+     * @return ---> The winner's name, or nullopt if the game is not over (never throws).
+     */
+    optional<string_view> Game::tryWinner() const
+    {
+        if (optional<size_t> seat = winnerSeat())
+            return string_view(name_table[*seat]);
+        return nullopt;
+    }
+
+    /**
+     * @return ---> The seat of the only player left, or nullopt if the game is not over.
+     */
+    optional<size_t> Game::winnerSeat() const
+    {
+        if (!isOver())
+            return nullopt;
+        return static_cast<size_t>(__builtin_ctz(aliveMask));
+    }
+
+    /**
+     * Adds extra turns to the given seat.
      * Increments the number of extra turns the specified player can take.
      * Typically used after actions like bribe.
-     * @param playerName ---> The name of the player.
+     * @param seat ---> The seat of the player.
      * @param count ---> Number of extra turns to add.
+     * @throws ---> out_of_range if there is no such seat.
      */
-    void Game::addExtraTurns(const std::string &playerName, int count)
+    void Game::addExtraTurns(size_t seat, int count)
     {
-        extra_turns[playerName] += count;
+        if (seat >= list_players.size())
+            throw out_of_range("No player in seat " + to_string(seat));
+        extra_turns[seat] += count;
     }
 
-    bool Game::hasExtraTurn(const std::string &playerName) const
+    /**
+     * Checks if the seat has any extra turns left.
+     * @param seat ---> The seat of the player.
+     * @return ---> true if the player has at least one extra turn, false otherwise.
+     */
+    bool Game::hasExtraTurn(size_t seat) const
     {
-        auto it = extra_turns.find(playerName);
-        return it != extra_turns.end() && it->second > 0;
+        return seat < MAX_PLAYERS && extra_turns[seat] > 0;
     }
 
     /**
-     * Checks if the player has any extra turns left.
-     *
-     * @param playerName ---> The name of the player.
-     * @return ---> true if the player has at least one extra turn, false otherwise.
+     * Consumes one of the seat's extra turns, if any.
+     * @param seat ---> The seat of the player.
      */
-    void Game::useExtraTurn(const std::string &playerName)
+    void Game::useExtraTurn(size_t seat)
     {
-        if (hasExtraTurn(playerName))
-        {
-            extra_turns.at(playerName)--;
-            if (extra_turns.at(playerName) == 0)
-            {
-                extra_turns.erase(playerName);
-            }
-        }
+        if (hasExtraTurn(seat))
+            extra_turns[seat]--;
     }
 
     /**
-     * Consumes one of the player's extra turns, if any.
-     * If the player has extra turns, one will be removed.
-     * If no extra turns remain, the entry is erased.
-     * @param playerName --->  The name of the player.
+     * Removes all extra turns of the seat.
+     * @param seat ---> The seat of the player.
+     * @throws ---> out_of_range if there is no such seat.
      */
+    void Game::removeExtraTurns(size_t seat)
+    {
+        if (seat >= list_players.size())
+            throw out_of_range("No player in seat " + to_string(seat));
+        extra_turns[seat] = 0;
+    }
+
+    /**
+     * Name-based extra turn functions, kept for compatibility.
+     * The seat is found by comparing against the name table (at most 6 entries, no copies);
+     * an unknown name has no extra turns and cannot receive any.
+     * @throws ---> invalid_argument from addExtraTurns if the name is not in the game.
+     */
+    void Game::addExtraTurns(const std::string &playerName, int count)
+    {
+        size_t seat = seatOf(playerName);
+        if (seat == MAX_PLAYERS)
+            throw invalid_argument(playerName + " is not part of the game");
+        addExtraTurns(seat, count);
+    }
+
+    bool Game::hasExtraTurn(const std::string &playerName) const
+    {
+        return hasExtraTurn(seatOf(playerName));
+    }
+
+    void Game::useExtraTurn(const std::string &playerName)
+    {
+        useExtraTurn(seatOf(playerName));
+    }
+
     void Game::removeExtraTurns(const std::string &playerName)
     {
-        extra_turns.erase(playerName);
+        size_t seat = seatOf(playerName);
+        if (seat != MAX_PLAYERS)
+            removeExtraTurns(seat);
+    }
+
+    /**
+     * @param name ---> A player name.
+     * @return ---> The first seat with that name, or MAX_PLAYERS if none.
+     */
+    size_t Game::seatOf(const string &name) const
+    {
+        for (size_t seat = 0; seat < list_players.size(); ++seat)
+            if (name_table[seat] == name)
+                return seat;
+        return MAX_PLAYERS;
     }
 
     /**
@@ -3,8 +3,16 @@
 #define GAME_HPP
 #include <vector>
 #include <string>
+#include <string_view>
+#include <optional>
 #include <stdexcept>
-#include <map>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+#include <cstdint>
+#include "RoleType.hpp"
+#include "Events.hpp"
+#include "GameImage.hpp"
 using namespace std;
 /**
  * @class game
@@ -20,12 +28,32 @@ namespace coup
 
     class Game
     {
+    public:
+        static constexpr size_t MAX_PLAYERS = 6;        // Maximum number of players in one game.
+        static constexpr size_t PLAYER_SLOT_SIZE = 192; // Bytes reserved in the arena for each player created by emplace().
+
     private:
-        std::map<std::string, int> extra_turns;
+        int extra_turns[MAX_PLAYERS] = {};    // Extra turns (from bribe) still owed to each seat.
+        string name_table[MAX_PLAYERS];       // Interned player names, one per seat; players refer to them by seat.
         vector<Player *> list_players; // List of all players who have joined the game.
         size_t index;                  // Index of the current player's turn in the list.
         bool startGame;                // flag indicating whether the game has started.
         Player *lastArrestedVictim = nullptr;
+        uint64_t seed = 0; // Seed given to the last reset(), for drivers and bots that need randomness.
+
+        uint8_t aliveMask = 0;              // Bit s is set while the player in seat s is still in the game.
+        size_t aliveCount = 0;              // Number of bits set in aliveMask.
+        mutable vector<string> aliveNames;  // What players() returns; rebuilt only after the alive set changed.
+        mutable bool aliveNamesStale = true; // aliveNames must be rebuilt before it is returned.
+
+        alignas(std::max_align_t) unsigned char arena[MAX_PLAYERS * PLAYER_SLOT_SIZE]; // Contiguous storage of the players the game owns.
+        Player *owned[MAX_PLAYERS];                                                      // Players constructed in the arena, in creation order.
+        size_t ownedCount = 0;                                                           // How many arena slots are in use.
+
+        EventBus bus; // Typed events of this game (see Events.hpp).
+
+        void destroyOwned();                    // Runs the destructors of the players in the arena (the memory itself is kept).
+        size_t seatOf(const string &name) const; // First seat with the given name, or MAX_PLAYERS.
 
     public:
         /**
@@ -35,13 +63,98 @@ namespace coup
          */
         Game();
 
+        /**
+         * Destroys the players the game owns (those created with emplace()).
+         * Players created by the caller (Player(game, name)) are not touched.
+         */
+        ~Game();
+
+        Game(const Game &) = delete;            // A game owns its arena players and cannot be copied.
+        Game &operator=(const Game &) = delete; // A game owns its arena players and cannot be copied.
+
+        /**
+         * Creates a player of the given role inside the game's own arena and registers it in turn order.
+         * The game owns the player: it lives exactly as long as the game (or until clear()).
+         * Example: Baron &b = game.emplace<Baron>("Meirav");
+         * @param name ---> The player's name.
+         * @return ---> Reference to the new player.
+         * @throws ---> invalid_argument if there are already 6 players.
+         */
+        template <typename T>
+        T &emplace(const string &name)
+        {
+            static_assert(std::is_base_of<Player, T>::value, "Game::emplace creates players only");
+            static_assert(sizeof(T) <= PLAYER_SLOT_SIZE, "Role does not fit in an arena slot, raise PLAYER_SLOT_SIZE");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "Role is over-aligned for the arena");
+            if (list_players.size() >= MAX_PLAYERS || ownedCount >= MAX_PLAYERS)
+                throw invalid_argument("Maximum 6 players allowed.");
+            T *player = new (arena + ownedCount * PLAYER_SLOT_SIZE) T(*this, name); // the constructor registers it
+            owned[ownedCount++] = player;
+            return *player;
+        }
+
+        /**
+         * Resets the game to its freshly constructed state so it can be reused for another game.
+         * Destroys the arena players, unregisters all players, clears the event bus (subscribers and queued
+         * events) and clears turn, extra turns and arrest state.
+         * No memory is freed: the arena and the player list keep their storage for the next game.
+         */
+        void clear();
+
+        /**
+         * Prepares the game for a new match with the given seating, reusing everything it can.
+         * Seats whose role already matches the layout keep their player object, which is reset in place
+         * (coins, statuses, flags); the remaining seats are rebuilt in the arena. Turn index, start flag,
+         * extra turns and the last arrested victim are reset. Nothing is freed or reallocated.
+         * Rebuilt seats keep the previous player's name, new seats are named "Player <n>".
+         * @param seed ---> Seed of the new match (see getSeed()).
+         * @param roleLayout ---> The role of each seat, in turn order.
+         * @throws ---> invalid_argument if the layout has more than 6 seats, or a seat that must be rebuilt
+         *              belongs to a caller-owned player.
+         */
+        void reset(uint64_t seed, const vector<RoleType> &roleLayout);
+
+        /**
+         * Copies the rule state of the game into an image (see GameImage.hpp).
+         * @param out ---> Receives the image.
+         */
+        void captureImage(GameImage &out) const;
+
+        /**
+         * Puts the game in the state of an image: the seats are laid out as reset() does (roles from the image,
+         * names kept), then every player and the game take the image's values. No events are published.
+         * @param image ---> An image from captureImage().
+         * @throws ---> invalid_argument if the image is malformed (seat count, role, or a seat it refers to).
+         */
+        void restoreImage(const GameImage &image);
+
+        EventBus &events(); // @return ---> The game's event bus, for subscribers (GUI, logging, analytics).
+
+        /**
+         * Publishes an event on the game's bus; free when nobody subscribed.
+         * @param actor ---> Seat of the acting player (NO_SEAT if none).
+         * @param target ---> Seat of the player acted upon (NO_SEAT if none).
+         */
+        void publish(EventType type, ActionType action, size_t actor, size_t target, int coins)
+        {
+            bus.publish(type, action, static_cast<uint8_t>(actor), static_cast<uint8_t>(target), coins);
+        }
+
+        uint64_t getSeed() const; // @return ---> The seed given to the last reset() (0 if never reset).
+
+        Player &getPlayer(size_t seat) const; // @return ---> The player in the given seat (join order). @throws ---> out_of_range.
+        size_t numPlayers() const;            // @return ---> Number of seats, eliminated players included.
+
         /**
          * Adds a new player to the game.
          * Can only be called before the game starts. The player is added to the internal list of players, and their name will appear in turn order.
+         * The name is interned in the game's name table; the player keeps only its seat as a handle to it.
          * @param player ---> Pointer to the Player to add.
+         * @param name ---> The player's name.
+         * @return ---> The seat given to the player (its index in turn order).
          * @throws std::runtime_error If the game has already started  or the maximum number of players has been reached.
          */
-        void addPlayer(Player *player);
+        size_t addPlayer(Player *player, const string &name);
 
         /**
          *  Eliminates a player from the game.
@@ -74,27 +187,64 @@ namespace coup
          * Gets a list of names of players still in the game.
          *
          * Only includes players who are currently active (not eliminated).
+         * The list is kept by the game and rebuilt only when someone was eliminated or returned,
+         * so repeated calls cost nothing.
          *
-         * @return --->  Vector of player names as strings.
+         * @return --->  Vector of player names as strings (valid until the next change of the alive players).
+         */
+
+        const vector<string> &players() const;
+
+        /**
+         * Records that the player in the given seat entered or left the game.
+         * Called by Player whenever its in-game flag changes; keeps the alive set used by players() and winner().
+         * @param seat ---> The player's seat.
+         * @param alive ---> true if the player is now in the game.
          */
+        void updateAlive(size_t seat, bool alive);
+
+        size_t alivePlayers() const; // @return ---> Number of players still in the game.
 
-        vector<string> players() const;
+        /**
+         * @return ---> true once the game started and only one player is left (winner() will not throw).
+         */
+        bool isOver() const;
         /**
          * @return---> The name of the current player.
          * @throws --->  std::runtime_error If no players are in the game.
          */
         string turn() const;
 
+        string_view turnName() const;            // @return ---> View of the current player's interned name (no copy).
+        size_t turnSeat() const;                 // @return ---> Seat of the current player.
+        string_view nameOf(size_t seat) const;   // @return ---> View of the interned name of the given seat.
+        const string &nameRef(size_t seat) const; // @return ---> The interned name of the given seat, by reference.
+        void setName(size_t seat, string_view name); // Renames the player in a seat (loading a save). @throws ---> out_of_range.
+
         /**
          * @return ---> The name of the winner.
          * @throws ---> std::runtime_error If the game is not over yet.
          */
         string winner() const;
 
-        void addExtraTurns(const std::string &playerName, int count); // Adds extra turns to the given player.
-        bool hasExtraTurn(const std::string &playerName) const;       // Checks if the player has any extra turns left.
-        void useExtraTurn(const std::string &playerName);             // Consumes one of the player's extra turns, if any.
-        void removeExtraTurns(const std::string &playerName);         // Removes all extra turns from the given player.
+        /**
+         * Non-throwing version of winner(), cheap enough to call every frame.
+         * @return ---> A view of the winner's name, or nullopt while the game is not over.
+         */
+        optional<string_view> tryWinner() const;
+
+        optional<size_t> winnerSeat() const; // @return ---> The winner's seat, or nullopt while the game is not over.
+
+        void addExtraTurns(size_t seat, int count); // Adds extra turns to the player in the given seat. @throws ---> out_of_range.
+        bool hasExtraTurn(size_t seat) const;       // Checks if the player in the given seat has any extra turns left.
+        void useExtraTurn(size_t seat);             // Consumes one of the seat's extra turns, if any.
+        void removeExtraTurns(size_t seat);         // Removes all extra turns from the given seat. @throws ---> out_of_range.
+
+        // Name-based versions of the extra turn functions, kept for compatibility (they look the seat up by name).
+        void addExtraTurns(const std::string &playerName, int count); // @throws ---> invalid_argument if no player has that name.
+        bool hasExtraTurn(const std::string &playerName) const;
+        void useExtraTurn(const std::string &playerName);
+        void removeExtraTurns(const std::string &playerName);
         void setLastArrestedVictim(Player *player);                   // Sets the last player who was arrested.
         Player *getLastArrestedVictim() const;                        // Retrieves the last player who was arrested.
         void resetLastArrestedVictim();                               // Clears the record of the last arrested player.
@@ -0,0 +1,66 @@
+// ronamsalem4@gmail.com
+#ifndef GAMEIMAGE_HPP
+#define GAMEIMAGE_HPP
+#include "ActionType.hpp"
+#include "Events.hpp"
+#include "RoleType.hpp"
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @file GameImage.hpp
+ * A fixed-size copy of everything the rules keep about a game in progress: every player's coins and status flags
+ * (arrest / sanction / bribe blocks, last action and arrest target, extra turns, the Baron's invest flag) and the
+ * game's turn index, owed turns, start flag and last arrested player. Player pointers are stored as seats.
+ * Names are not part of it. It holds no pointers or strings, so it is copied with memcpy and written to disk as is
+ * (little-endian, no padding); Game::captureImage and Game::restoreImage move a game in and out of it.
+ */
+namespace coup
+{
+    /**
+     * One player, 8 bytes.
+     */
+    struct SeatImage
+    {
+        enum Flag : uint8_t
+        {
+            InGame = 1 << 0,
+            ArrestBlocked = 1 << 1,   // arrestStatus
+            Sanctioned = 1 << 2,      // sanctionStatus
+            SanctionTax = 1 << 3,
+            SanctionGather = 1 << 4,
+            ArrestTurnBlocked = 1 << 5, // blockarrestturn
+            BribeBlocked = 1 << 6,      // bribeStatus
+            RoleFlag = 1 << 7           // role-specific state (the Baron invested this turn)
+        };
+
+        RoleType role = RoleType::Governor;
+        uint8_t flags = 0;
+        ActionType lastAction = ActionType::None; // what GetLastAction() names ("" is None)
+        uint8_t lastArrestedTarget = NO_SEAT;
+        int16_t coins = 0;
+        int8_t extraTurns = 0; // the player's own count
+        int8_t owedTurns = 0;  // the game's extra_turns entry of the seat
+    };
+
+    /**
+     * The whole game, 64 bytes.
+     */
+    struct GameImage
+    {
+        uint64_t seed = 0;
+        uint8_t numSeats = 0;
+        uint8_t turn = 0;                      // the game's turn index
+        uint8_t started = 0;
+        uint8_t lastArrestedVictim = NO_SEAT;
+        uint8_t reserved[4] = {};
+        SeatImage seats[6];
+    };
+
+    static_assert(sizeof(SeatImage) == 8 && sizeof(GameImage) == 64, "GameImage is a disk format: no padding");
+    static_assert(std::is_trivially_copyable_v<GameImage>, "GameImage is copied with memcpy");
+    static_assert(std::endian::native == std::endian::little, "GameImage is stored in host byte order");
+}
+
+#endif
@@ -0,0 +1,79 @@
+// ronamsalem4@gmail.com
+#include "GamePool.hpp"
+
+namespace coup
+{
+    /**
+     * Returns a borrowed game to its pool. The game keeps its players and memory for the next acquire(),
+     * but not its event subscribers, which belong to the borrower.
+     * @param game ---> The game to return.
+     */
+    void GamePool::Release::operator()(Game *game) const
+    {
+        if (game == nullptr)
+            return;
+        game->events().clear();
+        pool->idle.push_back(game);
+    }
+
+    /**
+     * @return ---> The calling thread's pool.
+     */
+    GamePool &GamePool::local()
+    {
+        thread_local GamePool pool;
+        return pool;
+    }
+
+    /**
+     * Lends out an idle game (the most recently returned one, which is likely still in cache),
+     * or creates a new one if none is idle, and resets it for the given match.
+     * @param seed ---> Seed of the new match.
+     * @param roleLayout ---> The role of each seat, in turn order.
+     * @return ---> Handle to a game ready to play.
+     */
+    GamePool::Handle GamePool::acquire(uint64_t seed, const vector<RoleType> &roleLayout)
+    {
+        Game *game;
+        if (idle.empty())
+        {
+            games.push_back(unique_ptr<Game>(new Game()));
+            game = games.back().get();
+        }
+        else
+        {
+            game = idle.back();
+            idle.pop_back();
+        }
+        Handle handle(game, Release{this});
+        game->reset(seed, roleLayout);
+        return handle;
+    }
+
+    /**
+     * Makes sure at least count games are idle, each already seated with the given layout.
+     * @param count ---> Number of idle games wanted.
+     * @param roleLayout ---> Seating of the new games.
+     */
+    void GamePool::prewarm(size_t count, const vector<RoleType> &roleLayout)
+    {
+        games.reserve(games.size() + count);
+        idle.reserve(games.size() + count);
+        while (idle.size() < count)
+        {
+            games.push_back(unique_ptr<Game>(new Game()));
+            games.back()->reset(0, roleLayout);
+            idle.push_back(games.back().get());
+        }
+    }
+
+    size_t GamePool::available() const
+    {
+        return idle.size();
+    }
+
+    size_t GamePool::size() const
+    {
+        return games.size();
+    }
+}
@@ -0,0 +1,66 @@
+// ronamsalem4@gmail.com
+#ifndef GAMEPOOL_HPP
+#define GAMEPOOL_HPP
+#include "Game.hpp"
+#include <memory>
+#include <vector>
+
+/**
+ * @class GamePool
+ * A per-thread pool of ready Game instances for back-to-back simulations.
+ * acquire() hands out a game that was reset in place (Game::reset) instead of a newly built one, and
+ * the handle puts it back into the pool when it goes out of scope. Games are never destroyed while the
+ * pool lives, so after warm-up a simulation loop creates no games and no players at all.
+ * The pool is not thread-safe; use GamePool::local() to get the calling thread's own pool.
+ */
+namespace coup
+{
+    class GamePool
+    {
+    public:
+        /**
+         * Deleter of a pooled game handle: returns the game to its pool instead of deleting it.
+         */
+        struct Release
+        {
+            GamePool *pool;
+            void operator()(Game *game) const;
+        };
+
+        using Handle = unique_ptr<Game, Release>; // A game borrowed from a pool.
+
+        GamePool() = default;
+        GamePool(const GamePool &) = delete;
+        GamePool &operator=(const GamePool &) = delete;
+
+        /**
+         * @return ---> The pool of the calling thread (created on first use, destroyed when the thread exits).
+         * Handles from it must not outlive the thread.
+         */
+        static GamePool &local();
+
+        /**
+         * Takes a game from the pool (or creates one if the pool is empty) and resets it for a new match.
+         * @param seed ---> Seed of the new match.
+         * @param roleLayout ---> The role of each seat, in turn order.
+         * @return ---> A handle that returns the game to the pool when destroyed.
+         */
+        Handle acquire(uint64_t seed, const vector<RoleType> &roleLayout);
+
+        /**
+         * Creates games ahead of time so that the first acquire() calls do not build any.
+         * @param count ---> Number of idle games the pool should hold.
+         * @param roleLayout ---> The seating the games are prepared with.
+         */
+        void prewarm(size_t count, const vector<RoleType> &roleLayout);
+
+        size_t available() const; // @return ---> Number of idle games in the pool.
+        size_t size() const;      // @return ---> Number of games the pool has created in total.
+
+    private:
+        vector<unique_ptr<Game>> games; // Every game created by the pool.
+        vector<Game *> idle;            // Games that are not lent out.
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+// ronamsalem4@gmail.com
+#include "GameSave.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace coup
+{
+    static void put16(vector<uint8_t> &out, uint16_t value)
+    {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    static uint32_t get32(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    size_t saveGame(const Game &game, vector<uint8_t> &out)
+    {
+        size_t start = out.size();
+        GameImage image;
+        game.captureImage(image);
+
+        out.insert(out.end(), SAVE_MAGIC, SAVE_MAGIC + sizeof(SAVE_MAGIC));
+        put16(out, SAVE_FORMAT);
+        put16(out, SAVE_HEADER_SIZE);
+        out.resize(out.size() + 4); // save size, filled in below
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&image);
+        out.insert(out.end(), bytes, bytes + sizeof(GameImage));
+        for (size_t s = 0; s < image.numSeats; ++s)
+        {
+            string_view name = game.nameOf(s);
+            size_t length = name.size() < MAX_SAVE_NAME ? name.size() : MAX_SAVE_NAME;
+            out.push_back(static_cast<uint8_t>(length));
+            out.insert(out.end(), name.begin(), name.begin() + length);
+        }
+
+        uint32_t size = static_cast<uint32_t>(out.size() - start);
+        for (int i = 0; i < 4; ++i)
+            out[start + 12 + i] = static_cast<uint8_t>(size >> (8 * i));
+        return size;
+    }
+
+    SaveView::SaveView(const uint8_t *data, size_t size)
+    {
+        if (size < SAVE_HEADER_SIZE || memcmp(data, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0)
+            throw invalid_argument("Not a game save");
+        formatVersion = static_cast<uint16_t>(data[8] | (data[9] << 8));
+        size_t header = data[10] | (data[11] << 8);
+        saveSize = get32(data + 12);
+        if (formatVersion == 0 || formatVersion > SAVE_FORMAT)
+            throw invalid_argument("Game save format " + to_string(formatVersion) + " is not supported");
+        if (header < SAVE_HEADER_SIZE || saveSize > size || saveSize < header + sizeof(GameImage))
+            throw invalid_argument("Game save is cut short");
+
+        memcpy(&gameImage, data + header, sizeof(GameImage));
+        if (gameImage.numSeats > Game::MAX_PLAYERS)
+            throw invalid_argument("Malformed game save");
+        size_t pos = header + sizeof(GameImage);
+        for (size_t s = 0; s < gameImage.numSeats; ++s)
+        {
+            if (pos >= saveSize || pos + 1 + data[pos] > saveSize)
+                throw invalid_argument("Game save is cut short");
+            names[s] = string_view(reinterpret_cast<const char *>(data + pos + 1), data[pos]);
+            pos += 1 + data[pos];
+        }
+    }
+
+    string_view SaveView::name(size_t seat) const
+    {
+        if (seat >= gameImage.numSeats)
+            throw out_of_range("No such seat.");
+        return names[seat];
+    }
+
+    /**
+     * restoreImage() lays the seats out and loads the rule state; the names are then set seat by seat.
+     */
+    void loadGame(Game &game, const SaveView &save)
+    {
+        game.restoreImage(save.image());
+        for (size_t s = 0; s < save.numSeats(); ++s)
+            game.setName(s, save.name(s));
+    }
+}
@@ -0,0 +1,66 @@
+// ronamsalem4@gmail.com
+#ifndef GAMESAVE_HPP
+#define GAMESAVE_HPP
+#include "Game.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file GameSave.hpp
+ * Versioned binary saves of a game in progress, to pause a match or move a table to another process.
+ * Layout (little-endian):
+ *   header  "COUPSAVE", u16 format, u16 header size, u32 save size   (16 bytes; a later format may grow it)
+ *   image   the game's GameImage (64 bytes: roles, coins, flags, extra turns, turn, start flag, last arrested)
+ *   names   per seat: u8 length, then the bytes
+ * SaveView reads a save where it lies: it checks the bounds once, then hands out the image and views of the names
+ * without copying or allocating, so a table can be loaded straight from a received buffer or a mapped file.
+ */
+namespace coup
+{
+    static constexpr char SAVE_MAGIC[8] = {'C', 'O', 'U', 'P', 'S', 'A', 'V', 'E'};
+    static constexpr uint16_t SAVE_FORMAT = 1;        // Current format; older ones are still read.
+    static constexpr size_t SAVE_HEADER_SIZE = 16;
+    static constexpr size_t MAX_SAVE_NAME = 255;      // Longer names are cut when saved.
+
+    /**
+     * Appends a save of the game to a buffer.
+     * @param game ---> The game (started or not; eliminated players included).
+     * @param out ---> Receives the save at its end.
+     * @return ---> Size of the save in bytes.
+     */
+    size_t saveGame(const Game &game, vector<uint8_t> &out);
+
+    class SaveView
+    {
+    public:
+        /**
+         * Checks a save in place; the buffer must outlive the view.
+         * @param data ---> Start of the save (no alignment needed).
+         * @param size ---> Bytes available; more than the save is fine (see size()).
+         * @throws ---> invalid_argument if it is not a save, a newer format, or cut short.
+         */
+        SaveView(const uint8_t *data, size_t size);
+
+        uint16_t format() const { return formatVersion; }      // @return ---> Format the save was written in.
+        size_t size() const { return saveSize; }               // @return ---> Bytes of the save (the next one starts there).
+        const GameImage &image() const { return gameImage; }   // @return ---> The rule state of the game.
+        size_t numSeats() const { return gameImage.numSeats; } // @return ---> Seats, eliminated players included.
+        string_view name(size_t seat) const;                   // @return ---> View of a seat's name. @throws ---> out_of_range.
+
+    private:
+        uint16_t formatVersion = 0;
+        size_t saveSize = 0;
+        GameImage gameImage;                          // copied out (64 bytes): the buffer may not be aligned for it
+        string_view names[Game::MAX_PLAYERS];
+    };
+
+    /**
+     * Puts a game in the state of a save: seats laid out as in the save (reusing the game's players where the
+     * role matches, see Game::reset), names, and every rule state of the image. No events are published.
+     * @throws ---> invalid_argument if the image is malformed; the game is then left reset but not loaded.
+     */
+    void loadGame(Game &game, const SaveView &save);
+}
+
+#endif
@@ -0,0 +1,161 @@
+// ronamsalem4@gmail.com
+#include "Logger.hpp"
+#include <iostream>
+
+namespace coup
+{
+    /**
+     * @return ---> The logger shared by the whole process.
+     */
+    Logger &Logger::instance()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    /**
+     * Creates a synchronous logger at level Info that writes to stdout.
+     */
+    Logger::Logger()
+    {
+        setSink(nullptr);
+    }
+
+    /**
+     * Stops the background writer, writing what is still queued.
+     */
+    Logger::~Logger()
+    {
+        stop();
+    }
+
+    /**
+     * @param level ---> The lowest level that is still written (Off silences everything).
+     */
+    void Logger::setLevel(LogLevel level)
+    {
+        minLevel.store(level, memory_order_relaxed);
+    }
+
+    /**
+     * @param newSink ---> The function receiving every message, or nullptr for stdout.
+     */
+    void Logger::setSink(Sink newSink)
+    {
+        if (!newSink)
+            newSink = [](LogLevel, string_view text)
+            {
+                cout.write(text.data(), static_cast<streamsize>(text.size()));
+                cout.put('\n');
+            };
+        lock_guard<mutex> lock(sinkMutex);
+        sink = std::move(newSink);
+    }
+
+    /**
+     * Starts the background writer thread (does nothing if it is already running).
+     */
+    void Logger::start()
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (running.load())
+            return;
+        if (!queue)
+            queue.reset(new Line[QUEUE_SIZE]);
+        stopping = false;
+        running.store(true);
+        writer = thread(&Logger::writerLoop, this);
+    }
+
+    /**
+     * Stops the background writer after it wrote every queued line.
+     */
+    void Logger::stop()
+    {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            if (!running.load())
+                return;
+            stopping = true;
+        }
+        notEmpty.notify_one();
+        writer.join();
+        running.store(false);
+    }
+
+    /**
+     * Blocks until the queue is empty and the last taken line was written.
+     */
+    void Logger::flush()
+    {
+        unique_lock<mutex> lock(queueMutex);
+        drained.wait(lock, [this]
+                     { return !running.load() || (count == 0 && !writing); });
+    }
+
+    /**
+     * Writes the line right away when there is no writer thread; otherwise queues it,
+     * waiting for a free slot if the queue is full.
+     */
+    void Logger::submit(const Line &line)
+    {
+        if (running.load(memory_order_acquire))
+        {
+            unique_lock<mutex> lock(queueMutex);
+            if (running.load() && !stopping)
+            {
+                notFull.wait(lock, [this]
+                             { return count < QUEUE_SIZE; });
+                queue[(head + count) % QUEUE_SIZE] = line;
+                ++count;
+                lock.unlock();
+                notEmpty.notify_one();
+                return;
+            }
+        }
+        write(line);
+    }
+
+    /**
+     * Passes one line to the sink.
+     */
+    void Logger::write(const Line &line)
+    {
+        lock_guard<mutex> lock(sinkMutex);
+        sink(line.level, string_view(line.text, line.length));
+    }
+
+    /**
+     * Body of the writer thread: takes lines one by one, writes them outside the queue lock,
+     * and flushes stdout whenever the queue runs empty.
+     */
+    void Logger::writerLoop()
+    {
+        unique_lock<mutex> lock(queueMutex);
+        while (true)
+        {
+            notEmpty.wait(lock, [this]
+                          { return count > 0 || stopping; });
+            if (count == 0)
+                break; // stopping, and everything was written
+            Line line = queue[head];
+            head = (head + 1) % QUEUE_SIZE;
+            --count;
+            writing = true;
+            lock.unlock();
+            notFull.notify_one();
+            write(line);
+            lock.lock();
+            writing = false;
+            if (count == 0)
+            {
+                lock.unlock();
+                cout.flush();
+                lock.lock();
+                drained.notify_all();
+            }
+        }
+        writing = false;
+        drained.notify_all();
+    }
+}
@@ -0,0 +1,133 @@
+// ronamsalem4@gmail.com
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+using namespace std;
+
+/**
+ * @class Logger
+ * @namespace coup
+ * Level-filtered logger for the messages of the rules code ("X made a coup on Y", ...).
+ * A message below the current level costs one atomic load and nothing else; at level Off the engine is silent.
+ * By default messages are written synchronously to stdout, in the order they happen. After start(), messages
+ * are copied into a bounded queue of fixed-size lines and written (and flushed) by a background thread,
+ * so the thread playing the game never waits on the console.
+ * The output goes to a pluggable sink, stdout unless setSink() says otherwise.
+ */
+namespace coup
+{
+    enum class LogLevel : uint8_t
+    {
+        Debug,
+        Info,
+        Warn,
+        Error,
+        Off
+    };
+
+    class Logger
+    {
+    public:
+        static constexpr size_t QUEUE_SIZE = 256; // Lines the queue can hold before log() waits for the writer.
+        static constexpr size_t LINE_SIZE = 192;  // Maximum length of one message; longer messages are cut.
+
+        using Sink = function<void(LogLevel, string_view)>; // Receives one message (without newline).
+
+        static Logger &instance(); // @return ---> The process-wide logger.
+
+        Logger();
+        ~Logger(); // Stops the writer thread after it wrote everything queued.
+        Logger(const Logger &) = delete;
+        Logger &operator=(const Logger &) = delete;
+
+        void setLevel(LogLevel level);                                                  // Messages below this level are discarded.
+        LogLevel getLevel() const { return minLevel.load(memory_order_relaxed); }       // @return ---> The current level.
+        bool enabled(LogLevel level) const { return level != LogLevel::Off && level >= getLevel(); } // @return ---> true if a message of this level is written.
+
+        /**
+         * Replaces the sink. nullptr restores the default (stdout).
+         * Safe to call while the writer thread is running.
+         */
+        void setSink(Sink sink);
+
+        void start();  // Starts the background writer: from now on log() only queues the message.
+        void stop();   // Writes what is queued, then stops the writer; log() is synchronous again.
+        void flush();  // Waits until every queued message was written.
+        bool isRunning() const { return running.load(); } // @return ---> true if the background writer is running.
+
+        /**
+         * Logs one message made of the given parts (strings, string views, characters and integers),
+         * concatenated without separators. Nothing is formatted if the level is filtered out.
+         * Example: Logger::instance().log(LogLevel::Info, name, " has ", coins, " coins");
+         */
+        template <typename... Parts>
+        void log(LogLevel level, const Parts &...parts)
+        {
+            if (!enabled(level))
+                return;
+            Line line;
+            line.level = level;
+            (line.append(parts), ...);
+            submit(line);
+        }
+
+    private:
+        struct Line
+        {
+            LogLevel level = LogLevel::Info;
+            uint16_t length = 0;
+            char text[LINE_SIZE];
+
+            void append(string_view part)
+            {
+                size_t n = part.size() < LINE_SIZE - length ? part.size() : LINE_SIZE - length;
+                memcpy(text + length, part.data(), n);
+                length = static_cast<uint16_t>(length + n);
+            }
+            void append(const char *part) { append(string_view(part)); }
+            void append(const string &part) { append(string_view(part)); }
+            void append(char c) { append(string_view(&c, 1)); }
+            template <typename T, typename = enable_if_t<is_integral<T>::value>>
+            void append(T value)
+            {
+                char digits[24];
+                to_chars_result r = to_chars(digits, digits + sizeof(digits), value);
+                append(string_view(digits, static_cast<size_t>(r.ptr - digits)));
+            }
+        };
+
+        void submit(const Line &line); // Writes the line now, or queues it for the writer thread.
+        void write(const Line &line);  // Hands the line to the sink.
+        void writerLoop();
+
+        atomic<LogLevel> minLevel{LogLevel::Info};
+        atomic<bool> running{false};
+
+        mutex sinkMutex; // Serializes calls to the sink and setSink().
+        Sink sink;
+
+        mutex queueMutex;
+        condition_variable notEmpty; // Signaled when a line is queued or the writer must stop.
+        condition_variable notFull;  // Signaled when the writer takes a line.
+        condition_variable drained;  // Signaled when the writer is idle with an empty queue.
+        unique_ptr<Line[]> queue;    // QUEUE_SIZE lines, allocated by the first start().
+        size_t head = 0;             // Oldest queued line.
+        size_t count = 0;            // Number of queued lines.
+        bool writing = false;        // The writer holds a line that is not written yet.
+        bool stopping = false;
+        thread writer;
+    };
+}
+
+#endif
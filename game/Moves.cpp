@@ -0,0 +1,144 @@
+// ronamsalem4@gmail.com
+#include "Moves.hpp"
+#include "Player.hpp"
+#include "../roles/Baron.hpp"
+#include "../roles/General.hpp"
+#include "../roles/Governor.hpp"
+#include "../roles/Judge.hpp"
+#include <stdexcept>
+
+namespace coup
+{
+    bool MoveList::contains(const Move &move) const
+    {
+        for (const Move &m : *this)
+            if (m == move)
+                return true;
+        return false;
+    }
+
+    /**
+     * @return ---> Coins the target must have for an arrest on it to succeed (a Merchant pays 2).
+     */
+    static int arrestCost(const Player &target)
+    {
+        return target.GetRoleType() == RoleType::Merchant ? 2 : 1;
+    }
+
+    /**
+     * Builds the legal moves from the player's coins and statuses, mirroring the checks of the Player functions.
+     */
+    MoveList legalMoves(const Game &game)
+    {
+        MoveList list;
+        size_t seat = game.turnSeat();
+        Player &player = game.getPlayer(seat);
+        int coins = player.coins();
+
+        for (size_t t = 0; t < game.numPlayers(); ++t)
+        {
+            Player &target = game.getPlayer(t);
+            if (t == seat || !target.Getstillingame())
+                continue;
+            uint8_t ts = static_cast<uint8_t>(t);
+            if (coins >= 7)
+                list.push(Move{ActionType::Coup, ts, 0});
+            if (coins >= 10)
+                continue; // a coup is mandatory
+            if (!player.blockarrestturnStatus() && game.getLastArrestedVictim() != &target && target.coins() >= arrestCost(target))
+                list.push(Move{ActionType::Arrest, ts, 0});
+            int sanctionCost = target.GetRoleType() == RoleType::Judge ? 4 : 3;
+            if (coins >= sanctionCost)
+            {
+                list.push(Move{ActionType::Sanction, ts, 0});
+                list.push(Move{ActionType::Sanction, ts, 1});
+            }
+        }
+
+        // A Merchant's bonus coin is added before the mandatory-coup check of gather / tax / bribe.
+        int checked = (player.GetRoleType() == RoleType::Merchant && coins >= 3) ? coins + 1 : coins;
+        if (checked < 10)
+        {
+            if (!player.isSanctionedFrom(ActionType::Gather))
+                list.push(Move{ActionType::Gather, NO_SEAT, 0});
+            if (!player.isSanctionedFrom(ActionType::Tax))
+                list.push(Move{ActionType::Tax, NO_SEAT, 0});
+            if (checked >= 4)
+                list.push(Move{ActionType::Bribe, NO_SEAT, 0});
+            if (player.GetRoleType() == RoleType::Baron && coins >= 3)
+                list.push(Move{ActionType::Invest, NO_SEAT, 0});
+        }
+
+        if (list.empty())
+            list.push(Move{ActionType::None, NO_SEAT, 0});
+        return list;
+    }
+
+    void applyMove(Game &game, const Move &move)
+    {
+        Player &player = game.getPlayer(game.turnSeat());
+        switch (move.action)
+        {
+        case ActionType::None:
+            game.advanceTurn();
+            return;
+        case ActionType::Gather:
+            player.gather();
+            return;
+        case ActionType::Tax:
+            player.tax();
+            return;
+        case ActionType::Bribe:
+            player.bribe();
+            return;
+        case ActionType::Invest:
+            if (player.GetRoleType() != RoleType::Baron)
+                throw invalid_argument("Only a Baron can invest.");
+            static_cast<Baron &>(player).invest();
+            return;
+        case ActionType::Arrest:
+            player.arrest(game.getPlayer(move.target));
+            return;
+        case ActionType::Sanction:
+            player.sanction(game.getPlayer(move.target), move.option == 0 ? "gather" : "tax");
+            return;
+        case ActionType::Coup:
+            player.coup(game.getPlayer(move.target));
+            return;
+        default:
+            throw invalid_argument(string("Not a turn move: ") + actionName(move.action));
+        }
+    }
+
+    bool canBlock(const Game &game, size_t blocker, const Move &move)
+    {
+        Player &player = game.getPlayer(blocker);
+        if (blocker == game.turnSeat() || !player.Getstillingame())
+            return false;
+        switch (move.action)
+        {
+        case ActionType::Coup:
+            return player.GetRoleType() == RoleType::General && player.coins() >= 5 && blocker != move.target;
+        case ActionType::Tax:
+            return player.GetRoleType() == RoleType::Governor;
+        case ActionType::Bribe:
+            return player.GetRoleType() == RoleType::Judge;
+        default:
+            return false;
+        }
+    }
+
+    void applyBlock(Game &game, size_t blocker, size_t actor, const Move &move)
+    {
+        Player &player = game.getPlayer(blocker);
+        RoleType role = player.GetRoleType();
+        if (move.action == ActionType::Coup && role == RoleType::General)
+            static_cast<General &>(player).BlockCoup(game.getPlayer(move.target));
+        else if (move.action == ActionType::Tax && role == RoleType::Governor)
+            static_cast<Governor &>(player).undo(game.getPlayer(actor));
+        else if (move.action == ActionType::Bribe && role == RoleType::Judge)
+            static_cast<Judge &>(player).blockBribe(game.getPlayer(actor));
+        else
+            throw invalid_argument(player.GetName() + " cannot block " + actionName(move.action));
+    }
+}
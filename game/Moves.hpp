@@ -0,0 +1,90 @@
+// ronamsalem4@gmail.com
+#ifndef MOVES_HPP
+#define MOVES_HPP
+#include "Game.hpp"
+#include "ActionType.hpp"
+#include "Events.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file Moves.hpp
+ * The moves of the current player as plain values, for bots, simulators and GUIs.
+ * legalMoves() lists what the player whose turn it is may do right now; applyMove() performs one of them
+ * through the regular Player / role functions, so the rules stay in one place.
+ */
+namespace coup
+{
+    /**
+     * One move of the current player.
+     */
+    struct Move
+    {
+        ActionType action = ActionType::None; // None is a pass, offered only when no other move is legal.
+        uint8_t target = NO_SEAT;             // Seat of the target (arrest, sanction, coup).
+        uint8_t option = 0;                   // Sanction: 0 blocks gather, 1 blocks tax.
+
+        bool operator==(const Move &other) const { return action == other.action && target == other.target && option == other.option; }
+        bool operator!=(const Move &other) const { return !(*this == other); }
+    };
+
+    /**
+     * A fixed-capacity list of moves (no allocation).
+     */
+    struct MoveList
+    {
+        static constexpr size_t CAPACITY = 32; // More than the most moves a player can ever have (4 + 4 per opponent).
+        Move moves[CAPACITY];
+        size_t count = 0;
+
+        void push(const Move &move) { moves[count++] = move; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const Move &operator[](size_t i) const { return moves[i]; }
+        const Move *begin() const { return moves; }
+        const Move *end() const { return moves + count; }
+        bool contains(const Move &move) const; // @return ---> true if the move is in the list.
+    };
+
+    /**
+     * Lists the legal moves of the current player: gather, tax, bribe, Baron invest, and arrest / sanction / coup
+     * on every opponent still in the game, each only when the player can pay for it and no status blocks it.
+     * With 10 or more coins only coups are listed. If nothing is legal, the list holds a single pass.
+     * @param game ---> A started game that is not over.
+     * @return ---> The legal moves.
+     */
+    MoveList legalMoves(const Game &game);
+
+    /**
+     * Performs a move for the current player.
+     * A pass just advances the turn.
+     * @param game ---> The game.
+     * @param move ---> A move of the current player (normally one returned by legalMoves).
+     * @throws ---> invalid_argument if the rules reject the move.
+     */
+    void applyMove(Game &game, const Move &move);
+
+    /**
+     * Tells whether a player may answer a move of the current player with a block:
+     * a General with 5 coins blocks a coup (on someone else), a Governor undoes a tax, a Judge blocks a bribe.
+     * Ask it before the move is played, while the actor still holds the turn.
+     * @param game ---> The game.
+     * @param blocker ---> Seat of the player who would block.
+     * @param move ---> The move of the current player.
+     * @return ---> true if the blocker is in the game, is not the actor, and has the role (and coins) to block it.
+     */
+    bool canBlock(const Game &game, size_t blocker, const Move &move);
+
+    /**
+     * Blocks a move that was just played, through the blocker's role function
+     * (General::BlockCoup, Governor::undo or Judge::blockBribe).
+     * @param game ---> The game.
+     * @param blocker ---> Seat of the blocking player (see canBlock).
+     * @param actor ---> Seat of the player who played the move.
+     * @param move ---> The move that was played.
+     * @throws ---> invalid_argument if the move cannot be blocked by that player.
+     */
+    void applyBlock(Game &game, size_t blocker, size_t actor, const Move &move);
+}
+
+#endif
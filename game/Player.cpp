@@ -1,6 +1,7 @@
 // ronamsalem4@gmail.com
 #include "Player.hpp"
 #include "Game.hpp"
+#include "Logger.hpp"
 #include <stdexcept>
 
 /**
@@ -22,7 +23,7 @@ namespace coup
      * Automatically adds the player to the game upon creation.
      */
     Player::Player(Game &game, const std::string &name) : game(game), amount(0),
-                                                          name(name),
+                                                          seat(0),
                                                           arrestStatus(false),
                                                           sanctionStatus(false),
                                                           stillingame(true),
@@ -30,7 +31,7 @@ namespace coup
                                                           bribeStatus(false),
                                                           lastAction("")
     {
-        game.addPlayer(this);
+        seat = game.addPlayer(this, name);
     }
 
     /**
@@ -46,18 +47,28 @@ namespace coup
     /**
      * Copy constructor for Player.
      *
-     * Creates a new Player object by copying the name and amount from another player.
-     * The game reference is shallow-copied (both players point to the same Game).
+     * Creates a new Player object by copying the name, amount and status flags from another player.
+     * The game reference is shallow-copied (both players point to the same Game), but the copy does not join it:
+     * it has no seat (NO_SEAT) and keeps its own copy of the name, so nothing it does changes the original's seat.
      *
      * @param other ---> The Player to copy from.
      */
     Player::Player(const Player &other)
-        : game(other.game) ,amount(other.amount) , name(other.name){}
+        : game(other.game), amount(other.amount), seat(NO_SEAT),
+          arrestStatus(other.arrestStatus),
+          sanctionStatus(other.sanctionStatus),
+          sanctionTax(other.sanctionTax),
+          sanctionGather(other.sanctionGather),
+          stillingame(other.stillingame),
+          blockarrestturn(other.blockarrestturn),
+          bribeStatus(other.bribeStatus),
+          copiedName(other.GetName()) {}
 
     /**
  * Copy assignment operator for Player.
  * Assigns the name and amount fields from another Player instance.
- * The game reference remains unchanged (same Game object).
+ * The game reference and the seat remain unchanged; the name is written into this player's seat of the name
+ * table, and only between players of the same game.
  * @param other ---> The Player to assign from.
  * @return ---> Reference to this Player.
  */
@@ -65,7 +76,13 @@ namespace coup
     {
         if (this != &other)
         {
-            name = other.name;
+            if (&game == &other.game)
+            {
+                if (seat == NO_SEAT)
+                    copiedName = other.GetName();
+                else
+                    game.setName(seat, other.GetNameView());
+            }
             amount = other.amount;
         }
         return *this;
@@ -80,11 +97,27 @@ namespace coup
     }
 
     /**
-     * @return --->  The player's name.
+     * @return --->  The player's name, as interned in the game's name table (a copy's own name).
      */
-    std::string Player::GetName() const
+    const std::string &Player::GetName() const
     {
-        return name;
+        return seat == NO_SEAT ? copiedName : game.nameRef(seat);
+    }
+
+    /**
+     * @return ---> A view of the player's interned name (valid as long as the game).
+     */
+    std::string_view Player::GetNameView() const
+    {
+        return GetName();
+    }
+
+    /**
+     * @return ---> The player's seat in the game (NO_SEAT for a copy).
+     */
+    size_t Player::GetSeat() const
+    {
+        return seat;
     }
 
     /**
@@ -129,6 +162,20 @@ namespace coup
         return sanctionStatus;
     }
 
+    /**
+     * Checks whether a sanction blocks the given economic action.
+     * @param action ---> Gather or Tax (any other action is never sanctioned).
+     * @return ---> True if the action is blocked until the end of the player's next turn.
+     */
+    bool Player::isSanctionedFrom(ActionType action) const
+    {
+        if (action == ActionType::Gather)
+            return sanctionGather;
+        if (action == ActionType::Tax)
+            return sanctionTax;
+        return false;
+    }
+
     /**
      * Activates the bribe status for the player.
      * This function marks the player as having performed a bribe action.
@@ -216,10 +263,21 @@ namespace coup
 
     /**
      * Eliminates the player from the game.
+     * Publishes an Eliminated event whose actor is the player whose turn it is,
+     * followed by GameOver if only one player is left.
      */
     void Player::eliminated()
     {
-        stillingame = false;
+        if (stillingame)
+        {
+            stillingame = false;
+            if (seat == NO_SEAT)
+                return; // a copy is not in the game
+            game.updateAlive(seat, false);
+            game.publish(EventType::Eliminated, ActionType::None, game.turnSeat(), seat, amount);
+            if (optional<size_t> winner = game.winnerSeat())
+                game.publish(EventType::GameOver, ActionType::None, *winner, NO_SEAT, game.getPlayer(*winner).coins());
+        }
     }
 
     /**
@@ -228,6 +286,76 @@ namespace coup
     void Player::returnToGame()
     {
         stillingame = true;
+        if (seat != NO_SEAT)
+            game.updateAlive(seat, true);
+    }
+
+    /**
+     * Restores the state of a newly created player without touching its name or game.
+     * The last action string is cleared in place, so its buffer is reused.
+     */
+    void Player::resetForNewGame()
+    {
+        amount = 0;
+        arrestStatus = false;
+        sanctionStatus = false;
+        sanctionTax = false;
+        sanctionGather = false;
+        stillingame = true;
+        game.updateAlive(seat, true);
+        lastArrestedTarget = nullptr;
+        blockarrestturn = false;
+        bribeStatus = false;
+        lastAction.clear();
+        extraTurns = 0;
+        resetRoleState();
+    }
+
+    /**
+     * Copies the player's coins, flags, last action, arrest target, extra turns and role state into an image.
+     */
+    void Player::saveImage(SeatImage &out) const
+    {
+        out.role = GetRoleType();
+        out.flags = (stillingame ? SeatImage::InGame : 0) | (arrestStatus ? SeatImage::ArrestBlocked : 0) |
+                    (sanctionStatus ? SeatImage::Sanctioned : 0) | (sanctionTax ? SeatImage::SanctionTax : 0) |
+                    (sanctionGather ? SeatImage::SanctionGather : 0) | (blockarrestturn ? SeatImage::ArrestTurnBlocked : 0) |
+                    (bribeStatus ? SeatImage::BribeBlocked : 0) | (roleFlag() ? SeatImage::RoleFlag : 0);
+        out.lastAction = ActionType::None;
+        for (uint8_t a = 1; a <= static_cast<uint8_t>(ActionType::Coup); ++a)
+            if (lastAction == actionName(static_cast<ActionType>(a)))
+                out.lastAction = static_cast<ActionType>(a);
+        out.lastArrestedTarget = lastArrestedTarget ? static_cast<uint8_t>(lastArrestedTarget->GetSeat()) : NO_SEAT;
+        out.coins = static_cast<int16_t>(amount);
+        out.extraTurns = static_cast<int8_t>(extraTurns);
+    }
+
+    /**
+     * Takes the rule state of an image (the role must already match, see Game::restoreImage).
+     * @throws ---> invalid_argument if the last action or the arrest target is not valid.
+     */
+    void Player::loadImage(const SeatImage &in)
+    {
+        if (in.lastAction > ActionType::Coup)
+            throw invalid_argument("Bad last action in game image");
+        if (in.lastArrestedTarget != NO_SEAT && in.lastArrestedTarget >= game.numPlayers())
+            throw invalid_argument("Bad arrest target in game image");
+        amount = in.coins;
+        stillingame = in.flags & SeatImage::InGame;
+        game.updateAlive(seat, stillingame);
+        arrestStatus = in.flags & SeatImage::ArrestBlocked;
+        sanctionStatus = in.flags & SeatImage::Sanctioned;
+        sanctionTax = in.flags & SeatImage::SanctionTax;
+        sanctionGather = in.flags & SeatImage::SanctionGather;
+        blockarrestturn = in.flags & SeatImage::ArrestTurnBlocked;
+        bribeStatus = in.flags & SeatImage::BribeBlocked;
+        setRoleFlag(in.flags & SeatImage::RoleFlag);
+        if (in.lastAction == ActionType::None)
+            lastAction.clear();
+        else
+            lastAction = actionName(in.lastAction);
+        lastArrestedTarget = in.lastArrestedTarget == NO_SEAT ? nullptr : &game.getPlayer(in.lastArrestedTarget);
+        extraTurns = in.extraTurns;
     }
 
     /**
@@ -273,6 +401,7 @@ namespace coup
         checkCoupMandatory();
         AddCoins(1);
         lastAction = "gather";
+        emit(EventType::ActionPerformed, ActionType::Gather);
         game.advanceTurn();
     }
 
@@ -294,6 +423,7 @@ namespace coup
         checkCoupMandatory();
         AddCoins(2);
         lastAction = "tax";
+        emit(EventType::ActionPerformed, ActionType::Tax);
         game.advanceTurn();
     }
     /**
@@ -308,8 +438,9 @@ namespace coup
         checkCoupMandatory();
         DecreaseCoins(4);
         ActivateBribeStatus();
-        game.addExtraTurns(this->GetName(), 1);
+        game.addExtraTurns(seat, 1);
         lastAction = "bribe";
+        emit(EventType::ActionPerformed, ActionType::Bribe);
     }
 
     /**
@@ -335,7 +466,7 @@ namespace coup
         if (target.GetRole() == "Merchant")
         {
             target.DecreaseCoins(2);
-            std::cout << target.GetName() << " is a Merchant and pays 2 coins (no reward).\n";
+            Logger::instance().log(LogLevel::Info, target.GetNameView(), " is a Merchant and pays 2 coins (no reward).");
         }
         else if (target.GetRole() == "General")
         {
@@ -352,6 +483,7 @@ namespace coup
         lastArrestedTarget = &target;
         game.setLastArrestedVictim(&target);
         lastAction = "arrest";
+        emit(EventType::ActionPerformed, ActionType::Arrest, &target);
 
         game.advanceTurn();
     }
@@ -374,11 +506,12 @@ namespace coup
         target.onSanction();
         if (target.GetRole() == "Judge")
         {
-            std::cout << GetName() << " sanctioned a Judge and loses 1 extra coin!\n";
+            Logger::instance().log(LogLevel::Info, GetNameView(), " sanctioned a Judge and loses 1 extra coin!");
             DecreaseCoins(1);
         }
 
         lastAction = "sanction";
+        emit(EventType::ActionPerformed, ActionType::Sanction, &target);
         game.advanceTurn();
     }
     /**
@@ -396,6 +529,7 @@ namespace coup
             throw std::invalid_argument("You can't coup the player");
 
         DecreaseCoins(7);
+        emit(EventType::ActionPerformed, ActionType::Coup, &target);
         target.eliminated();
         lastAction = "coup";
 
@@ -403,10 +537,21 @@ namespace coup
 
         if (!target.Getstillingame())
         {
-            std::cout << name << " made a coup on " << target.GetName() << std::endl;
+            Logger::instance().log(LogLevel::Info, GetNameView(), " made a coup on ", target.GetNameView());
         }
     }
 
+    /**
+     * Publishes an event with this player as the actor.
+     * @param type ---> The kind of event.
+     * @param action ---> The action performed or blocked.
+     * @param target ---> The player acted upon, or nullptr.
+     */
+    void Player::emit(EventType type, ActionType action, const Player *target) const
+    {
+        game.publish(type, action, seat, target ? target->seat : NO_SEAT, amount);
+    }
+
     /**
      * @Sets the name of the last action the player performed.
      * Used for block/challenge logic.
@@ -421,7 +566,7 @@ namespace coup
      *  Retrieves the last action performed by the player.
      * @return --->  A string indicating the action.
      */
-    std::string Player::GetLastAction() const
+    const std::string &Player::GetLastAction() const
     {
         return lastAction;
     }
@@ -4,7 +4,11 @@
 #define PLAYER_HPP
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <stdexcept>
+#include "RoleType.hpp"
+#include "Events.hpp"
+#include "GameImage.hpp"
 using namespace std;
 
 /**
@@ -24,7 +28,7 @@ namespace coup
     private:
         Game &game;                           // A reference to the game in which the player is participating.
         int amount;                           // How many coins does the player have
-        string name;                          // Player name.
+        size_t seat;                          // Seat in the game; also the handle of the player's interned name.
         bool arrestStatus;                    // Can he not make an arrest (blocked).
         bool sanctionStatus;                  // Blocked from tax/gather
         bool sanctionTax = false;             ///< Whether the player is currently sanctioned from performing the 'tax' action.
@@ -35,6 +39,14 @@ namespace coup
         bool bribeStatus;                     // Checks whether a player is blocked from committing a bribe.
         string lastAction;                    // The last action performed by a player.
         int extraTurns = 0;
+        string copiedName;                    // The name of a copy, which has no seat (see the copy constructor).
+
+    protected:
+        /**
+         * Publishes an event of this player (as actor) on the game's bus, with the player's current coins.
+         * @param target ---> The player acted upon, or nullptr.
+         */
+        void emit(EventType type, ActionType action, const Player *target = nullptr) const;
 
     public:
         Player(Game &game, const string &name); // A constructor creates a new player – must receive a reference to the game and a name.
@@ -43,7 +55,9 @@ namespace coup
         Player &operator=(const Player &other); //  Copy assignment
 
         //
-        string GetName() const; // @return --->  The player's name as a string.
+        const string &GetName() const;  // @return --->  The player's name (by reference into the game's name table).
+        string_view GetNameView() const; // @return ---> A view of the player's interned name.
+        size_t GetSeat() const;          // @return ---> The player's seat, a handle to its interned name (NO_SEAT for a copy).
         Game &GetGame() const;  // @return ---> Reference to the associated Game object.
         int coins() const;      // @return ---> The player's coin count.
 
@@ -65,6 +79,12 @@ namespace coup
 
         bool SanctionStatus();
 
+        /**
+         * @param action ---> ActionType::Gather or ActionType::Tax.
+         * @return ---> true if a sanction currently blocks the player from that action.
+         */
+        bool isSanctionedFrom(ActionType action) const;
+
         void ActivateSanction(const std::string &type); // Activates sanction status, blocking gather/tax actions.
         void resetSanction();                           // Removes the sanction status from the player.
         /**
@@ -82,6 +102,15 @@ namespace coup
         void eliminated();              // Marks the player as eliminated (after a successful coup).
         void returnToGame();            // Restores the player to the game .
 
+        /**
+         * Puts the player back in the state of a newly created player (0 coins, no statuses, in the game),
+         * keeping its name and game. Used by Game::reset to reuse player objects across games.
+         */
+        void resetForNewGame();
+
+        void saveImage(SeatImage &out) const; // Copies the player's rule state (see GameImage.hpp); owedTurns is the game's.
+        void loadImage(const SeatImage &in);  // Takes the rule state of an image; the seats it refers to must exist.
+
         /*
          *Pure virtual function that returns the role of the player.
          *Must be implemented by all derived role classes.
@@ -89,6 +118,13 @@ namespace coup
          */
         virtual string GetRole() const = 0;
 
+        /**
+         * Pure virtual function that returns the role of the player as a RoleType.
+         * Cheaper than GetRole() for role checks: no string is built or compared.
+         * @return ---> The role identifier.
+         */
+        virtual RoleType GetRoleType() const = 0;
+
         /**
          * Increases the player's coin count by the given amount.
         // @param coins Number of coins to add.
@@ -118,7 +154,7 @@ namespace coup
          */
         void SetLastAction(const string &action);
 
-        string GetLastAction() const; // return ---> A string representing the last action.
+        const string &GetLastAction() const; // return ---> A string representing the last action.
         /**
          * Actions that every player can do
          * 1.gather ---> the player receives one coin from the treasury. This action has no cost and can be blocked by sanction.
@@ -129,6 +165,8 @@ namespace coup
          * 6.coup ---> The player chooses another player and completely removes them from the game. This action costs 7 coins, and can only be blocked under certain conditions.
          */
         virtual void resetRoleState();
+        virtual bool roleFlag() const { return false; } // Role-specific state kept in a GameImage (the Baron's invest flag).
+        virtual void setRoleFlag(bool) {}               // Restores roleFlag() from a GameImage.
         virtual void gather();
         virtual void tax();
         virtual void bribe();
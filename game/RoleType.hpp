@@ -0,0 +1,67 @@
+// ronamsalem4@gmail.com
+#ifndef ROLETYPE_HPP
+#define ROLETYPE_HPP
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+
+/**
+ * Compact identifiers of the six roles.
+ * Used wherever a role has to be described without a player object (game layouts, reset, saved games)
+ * and for role checks that should not build and compare strings.
+ */
+namespace coup
+{
+    enum class RoleType : std::uint8_t
+    {
+        Governor,
+        Spy,
+        Baron,
+        General,
+        Judge,
+        Merchant
+    };
+
+    constexpr std::size_t ROLE_COUNT = 6; // Number of values in RoleType.
+
+    /**
+     * @return ---> The role's name, the same string Player::GetRole() returns.
+     */
+    inline const char *roleName(RoleType role)
+    {
+        switch (role)
+        {
+        case RoleType::Governor:
+            return "Governor";
+        case RoleType::Spy:
+            return "Spy";
+        case RoleType::Baron:
+            return "Baron";
+        case RoleType::General:
+            return "General";
+        case RoleType::Judge:
+            return "Judge";
+        case RoleType::Merchant:
+            return "Merchant";
+        }
+        return "Unknown";
+    }
+
+    /**
+     * @param name ---> A role name ("Governor", "Spy", ...).
+     * @return ---> The matching RoleType.
+     * @throws ---> invalid_argument if the name is not a role.
+     */
+    inline RoleType roleFromName(const std::string &name)
+    {
+        for (std::size_t i = 0; i < ROLE_COUNT; ++i)
+        {
+            RoleType role = static_cast<RoleType>(i);
+            if (name == roleName(role))
+                return role;
+        }
+        throw std::invalid_argument("Unknown role: " + name);
+    }
+}
+
+#endif
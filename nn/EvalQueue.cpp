@@ -0,0 +1,89 @@
+// ronamsalem4@gmail.com
+#include "EvalQueue.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace coup
+{
+    EvalQueue::EvalQueue(const Network &network, size_t maxBatch, chrono::microseconds wait)
+        : network(network), maxBatch(std::max<size_t>(1, maxBatch)), wait(wait)
+    {
+        pending.reserve(this->maxBatch * 2);
+        worker = thread(&EvalQueue::run, this);
+    }
+
+    EvalQueue::~EvalQueue()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        queued.notify_one();
+        worker.join();
+    }
+
+    /**
+     * The request lives on the caller's stack; the evaluator writes the result and sets done under the lock.
+     */
+    Evaluation EvalQueue::evaluate(const float *features)
+    {
+        Evaluation result;
+        Request request{features, &result, false};
+        unique_lock<mutex> guard(lock);
+        pending.push_back(&request);
+        if (pending.size() == 1 || pending.size() >= maxBatch)
+            queued.notify_one();
+        finished.wait(guard, [&request]
+                      { return request.done; });
+        return result;
+    }
+
+    Evaluation EvalQueue::evaluate(const Game &game)
+    {
+        float features[FEATURE_COUNT];
+        encodeFeatures(game, features);
+        return evaluate(features);
+    }
+
+    /**
+     * The features are copied into one contiguous batch outside the lock, so submitting threads are not held up
+     * while the network runs.
+     */
+    void EvalQueue::run()
+    {
+        vector<Request *> batch;
+        vector<float> inputs(maxBatch * FEATURE_COUNT);
+        vector<Evaluation> outputs(maxBatch);
+        for (;;)
+        {
+            {
+                unique_lock<mutex> guard(lock);
+                queued.wait(guard, [this]
+                            { return stopping || !pending.empty(); });
+                if (stopping && pending.empty())
+                    return;
+                queued.wait_for(guard, wait, [this]
+                                { return stopping || pending.size() >= maxBatch; });
+                size_t take = std::min(pending.size(), maxBatch);
+                batch.assign(pending.begin(), pending.begin() + static_cast<ptrdiff_t>(take));
+                pending.erase(pending.begin(), pending.begin() + static_cast<ptrdiff_t>(take));
+            }
+
+            for (size_t i = 0; i < batch.size(); ++i)
+                memcpy(inputs.data() + i * FEATURE_COUNT, batch[i]->features, FEATURE_COUNT * sizeof(float));
+            network.evaluate(inputs.data(), batch.size(), outputs.data());
+
+            {
+                lock_guard<mutex> guard(lock);
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    *batch[i]->out = outputs[i];
+                    batch[i]->done = true;
+                }
+                evaluated.fetch_add(batch.size(), memory_order_relaxed);
+                batchCount.fetch_add(1, memory_order_relaxed);
+            }
+            finished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+// ronamsalem4@gmail.com
+#ifndef EVALQUEUE_HPP
+#define EVALQUEUE_HPP
+#include "Network.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file EvalQueue.hpp
+ * Batches the network evaluations of many search threads.
+ * A search thread that reaches a leaf submits its position and waits; one evaluator thread takes up to maxBatch
+ * waiting positions (waiting at most `wait` for the batch to fill once the first one arrived), evaluates them in
+ * one Network::evaluate call and wakes their threads. With as many search threads as maxBatch, batches fill as soon
+ * as every thread is waiting.
+ */
+namespace coup
+{
+    class EvalQueue
+    {
+    public:
+        /**
+         * Starts the evaluator thread.
+         * @param network ---> The network; must outlive the queue.
+         * @param maxBatch ---> Most positions per evaluation (at least 1).
+         * @param wait ---> Longest wait for a batch to fill.
+         */
+        EvalQueue(const Network &network, size_t maxBatch, chrono::microseconds wait = chrono::microseconds(200));
+        ~EvalQueue(); // Stops the evaluator thread (no evaluate() call may be waiting).
+        EvalQueue(const EvalQueue &) = delete;
+        EvalQueue &operator=(const EvalQueue &) = delete;
+
+        /**
+         * Evaluates one position; blocks until its batch is done. May be called from any number of threads.
+         * @param features ---> FEATURE_COUNT floats (see encodeFeatures).
+         */
+        Evaluation evaluate(const float *features);
+        Evaluation evaluate(const Game &game); // Encodes the game's position and evaluates it.
+
+        uint64_t evaluations() const { return evaluated.load(memory_order_relaxed); }
+        uint64_t batches() const { return batchCount.load(memory_order_relaxed); }
+
+    private:
+        struct Request
+        {
+            const float *features;
+            Evaluation *out;
+            bool done;
+        };
+
+        void run(); // The evaluator thread.
+
+        const Network &network;
+        size_t maxBatch;
+        chrono::microseconds wait;
+        mutex lock;
+        condition_variable queued;   // a request arrived (or the queue stops)
+        condition_variable finished; // a batch is done
+        vector<Request *> pending;
+        bool stopping = false;
+        atomic<uint64_t> evaluated{0}, batchCount{0};
+        thread worker;
+    };
+}
+
+#endif
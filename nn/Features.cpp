@@ -0,0 +1,64 @@
+// ronamsalem4@gmail.com
+#include "Features.hpp"
+#include <algorithm>
+
+namespace coup
+{
+    void encodeFeatures(const GameImage &image, float *out)
+    {
+        std::fill(out, out + FEATURE_COUNT, 0.0f);
+        size_t seats = image.numSeats, alive = 0;
+        for (size_t r = 0; r < seats; ++r)
+        {
+            size_t s = (image.turn + r) % seats;
+            const SeatImage &seat = image.seats[s];
+            float *f = out + r * SEAT_FEATURES;
+            bool inGame = seat.flags & SeatImage::InGame;
+            alive += inGame;
+            f[0] = inGame;
+            f[1 + static_cast<size_t>(seat.role) % ROLE_COUNT] = 1;
+            f[7] = seat.coins / 10.0f;
+            f[8] = (seat.flags & SeatImage::SanctionGather) != 0;
+            f[9] = (seat.flags & SeatImage::SanctionTax) != 0;
+            f[10] = (seat.flags & SeatImage::ArrestTurnBlocked) != 0;
+            f[11] = seat.lastAction == ActionType::Arrest;
+            f[12] = image.lastArrestedVictim == s;
+            f[13] = seat.owedTurns;
+        }
+        float *g = out + Game::MAX_PLAYERS * SEAT_FEATURES;
+        g[0] = static_cast<float>(alive) / Game::MAX_PLAYERS;
+        g[1] = static_cast<float>(seats) / Game::MAX_PLAYERS;
+        g[2] = alive == 2;
+        g[3] = 1; // a constant input
+    }
+
+    void encodeFeatures(const Game &game, float *out)
+    {
+        GameImage image;
+        game.captureImage(image);
+        encodeFeatures(image, out);
+    }
+
+    size_t moveSlot(const Game &game, const Move &move)
+    {
+        switch (move.action)
+        {
+        case ActionType::Gather:
+            return 0;
+        case ActionType::Tax:
+            return 1;
+        case ActionType::Bribe:
+            return 2;
+        case ActionType::Invest:
+            return 3;
+        case ActionType::None:
+            return 4;
+        default:
+            break;
+        }
+        size_t seats = game.numPlayers();
+        size_t r = (move.target + seats - game.turnSeat()) % seats; // 1 .. seats - 1
+        size_t kind = move.action == ActionType::Arrest ? 0 : move.action == ActionType::Sanction ? 1 + move.option : 3;
+        return 5 + 4 * (r - 1) + kind;
+    }
+}
@@ -0,0 +1,38 @@
+// ronamsalem4@gmail.com
+#ifndef FEATURES_HPP
+#define FEATURES_HPP
+#include "../game/Game.hpp"
+#include "../game/GameImage.hpp"
+#include "../game/Moves.hpp"
+#include <cstddef>
+
+/**
+ * @file Features.hpp
+ * The fixed-size input and output of the evaluator network (see Network.hpp).
+ * A position is encoded from the side of the player to move: the six seats in turn order starting with the mover
+ * (seats the table does not have are zeros), SEAT_FEATURES floats each, then a few about the whole game.
+ * Per seat: in the game, role (one-hot, 6), coins / 10, sanctioned from gather, from tax, arrest blocked by a Spy,
+ * last action was an arrest, is the last arrested player, extra turns owed.
+ * A move is one of POLICY_SIZE slots: gather, tax, bribe, invest, pass, then for each other seat in turn order
+ * after the mover arrest, sanction gather, sanction tax, coup. The slots past the last are padding.
+ */
+namespace coup
+{
+    static constexpr size_t SEAT_FEATURES = 14;
+    static constexpr size_t FEATURE_COUNT = Game::MAX_PLAYERS * SEAT_FEATURES + 4; // 88, a multiple of 8
+    static constexpr size_t MOVE_SLOTS = 5 + 4 * (Game::MAX_PLAYERS - 1);           // 25
+    static constexpr size_t POLICY_SIZE = 32;                                         // MOVE_SLOTS padded to 8
+
+    static_assert(FEATURE_COUNT % 8 == 0 && POLICY_SIZE % 8 == 0, "The network's layers are multiples of 8 wide");
+
+    void encodeFeatures(const GameImage &image, float *out); // Writes FEATURE_COUNT floats.
+    void encodeFeatures(const Game &game, float *out);       // Writes FEATURE_COUNT floats.
+
+    /**
+     * @param game ---> A started game; the move is one of the current player's.
+     * @return ---> The policy slot of the move.
+     */
+    size_t moveSlot(const Game &game, const Move &move);
+}
+
+#endif
@@ -0,0 +1,164 @@
+// ronamsalem4@gmail.com
+#include "Gemm.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COUP_GEMM_AVX2 1
+#endif
+
+namespace coup
+{
+    static void scalarGemm(const float *x, const float *w, const float *bias, float *y, size_t rows, size_t depth,
+                           size_t cols, bool relu)
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            float *out = y + i * cols;
+            std::copy(bias, bias + cols, out);
+            for (size_t k = 0; k < depth; ++k)
+            {
+                float in = x[i * depth + k];
+                const float *row = w + k * cols;
+                for (size_t j = 0; j < cols; ++j)
+                    out[j] += in * row[j];
+            }
+            if (relu)
+                for (size_t j = 0; j < cols; ++j)
+                    out[j] = std::max(out[j], 0.0f);
+        }
+    }
+
+#ifdef COUP_GEMM_AVX2
+    /**
+     * One R x (8 * C) block of Y: R * C accumulators stay in registers for the whole depth; each step loads C
+     * vectors of a W row once and uses them for all R rows of X (one broadcast and C FMAs per row).
+     */
+    template <size_t R, size_t C>
+    __attribute__((target("avx2,fma"))) static inline void avx2Block(const float *x, const float *w, const float *bias,
+                                                                    float *y, size_t depth, size_t cols, bool relu)
+    {
+        __m256 acc[R][C];
+        for (size_t c = 0; c < C; ++c)
+        {
+            __m256 b = _mm256_loadu_ps(bias + 8 * c);
+            for (size_t r = 0; r < R; ++r)
+                acc[r][c] = b;
+        }
+        for (size_t k = 0; k < depth; ++k)
+        {
+            __m256 row[C];
+            for (size_t c = 0; c < C; ++c)
+                row[c] = _mm256_loadu_ps(w + k * cols + 8 * c);
+            for (size_t r = 0; r < R; ++r)
+            {
+                __m256 in = _mm256_broadcast_ss(x + r * depth + k);
+                for (size_t c = 0; c < C; ++c)
+                    acc[r][c] = _mm256_fmadd_ps(in, row[c], acc[r][c]);
+            }
+        }
+        __m256 zero = _mm256_setzero_ps();
+        for (size_t r = 0; r < R; ++r)
+            for (size_t c = 0; c < C; ++c)
+                _mm256_storeu_ps(y + r * cols + 8 * c, relu ? _mm256_max_ps(acc[r][c], zero) : acc[r][c]);
+    }
+
+    /**
+     * R rows of Y: 16-column blocks, then one 8-column block, then the last cols % 8 columns one at a time
+     * (same order of sums as the scalar kernel).
+     */
+    template <size_t R>
+    __attribute__((target("avx2,fma"))) static inline void avx2Rows(const float *x, const float *w, const float *bias,
+                                                                   float *y, size_t depth, size_t cols, bool relu)
+    {
+        size_t j = 0;
+        for (; j + 16 <= cols; j += 16)
+            avx2Block<R, 2>(x, w + j, bias + j, y + j, depth, cols, relu);
+        if (j + 8 <= cols)
+        {
+            avx2Block<R, 1>(x, w + j, bias + j, y + j, depth, cols, relu);
+            j += 8;
+        }
+        for (; j < cols; ++j)
+            for (size_t r = 0; r < R; ++r)
+            {
+                float sum = bias[j];
+                for (size_t k = 0; k < depth; ++k)
+                    sum += x[r * depth + k] * w[k * cols + j];
+                y[r * cols + j] = relu ? std::max(sum, 0.0f) : sum;
+            }
+    }
+
+    __attribute__((target("avx2,fma"))) static void avx2Gemm(const float *x, const float *w, const float *bias, float *y,
+                                                             size_t rows, size_t depth, size_t cols, bool relu)
+    {
+        size_t i = 0;
+        for (; i + 6 <= rows; i += 6)
+            avx2Rows<6>(x + i * depth, w, bias, y + i * cols, depth, cols, relu);
+        x += i * depth;
+        y += i * cols;
+        switch (rows - i) // the last rows, still in one pass over W
+        {
+        case 5:
+            return avx2Rows<5>(x, w, bias, y, depth, cols, relu);
+        case 4:
+            return avx2Rows<4>(x, w, bias, y, depth, cols, relu);
+        case 3:
+            return avx2Rows<3>(x, w, bias, y, depth, cols, relu);
+        case 2:
+            return avx2Rows<2>(x, w, bias, y, depth, cols, relu);
+        case 1:
+            return avx2Rows<1>(x, w, bias, y, depth, cols, relu);
+        }
+    }
+#endif
+
+    bool gemmSupported(GemmKernel kernel)
+    {
+#ifdef COUP_GEMM_AVX2
+        if (kernel == GemmKernel::Avx2)
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        }
+#endif
+        return kernel == GemmKernel::Scalar;
+    }
+
+    static GemmKernel &activeKernel()
+    {
+        static GemmKernel kernel = gemmSupported(GemmKernel::Avx2) ? GemmKernel::Avx2 : GemmKernel::Scalar;
+        return kernel;
+    }
+
+    GemmKernel gemmKernel()
+    {
+        return activeKernel();
+    }
+
+    const char *gemmKernelName(GemmKernel kernel)
+    {
+        return kernel == GemmKernel::Avx2 ? "avx2" : "scalar";
+    }
+
+    void setGemmKernel(GemmKernel kernel)
+    {
+        if (!gemmSupported(kernel))
+            throw std::invalid_argument(std::string("The ") + gemmKernelName(kernel) + " kernel cannot run on this CPU");
+        activeKernel() = kernel;
+    }
+
+    void gemm(const float *x, const float *w, const float *bias, float *y, size_t rows, size_t depth, size_t cols, bool relu)
+    {
+#ifdef COUP_GEMM_AVX2
+        if (activeKernel() == GemmKernel::Avx2)
+        {
+            avx2Gemm(x, w, bias, y, rows, depth, cols, relu);
+            return;
+        }
+#endif
+        scalarGemm(x, w, bias, y, rows, depth, cols, relu);
+    }
+}
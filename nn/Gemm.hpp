@@ -0,0 +1,37 @@
+// ronamsalem4@gmail.com
+#ifndef GEMM_HPP
+#define GEMM_HPP
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file Gemm.hpp
+ * The matrix product of a network layer over a batch: Y = X W + bias, optionally through a ReLU.
+ * X is rows x depth, W is depth x cols (the layer's inputs by its outputs), Y is rows x cols, all row-major and
+ * dense.
+ * Two kernels: a portable scalar one, and an AVX2 / FMA one that keeps a 6 x 16 block of Y in registers and
+ * streams the rows of W through it (the last cols % 8 columns, if any, are computed one by one). The AVX2 kernel is compiled for that target alone, and the first call checks
+ * the CPU once and picks it when it can run, so the binary still runs (scalar) on older machines.
+ */
+namespace coup
+{
+    enum class GemmKernel : uint8_t
+    {
+        Scalar,
+        Avx2
+    };
+
+    void gemm(const float *x, const float *w, const float *bias, float *y, size_t rows, size_t depth, size_t cols, bool relu);
+
+    bool gemmSupported(GemmKernel kernel); // @return ---> true if the CPU (and the build) can run the kernel.
+    GemmKernel gemmKernel();              // @return ---> The kernel gemm() uses.
+    const char *gemmKernelName(GemmKernel kernel);
+
+    /**
+     * Chooses the kernel of the following gemm() calls (benchmarks and tests); not while other threads multiply.
+     * @throws ---> invalid_argument if the kernel cannot run here.
+     */
+    void setGemmKernel(GemmKernel kernel);
+}
+
+#endif
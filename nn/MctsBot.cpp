@@ -0,0 +1,108 @@
+// ronamsalem4@gmail.com
+#include "MctsBot.hpp"
+#include "../game/Player.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace coup
+{
+    /**
+     * The children's priors are the softmax of the policy logits of the legal moves (the other slots are ignored).
+     */
+    void MctsBot::expand(uint32_t node, const Game &position, const Evaluation &evaluation)
+    {
+        MoveList moves = legalMoves(position);
+        float logits[MoveList::CAPACITY], top = -INFINITY, sum = 0;
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            logits[i] = evaluation.policy[moveSlot(position, moves[i])];
+            top = std::max(top, logits[i]);
+        }
+        for (size_t i = 0; i < moves.size(); ++i)
+            sum += (logits[i] = std::exp(logits[i] - top));
+
+        uint8_t actor = static_cast<uint8_t>(position.turnSeat());
+        tree[node].firstChild = static_cast<uint32_t>(tree.size());
+        tree[node].children = static_cast<uint16_t>(moves.size());
+        tree[node].expanded = true;
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            Node child;
+            child.move = moves[i];
+            child.actor = actor;
+            child.prior = logits[i] / sum;
+            tree.push_back(child);
+        }
+    }
+
+    Move MctsBot::choose(const Game &game)
+    {
+        MoveList moves = legalMoves(game);
+        if (moves.size() == 1)
+            return moves[0];
+
+        GameImage root;
+        game.captureImage(root);
+        tree.clear();
+        tree.emplace_back();
+        expand(0, game, queue.evaluate(game));
+
+        float values[Game::MAX_PLAYERS];
+        for (size_t s = 0; s < simulations; ++s)
+        {
+            scratch.restoreImage(root);
+            path.assign(1, 0);
+            uint32_t node = 0;
+            while (tree[node].expanded && tree[node].children > 0 && !scratch.isOver())
+            {
+                const Node &parent = tree[node];
+                float scale = exploration * std::sqrt(static_cast<float>(std::max<uint32_t>(parent.visits, 1)));
+                uint32_t best = parent.firstChild;
+                float bestScore = -INFINITY;
+                for (uint32_t c = parent.firstChild; c < parent.firstChild + parent.children; ++c)
+                {
+                    const Node &child = tree[c];
+                    float q = child.visits > 0 ? child.valueSum / static_cast<float>(child.visits) : 0;
+                    float score = q + scale * child.prior / static_cast<float>(1 + child.visits);
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        best = c;
+                    }
+                }
+                applyMove(scratch, tree[best].move);
+                node = best;
+                path.push_back(node);
+            }
+
+            if (optional<size_t> winner = scratch.winnerSeat())
+            {
+                for (size_t seat = 0; seat < Game::MAX_PLAYERS; ++seat)
+                    values[seat] = seat == *winner ? 1.0f : 0.0f;
+            }
+            else
+            {
+                Evaluation evaluation = queue.evaluate(scratch);
+                expand(node, scratch, evaluation);
+                size_t mover = scratch.turnSeat();
+                float others = (1 - evaluation.value) / static_cast<float>(scratch.alivePlayers() - 1);
+                for (size_t seat = 0; seat < Game::MAX_PLAYERS; ++seat)
+                    values[seat] = seat == mover                                                        ? evaluation.value
+                                   : seat < scratch.numPlayers() && scratch.getPlayer(seat).Getstillingame() ? others
+                                                                                                        : 0.0f;
+            }
+            for (uint32_t n : path)
+            {
+                ++tree[n].visits;
+                tree[n].valueSum += values[tree[n].actor];
+            }
+        }
+
+        const Node &top = tree[0];
+        uint32_t best = top.firstChild;
+        for (uint32_t c = top.firstChild; c < top.firstChild + top.children; ++c)
+            if (tree[c].visits > tree[best].visits)
+                best = c;
+        return tree[best].move;
+    }
+}
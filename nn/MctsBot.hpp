@@ -0,0 +1,65 @@
+// ronamsalem4@gmail.com
+#ifndef MCTSBOT_HPP
+#define MCTSBOT_HPP
+#include "EvalQueue.hpp"
+#include "../game/GameImage.hpp"
+#include "../game/Moves.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file MctsBot.hpp
+ * A Monte Carlo tree search guided by the network (PUCT): each simulation walks down the tree by
+ * Q + exploration * prior * sqrt(parent visits) / (1 + visits), evaluates the leaf it reaches through an EvalQueue
+ * and expands it with the network's policy (softmax over the legal moves) as priors.
+ * Values are chances to win. A leaf's value v is the mover's; every other player still in the game gets
+ * (1 - v) / (players left - 1). A finished game gives 1 to the winner and 0 to the others. Each node keeps the
+ * value of the player who moved into it.
+ * Blocks are not searched (as in RolloutBot). Several bots on their own threads share one queue, which batches
+ * their leaves.
+ */
+namespace coup
+{
+    class MctsBot
+    {
+    public:
+        /**
+         * @param queue ---> Evaluates the leaves; must outlive the bot.
+         * @param simulations ---> Simulations per move (each evaluates at most one leaf).
+         */
+        explicit MctsBot(EvalQueue &queue, size_t simulations = 64, float exploration = 1.5f)
+            : queue(queue), simulations(simulations == 0 ? 1 : simulations), exploration(exploration) {}
+        MctsBot(const MctsBot &) = delete;
+        MctsBot &operator=(const MctsBot &) = delete;
+
+        /**
+         * @param game ---> A started game that is not over (not changed).
+         * @return ---> The most visited legal move.
+         */
+        Move choose(const Game &game);
+
+    private:
+        struct Node
+        {
+            Move move;              // the move into this node
+            uint8_t actor = 0;      // seat that played it
+            uint32_t firstChild = 0;
+            uint16_t children = 0;
+            bool expanded = false;
+            float prior = 0;
+            uint32_t visits = 0;
+            float valueSum = 0;     // of the actor
+        };
+
+        void expand(uint32_t node, const Game &position, const Evaluation &evaluation);
+
+        EvalQueue &queue;
+        size_t simulations;
+        float exploration;
+        vector<Node> tree;    // reused between moves
+        vector<uint32_t> path;
+        Game scratch;
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+// ronamsalem4@gmail.com
+#include "Network.hpp"
+#include "Gemm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace coup
+{
+    static constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'N', 'N', 'E', 'T'};
+    static constexpr uint32_t NETWORK_FORMAT = 1;
+
+    /**
+     * He initialisation: normal weights with variance 2 / inputs, biases zero.
+     */
+    Network::Network(uint64_t seed)
+        : w1(FEATURE_COUNT * HIDDEN), b1(HIDDEN, 0), w2(HIDDEN * HIDDEN), b2(HIDDEN, 0), w3(HIDDEN * OUTPUTS), b3(OUTPUTS, 0)
+    {
+        mt19937_64 rng(seed);
+        auto fill = [&rng](vector<float> &weights, size_t inputs)
+        {
+            normal_distribution<float> normal(0.0f, std::sqrt(2.0f / static_cast<float>(inputs)));
+            for (float &weight : weights)
+                weight = normal(rng);
+        };
+        fill(w1, FEATURE_COUNT);
+        fill(w2, HIDDEN);
+        fill(w3, HIDDEN);
+        for (size_t k = 0; k < HIDDEN; ++k)
+            for (size_t j = POLICY_SIZE + 1; j < OUTPUTS; ++j)
+                w3[k * OUTPUTS + j] = 0; // padding
+    }
+
+    Network::Network(const string &path) : Network(0)
+    {
+        ifstream file(path, ios::binary);
+        char magic[sizeof(MAGIC)] = {};
+        uint32_t header[4] = {};
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char *>(header), sizeof(header));
+        if (!file || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || header[0] != NETWORK_FORMAT ||
+            header[1] != FEATURE_COUNT || header[2] != HIDDEN || header[3] != OUTPUTS)
+            throw runtime_error("Not a network of this shape: " + path);
+        for (vector<float> *layer : {&w1, &b1, &w2, &b2, &w3, &b3})
+            file.read(reinterpret_cast<char *>(layer->data()), static_cast<streamsize>(layer->size() * sizeof(float)));
+        if (!file || file.peek() != EOF)
+            throw runtime_error("Not a network of this shape: " + path);
+    }
+
+    void Network::save(const string &path) const
+    {
+        ofstream file(path, ios::binary | ios::trunc);
+        uint32_t header[4] = {NETWORK_FORMAT, FEATURE_COUNT, HIDDEN, OUTPUTS};
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        for (const vector<float> *layer : {&w1, &b1, &w2, &b2, &w3, &b3})
+            file.write(reinterpret_cast<const char *>(layer->data()), static_cast<streamsize>(layer->size() * sizeof(float)));
+        if (!file)
+            throw runtime_error("Cannot write " + path);
+    }
+
+    /**
+     * The activations live in per-thread buffers that only grow, so a steady stream of batches does not allocate.
+     */
+    void Network::evaluate(const float *features, size_t batch, Evaluation *out) const
+    {
+        thread_local vector<float> hidden1, hidden2, outputs;
+        hidden1.resize(std::max(hidden1.size(), batch * HIDDEN));
+        hidden2.resize(std::max(hidden2.size(), batch * HIDDEN));
+        outputs.resize(std::max(outputs.size(), batch * OUTPUTS));
+
+        gemm(features, w1.data(), b1.data(), hidden1.data(), batch, FEATURE_COUNT, HIDDEN, true);
+        gemm(hidden1.data(), w2.data(), b2.data(), hidden2.data(), batch, HIDDEN, HIDDEN, true);
+        gemm(hidden2.data(), w3.data(), b3.data(), outputs.data(), batch, HIDDEN, OUTPUTS, false);
+
+        for (size_t i = 0; i < batch; ++i)
+        {
+            const float *row = outputs.data() + i * OUTPUTS;
+            memcpy(out[i].policy, row, sizeof(out[i].policy));
+            out[i].value = 1.0f / (1.0f + std::exp(-row[POLICY_SIZE]));
+        }
+    }
+}
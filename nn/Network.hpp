@@ -0,0 +1,61 @@
+// ronamsalem4@gmail.com
+#ifndef NETWORK_HPP
+#define NETWORK_HPP
+#include "Features.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file Network.hpp
+ * A small multilayer perceptron that evaluates positions: FEATURE_COUNT inputs, two ReLU layers of HIDDEN units,
+ * and an output layer holding the policy (one logit per move slot) and the value (the chance that the player to
+ * move wins, through a sigmoid).
+ * It evaluates a batch at a time: each layer is one gemm() over the whole batch, so the weights are read once per
+ * batch rather than once per position.
+ * The file is "COUPNNET", u32 format, u32 inputs, u32 hidden units, u32 outputs, then the float weights and biases
+ * of the three layers in order, each weight matrix inputs x outputs.
+ */
+namespace coup
+{
+    struct Evaluation
+    {
+        float value = 0;               // chance that the player to move wins, 0 to 1
+        float policy[POLICY_SIZE] = {}; // logits of the move slots (see Features.hpp)
+    };
+
+    class Network
+    {
+    public:
+        static constexpr size_t HIDDEN = 128;
+        static constexpr size_t OUTPUTS = POLICY_SIZE + 8; // the value after the policy, padded to 8
+
+        /**
+         * An untrained network with small random weights (the starting point of training, and for tests).
+         */
+        explicit Network(uint64_t seed);
+
+        /**
+         * Loads a network file.
+         * @throws ---> runtime_error if it cannot be read or is not a network of this shape.
+         */
+        explicit Network(const string &path);
+
+        /**
+         * @throws ---> runtime_error if the file cannot be written.
+         */
+        void save(const string &path) const;
+
+        /**
+         * Evaluates a batch of positions; may be called from several threads.
+         * @param features ---> batch rows of FEATURE_COUNT floats (see encodeFeatures).
+         * @param out ---> batch evaluations.
+         */
+        void evaluate(const float *features, size_t batch, Evaluation *out) const;
+
+    private:
+        vector<float> w1, b1, w2, b2, w3, b3;
+    };
+}
+
+#endif
@@ -0,0 +1,110 @@
+// ronamsalem4@gmail.com
+#include "Training.hpp"
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace coup
+{
+    static constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'D', 'A', 'T', 'A'};
+    static constexpr uint32_t TRAINING_FORMAT = 1;
+
+    /**
+     * Replays the games of one block (dealt as recordGame deals them: reset with the game's seed and roles) and
+     * appends their samples.
+     * @throws ---> runtime_error if a move is not the recorded actor's, the rules refuse it, or the game ends with
+     *              another winner.
+     */
+    static void replayBlock(const RecordBlock &block, Game &game, vector<TrainingSample> &out)
+    {
+        size_t m = 0;
+        for (uint32_t g = 0; g < block.games; ++g)
+        {
+            size_t first = m;
+            m += block.length[g];
+            uint8_t winner = block.winner[g];
+            if (winner == NO_SEAT)
+                continue;
+            vector<RoleType> layout(block.seats[g]);
+            for (size_t s = 0; s < layout.size(); ++s)
+                layout[s] = static_cast<RoleType>(block.roles[g * Game::MAX_PLAYERS + s]);
+            try
+            {
+                game.reset(block.seed[g], layout);
+                for (size_t i = first; i < m; ++i)
+                {
+                    if (block.actor[i] != game.turnSeat())
+                        throw invalid_argument("out of turn");
+                    Move move{static_cast<ActionType>(block.action[i]), block.target[i], block.option[i]};
+                    TrainingSample &sample = out.emplace_back();
+                    encodeFeatures(game, sample.features);
+                    sample.move = static_cast<uint8_t>(moveSlot(game, move));
+                    sample.won = block.actor[i] == winner;
+                    sample.seats = block.seats[g];
+                    applyMove(game, move);
+                    if (block.blocker[i] != NO_SEAT)
+                        applyBlock(game, block.blocker[i], block.actor[i], move);
+                }
+            }
+            catch (const invalid_argument &)
+            {
+                throw runtime_error("Game " + to_string(block.seed[g]) + " does not replay");
+            }
+            if (game.winnerSeat() != winner)
+                throw runtime_error("Game " + to_string(block.seed[g]) + " does not replay to its winner");
+        }
+    }
+
+    /**
+     * Threads take blocks from a shared counter and write each block's samples in one piece.
+     */
+    uint64_t exportTrainingData(const RecordFile &records, const string &path, size_t threads)
+    {
+        ofstream file(path, ios::binary | ios::trunc);
+        uint32_t header[4] = {TRAINING_FORMAT, FEATURE_COUNT, POLICY_SIZE, 0};
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        if (!file)
+            throw runtime_error("Cannot create " + path);
+
+        threads = threads == 0 ? 1 : threads;
+        mutex lock;
+        uint64_t written = 0;
+        string failure;
+        atomic<size_t> next{0};
+        vector<thread> workers;
+        for (size_t t = 0; t < threads; ++t)
+            workers.emplace_back([&]
+                                 {
+                Game game;
+                vector<TrainingSample> samples;
+                try
+                {
+                    for (size_t b; (b = next.fetch_add(1)) < records.blocks();)
+                    {
+                        samples.clear();
+                        replayBlock(records.block(b), game, samples);
+                        lock_guard<mutex> guard(lock);
+                        file.write(reinterpret_cast<const char *>(samples.data()),
+                                   static_cast<streamsize>(samples.size() * sizeof(TrainingSample)));
+                        written += samples.size();
+                    }
+                }
+                catch (const exception &e)
+                {
+                    lock_guard<mutex> guard(lock);
+                    failure = e.what();
+                    next = records.blocks(); // the others stop after their block
+                } });
+        for (thread &worker : workers)
+            worker.join();
+        if (!failure.empty())
+            throw runtime_error(failure);
+        file.flush();
+        if (!file)
+            throw runtime_error("Cannot write " + path);
+        return written;
+    }
+}
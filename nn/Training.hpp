@@ -0,0 +1,39 @@
+// ronamsalem4@gmail.com
+#ifndef TRAINING_HPP
+#define TRAINING_HPP
+#include "Features.hpp"
+#include "../stats/Records.hpp"
+#include <cstdint>
+#include <string>
+
+/**
+ * @file Training.hpp
+ * Training data for the network, from self-play records (see Records.hpp).
+ * Every game with a winner is replayed from its seed and moves (blocks included); each position before a move
+ * becomes a sample: its features, the slot of the move played (policy target) and whether the player to move
+ * went on to win (value target). Abandoned games are skipped.
+ * The file is "COUPDATA", u32 format, u32 FEATURE_COUNT, u32 POLICY_SIZE, u32 reserved, then the samples, fixed
+ * size and in no particular order (blocks are replayed on several threads).
+ */
+namespace coup
+{
+    struct TrainingSample
+    {
+        float features[FEATURE_COUNT];
+        uint8_t move = 0; // policy slot of the move played
+        uint8_t won = 0;  // 1 if the player to move won the game
+        uint8_t seats = 0;
+        uint8_t reserved = 0;
+    };
+    static_assert(sizeof(TrainingSample) == FEATURE_COUNT * 4 + 4, "TrainingSample is a file format");
+
+    /**
+     * Replays a record file into a training file.
+     * @param threads ---> Replay threads (at least 1).
+     * @return ---> Samples written.
+     * @throws ---> runtime_error if the file cannot be written or a game does not replay to its recorded winner.
+     */
+    uint64_t exportTrainingData(const RecordFile &records, const string &path, size_t threads);
+}
+
+#endif
@@ -0,0 +1,156 @@
+// ronamsalem4@gmail.com
+#include "Gemm.hpp"
+#include "MctsBot.hpp"
+#include "Training.hpp"
+#include "../game/Logger.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+/**
+ * coup_nn: the network evaluator's tools.
+ *   --bench                       batched inference speed of each GEMM kernel (the default)
+ *   --selfplay=N                  N six-player games of MctsBots on --threads threads sharing one EvalQueue
+ *   --export=games.rec            training data from a record file (see coup_stats) to --out
+ *   --init=net.bin                writes an untrained network
+ * Other options: [--net=net.bin (else untrained from --seed)] [--out=train.dat] [--threads=N] [--simulations=64]
+ *                [--seed=1]
+ */
+
+using namespace coup;
+using namespace std;
+
+static double seconds(chrono::steady_clock::time_point since)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - since).count();
+}
+
+static void bench(const Network &network)
+{
+    const size_t batches[] = {1, 8, 32, 128};
+    vector<float> inputs(128 * FEATURE_COUNT);
+    Game game;
+    game.reset(1, {RoleType::Governor, RoleType::Spy, RoleType::Baron, RoleType::General, RoleType::Judge, RoleType::Merchant});
+    for (size_t i = 0; i < 128; ++i)
+        encodeFeatures(game, inputs.data() + i * FEATURE_COUNT);
+    vector<Evaluation> out(128);
+
+    cout << "positions per second by batch size\n" << setw(8) << "";
+    for (size_t batch : batches)
+        cout << setw(12) << batch;
+    cout << "\n";
+    for (GemmKernel kernel : {GemmKernel::Scalar, GemmKernel::Avx2})
+    {
+        if (!gemmSupported(kernel))
+            continue;
+        setGemmKernel(kernel);
+        cout << setw(8) << gemmKernelName(kernel);
+        for (size_t batch : batches)
+        {
+            size_t positions = 0;
+            auto start = chrono::steady_clock::now();
+            while (positions < 200000 || seconds(start) < 0.2)
+            {
+                network.evaluate(inputs.data(), batch, out.data());
+                positions += batch;
+            }
+            cout << setw(12) << static_cast<uint64_t>(positions / seconds(start));
+        }
+        cout << "\n";
+    }
+}
+
+static void selfPlay(const Network &network, uint64_t games, size_t threads, size_t simulations, uint64_t seed)
+{
+    EvalQueue queue(network, threads);
+    atomic<uint64_t> next{0}, moves{0};
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t)
+        workers.emplace_back([&]
+                             {
+            MctsBot bot(queue, simulations);
+            Game game;
+            for (uint64_t g; (g = next.fetch_add(1)) < games;)
+            {
+                game.reset(seed + g, {RoleType::Governor, RoleType::Spy, RoleType::Baron, RoleType::General,
+                                      RoleType::Judge, RoleType::Merchant});
+                for (uint32_t m = 0; m < MAX_RECORDED_MOVES && !game.isOver(); ++m, ++moves)
+                    applyMove(game, bot.choose(game));
+            } });
+    for (thread &worker : workers)
+        worker.join();
+    double elapsed = seconds(start);
+    cout << games << " games, " << moves << " moves in " << elapsed << " s; " << queue.evaluations()
+         << " evaluations in " << queue.batches() << " batches (" << fixed << setprecision(1)
+         << static_cast<double>(queue.evaluations()) / std::max<uint64_t>(1, queue.batches()) << " per batch, "
+         << setprecision(0) << queue.evaluations() / elapsed << " per second)" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    string net, init, records, out = "train.dat";
+    uint64_t games = 0, seed = 1;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency()), simulations = 64;
+    try
+    {
+        for (int a = 1; a < argc; ++a)
+        {
+            string arg = argv[a];
+            size_t eq = arg.find('=');
+            string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+            if (key == "--bench")
+                continue;
+            else if (key == "--net")
+                net = value;
+            else if (key == "--init")
+                init = value;
+            else if (key == "--export")
+                records = value;
+            else if (key == "--out")
+                out = value;
+            else if (key == "--selfplay")
+                games = stoull(value);
+            else if (key == "--threads")
+                threads = std::max<size_t>(1, stoul(value));
+            else if (key == "--simulations")
+                simulations = stoul(value);
+            else if (key == "--seed")
+                seed = stoull(value);
+            else
+            {
+                cerr << "Unknown option " << arg << endl;
+                return 2;
+            }
+        }
+        Logger::instance().setLevel(LogLevel::Off); // searches and replays run the rules millions of times
+        unique_ptr<Network> network = net.empty() ? make_unique<Network>(seed) : make_unique<Network>(net);
+
+        if (!init.empty())
+        {
+            network->save(init);
+            cout << "Network written to " << init << endl;
+        }
+        else if (!records.empty())
+        {
+            auto start = chrono::steady_clock::now();
+            RecordFile file(records);
+            uint64_t samples = exportTrainingData(file, out, threads);
+            cout << samples << " samples from " << file.games() << " games written to " << out << " in "
+                 << seconds(start) << " s" << endl;
+        }
+        else if (games > 0)
+            selfPlay(*network, games, threads, simulations, seed);
+        else
+            bench(*network);
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -23,6 +23,14 @@ namespace coup
         return "Baron";
     }
 
+    /**
+     * @return ---> RoleType::Baron
+     */
+    RoleType Baron::GetRoleType() const
+    {
+        return RoleType::Baron;
+    }
+
     /**
      * Performs the Baron's invest action: pay 3 coins to gain 6.
      * Can only be used if the player has at least 3 coins.
@@ -40,6 +48,7 @@ namespace coup
         DecreaseCoins(3);
         AddCoins(6);
         investedThisTurn = true;
+        emit(EventType::ActionPerformed, ActionType::Invest);
         GetGame().advanceTurn();
     }
 
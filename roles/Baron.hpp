@@ -15,11 +15,14 @@ namespace coup
     public:
         Baron(Game &game, const std::string &name);           // A constructor through which we will create a Baron object
         std::string GetRole() const override;                 // Accepting the role of the actor
+        RoleType GetRoleType() const override;                // Returns RoleType::Baron.
         void invest();                                        // Baron's upgrade operation
         void getscanction();                                  // Receiving compensation in the event of an attack by a scanction
         void resetInvestFlag();                               // Resets the investment flag .
         void onSanction() override;                           // Checking whether the player is being targeted by a sanction
         bool hasInvested() const { return investedThisTurn; } // Checks if the Baron has already invested this turn.
         void resetRoleState() override;                       // Resets the Baron's role-specific state at the end of their turn.
+        bool roleFlag() const override { return investedThisTurn; }
+        void setRoleFlag(bool invested) override { investedThisTurn = invested; }
     };
 }
@@ -1,6 +1,7 @@
 // ronamsalem4@gmail.com
 #include "General.hpp"
 #include "../game/Game.hpp"
+#include "../game/Logger.hpp"
 namespace coup
 {
 
@@ -19,6 +20,14 @@ namespace coup
     {
         return "General";
     }
+
+    /**
+     * @return ---> RoleType::General
+     */
+    RoleType General::GetRoleType() const
+    {
+        return RoleType::General;
+    }
     /**
      *  Blocks a coup against the given player.
      * The General pays 5 coins to prevent a coup.
@@ -41,7 +50,8 @@ namespace coup
         //  target.returnToGame();
         GetGame().returnPlayer(&target);
 
-        std::cout << " BlockCoup successful! " << target.GetName() << " returned to the game.\n";
+        Logger::instance().log(LogLevel::Info, " BlockCoup successful! ", target.GetNameView(), " returned to the game.");
+        emit(EventType::Blocked, ActionType::Coup, &target);
         GetGame().advanceTurn();
     }
     /**
@@ -16,6 +16,7 @@ namespace coup
     public:
         General(Game &game, const string &name); // Constructs a new General player.
         string GetRole() const override;         // Returns the role name: "General".
+        RoleType GetRoleType() const override;   // Returns RoleType::General.
         void BlockCoup(Player &target);          // Blocks a coup targeting the given player by paying 5 coins.
         void Gotarrested();                      // Called when the General is arrested.
     };
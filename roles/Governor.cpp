@@ -20,6 +20,14 @@ namespace coup
     {
         return "Governor";
     }
+
+    /**
+     * @return ---> RoleType::Governor
+     */
+    RoleType Governor::GetRoleType() const
+    {
+        return RoleType::Governor;
+    }
     /**
      * Performs a special tax action.
      * The Governor takes 3 coins from the treasury (instead of 2).
@@ -30,6 +38,7 @@ namespace coup
         checkCoupMandatory();
         AddCoins(3);
         SetLastAction("tax");
+        emit(EventType::ActionPerformed, ActionType::Tax);
         GetGame().advanceTurn();
     }
     /**
@@ -53,5 +62,6 @@ namespace coup
         }
 
         target.DecreaseCoins(refund);
+        emit(EventType::Blocked, ActionType::Tax, &target);
     }
 }
@@ -17,6 +17,7 @@ namespace coup
     public:
         Governor(Game &game, const string &name); // onstructs a new Governor player.
         string GetRole() const override;          // Returns the role name: "Governor".
+        RoleType GetRoleType() const override;    // Returns RoleType::Governor.
         void tax() override;                      // Performs a special tax action that earns 3 coins instead of 2.
         void undo(Player &target);                // Cancels a tax action performed by the target player.
     };
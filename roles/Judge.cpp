@@ -1,6 +1,7 @@
 // ronamsalem4@gmail.com
 #include "Judge.hpp"
 #include "../game/Game.hpp"
+#include "../game/Logger.hpp"
 
 namespace coup
 {
@@ -18,6 +19,14 @@ namespace coup
     {
         return "Judge";
     }
+
+    /**
+     * @return ---> RoleType::Judge
+     */
+    RoleType Judge::GetRoleType() const
+    {
+        return RoleType::Judge;
+    }
     /**
      *Performs the undo action on a target player.
      * If the target is a Spy, removes 2 coins from them as a penalty.     *
@@ -29,6 +38,7 @@ namespace coup
         if (target.GetRole() != "Spy")
             throw invalid_argument("Judge cannot undo tax.");
         target.DecreaseCoins(2);
+        emit(EventType::Blocked, ActionType::Tax, &target);
     }
 
     /**
@@ -42,8 +52,9 @@ namespace coup
         if (!target.bribeStatusStatus())
             throw invalid_argument("No bribe action to block");
         target.resetBribeStatus();
-        std::cout << "Judge blocked bribe by " << target.GetName() << std::endl;
-        target.GetGame().removeExtraTurns(target.GetName()); // ביטול תורות נוספים אם היו
+        Logger::instance().log(LogLevel::Info, "Judge blocked bribe by ", target.GetNameView());
+        emit(EventType::Blocked, ActionType::Bribe, &target);
+        target.GetGame().removeExtraTurns(target.GetSeat()); // ביטול תורות נוספים אם היו
         target.GetGame().advanceTurn();
     }
 
@@ -16,6 +16,7 @@ namespace coup
     public:
         Judge(Game &game, const string &name); // Constructs a new Judge player
         string GetRole() const override;       // Returns the role name: "Judge".
+        RoleType GetRoleType() const override; // Returns RoleType::Judge.
         void undo(Player &target);             // Reverses the elimination of a target player.
         void blockBribe(Player &target);       // Blocks a bribe action performed by another player.
         void gotSanctioned(Player &aggressor); // Added method to handle sanction against judge
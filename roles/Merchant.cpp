@@ -18,6 +18,14 @@ namespace coup
     {
         return "Merchant";
     }
+
+    /**
+     * @return ---> RoleType::Merchant
+     */
+    RoleType Merchant::GetRoleType() const
+    {
+        return RoleType::Merchant;
+    }
     /**
      * Performs the gather action with Merchant's bonus.
      * If the Merchant has 3 or more coins, they receive +1 bonus coin before the regular gather.
@@ -15,6 +15,7 @@ namespace coup
     public:
         Merchant(Game &game, const string &name); // onstructs a new Merchant player.
         string GetRole() const override;          // Returns the role name: "Merchant".
+        RoleType GetRoleType() const override;    // Returns RoleType::Merchant.
         void bribe();                             // Executes the Merchant's version of the bribe action.
         void checkTurn();                         // Checks if it's currently the Merchant's turn.
         void getArrestded();                      // andles logic when the Merchant is targeted by arrest.
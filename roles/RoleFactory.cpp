@@ -0,0 +1,39 @@
+// ronamsalem4@gmail.com
+#include "RoleFactory.hpp"
+#include "Governor.hpp"
+#include "Spy.hpp"
+#include "Baron.hpp"
+#include "General.hpp"
+#include "Judge.hpp"
+#include "Merchant.hpp"
+
+namespace coup
+{
+    /**
+     * Constructs a player of the given role in the game's arena.
+     * @param game ---> The game that will own the player.
+     * @param role ---> The role to create.
+     * @param name ---> The player's name.
+     * @return ---> Reference to the new player.
+     * @throws ---> invalid_argument if the game is full.
+     */
+    Player &emplaceRole(Game &game, RoleType role, const string &name)
+    {
+        switch (role)
+        {
+        case RoleType::Governor:
+            return game.emplace<Governor>(name);
+        case RoleType::Spy:
+            return game.emplace<Spy>(name);
+        case RoleType::Baron:
+            return game.emplace<Baron>(name);
+        case RoleType::General:
+            return game.emplace<General>(name);
+        case RoleType::Judge:
+            return game.emplace<Judge>(name);
+        case RoleType::Merchant:
+            return game.emplace<Merchant>(name);
+        }
+        throw invalid_argument("Unknown role");
+    }
+}
@@ -0,0 +1,23 @@
+// ronamsalem4@gmail.com
+#ifndef ROLEFACTORY_HPP
+#define ROLEFACTORY_HPP
+#include "../game/Game.hpp"
+#include "../game/Player.hpp"
+#include "../game/RoleType.hpp"
+
+/**
+ * Creates role objects from a RoleType, for code that only knows a layout (Game::reset, saved games, simulators).
+ */
+namespace coup
+{
+    /**
+     * Constructs a player of the given role in the game's arena (see Game::emplace).
+     * @param game ---> The game that will own the player.
+     * @param role ---> The role to create.
+     * @param name ---> The player's name.
+     * @return ---> Reference to the new player.
+     */
+    Player &emplaceRole(Game &game, RoleType role, const string &name);
+}
+
+#endif
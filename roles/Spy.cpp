@@ -2,6 +2,7 @@
 
 #include "Spy.hpp"
 #include "../game/Game.hpp"
+#include "../game/Logger.hpp"
 
 namespace coup
 {
@@ -23,6 +24,14 @@ namespace coup
         return "Spy";
     }
 
+    /**
+     * @return ---> RoleType::Spy
+     */
+    RoleType Spy::GetRoleType() const
+    {
+        return RoleType::Spy;
+    }
+
     /**
      *  Blocks the target player from performing an arrest on their next turn.
      * This action does not cost coins and does not consume the Spy's turn.
@@ -34,6 +43,7 @@ namespace coup
         if (!target.Getstillingame())
             throw new invalid_argument(target.GetName() + " is not part of the game");
         target.Activateblockarrestturn();
+        emit(EventType::Blocked, ActionType::Arrest, &target);
     }
 
     /**
@@ -45,9 +55,10 @@ namespace coup
     {
         if (!target.Getstillingame())
             throw new invalid_argument(target.GetName() + " is not part of the game");
-        cout << target.GetName() << " has " << target.coins() << " coins" << endl;
+        Logger::instance().log(LogLevel::Info, target.GetNameView(), " has ", target.coins(), " coins");
 
         target.Activateblockarrestturn();
+        emit(EventType::ActionPerformed, ActionType::Watch, &target);
     }
 
 }
\ No newline at end of file
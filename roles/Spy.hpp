@@ -15,6 +15,7 @@ namespace coup
     public:
         Spy(Game &game, const string &name);              // Constructs a new Spy player.
         string GetRole() const override;                  // Returns the role name: "Spy".
+        RoleType GetRoleType() const override;            // Returns RoleType::Spy.
         void watchCoins(Player &target) const;            // target The player whose coins are being watched.
         void blockarrestfromplayer(Player &target) const; // Prevent the target player from performing an arrest on their next turn.
     };
@@ -0,0 +1,110 @@
+// ronamsalem4@gmail.com
+#include "Client.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace coup
+{
+    Client::~Client()
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    void Client::connect(uint16_t port)
+    {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+            throw runtime_error("Cannot connect to 127.0.0.1:" + to_string(port));
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    void Client::join(uint32_t table, uint8_t tableSize, RoleType role, const string &name)
+    {
+        encodeJoin(out, table, tableSize, role, name);
+        flush();
+    }
+
+    void Client::act(uint32_t tag, const Move &move)
+    {
+        encodeAct(out, tag, move);
+        flush();
+    }
+
+    void Client::observe(uint32_t table)
+    {
+        encodeObserve(out, table);
+        flush();
+    }
+
+    void Client::react(bool block)
+    {
+        encodeReact(out, block);
+        flush();
+    }
+
+    void Client::flush()
+    {
+        size_t sent = 0;
+        while (sent < out.size())
+        {
+            ssize_t n = ::send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                throw runtime_error("Connection to the server lost");
+            sent += static_cast<size_t>(n);
+        }
+        out.clear();
+    }
+
+    bool Client::receive(Message &message, int timeoutMs)
+    {
+        while (true)
+        {
+            if (size_t size = frameSize(in.data(), in.size()))
+            {
+                decode(in.data(), size, message);
+                in.erase(in.begin(), in.begin() + size);
+                return true;
+            }
+            pollfd p{fd, POLLIN, 0};
+            int ready = poll(&p, 1, timeoutMs);
+            if (ready == 0)
+                return false;
+            uint8_t buffer[4096];
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                throw runtime_error("The server closed the connection");
+            in.insert(in.end(), buffer, buffer + n);
+        }
+    }
+
+    Message Client::expect(MsgType type, int timeoutMs)
+    {
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+        Message message;
+        while (true)
+        {
+            int left = static_cast<int>(chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count());
+            if (left <= 0 || !receive(message, left))
+                throw runtime_error("Timed out waiting for a server message");
+            if (message.type == type)
+                return message;
+        }
+    }
+}
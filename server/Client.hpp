@@ -0,0 +1,56 @@
+// ronamsalem4@gmail.com
+#ifndef CLIENT_HPP
+#define CLIENT_HPP
+#include "Protocol.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class Client
+ * A blocking connection to coup_server, for tests, tools and simple bots.
+ * STATE broadcasts arrive between the answers to a client's own requests; expect() skips them.
+ */
+namespace coup
+{
+    class Client
+    {
+    public:
+        Client() = default;
+        ~Client(); // Closes the connection.
+        Client(const Client &) = delete;
+        Client &operator=(const Client &) = delete;
+
+        /**
+         * Connects to the server on 127.0.0.1.
+         * @throws ---> runtime_error if the connection fails.
+         */
+        void connect(uint16_t port);
+
+        void join(uint32_t table, uint8_t tableSize, RoleType role, const string &name); // Sends JOIN.
+        void act(uint32_t tag, const Move &move);                                       // Sends ACT.
+        void observe(uint32_t table);                                                   // Sends OBSERVE.
+        void react(bool block);                                                         // Sends REACT (answer to ASK).
+
+        /**
+         * Waits for the next message.
+         * @param timeoutMs ---> How long to wait.
+         * @return ---> false if nothing arrived in time.
+         * @throws ---> runtime_error if the server closed the connection.
+         */
+        bool receive(Message &out, int timeoutMs);
+
+        /**
+         * Waits for the next message of a type, dropping other messages on the way.
+         * @throws ---> runtime_error on timeout, or if the connection was closed.
+         */
+        Message expect(MsgType type, int timeoutMs = 2000);
+
+    private:
+        void flush();
+        int fd = -1;
+        vector<uint8_t> in;
+        vector<uint8_t> out;
+    };
+}
+
+#endif
@@ -0,0 +1,293 @@
+// ronamsalem4@gmail.com
+#include "Journal.hpp"
+#include "../game/Logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace coup
+{
+    static constexpr size_t CHECKSUM_SIZE = 4;
+
+    /**
+     * FNV-1a: cheap, and enough to tell a torn write from a whole record.
+     */
+    uint32_t checksum32(const uint8_t *data, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ data[i]) * 16777619u;
+        return hash;
+    }
+
+    void encodeRecord(vector<uint8_t> &out, const JournalRecord &record)
+    {
+        size_t start = out.size();
+        FrameWriter w(out, record.kind);
+        w.u32(record.table);
+        switch (record.kind)
+        {
+        case JournalRecord::Seat:
+            w.u8(record.size);
+            w.u8(record.seat);
+            w.u8(static_cast<uint8_t>(record.role));
+            w.text(record.name);
+            break;
+        case JournalRecord::Deal:
+            w.u64(record.seed);
+            w.u64(record.version);
+            w.u32(record.gamesPlayed);
+            break;
+        case JournalRecord::Play:
+            w.u8(record.seat);
+            w.u8(static_cast<uint8_t>(record.move.action));
+            w.u8(record.move.target);
+            w.u8(record.move.option);
+            w.u8(record.blocker);
+            break;
+        case JournalRecord::Close:
+            break;
+        }
+        w.u32(checksum32(out.data() + start + 2, out.size() - start - 2));
+    }
+
+    /**
+     * Decodes one whole record (see frameSize).
+     * @throws ---> invalid_argument if it is corrupt.
+     */
+    static void decodeRecord(const uint8_t *frame, size_t size, JournalRecord &out)
+    {
+        if (size < FRAME_HEADER + CHECKSUM_SIZE)
+            throw invalid_argument("Short record");
+        size_t body = size - 2 - CHECKSUM_SIZE;
+        FrameReader sum(frame + 2 + body, CHECKSUM_SIZE);
+        if (sum.u32() != checksum32(frame + 2, body))
+            throw invalid_argument("Bad checksum");
+
+        FrameReader r(frame + 2, body);
+        out.kind = static_cast<JournalRecord::Kind>(r.u8());
+        out.table = r.u32();
+        switch (out.kind)
+        {
+        case JournalRecord::Seat:
+        {
+            out.size = r.u8();
+            out.seat = r.u8();
+            uint8_t role = r.u8();
+            if (role >= ROLE_COUNT || out.size > Game::MAX_PLAYERS || out.seat >= out.size)
+                throw invalid_argument("Bad seat record");
+            out.role = static_cast<RoleType>(role);
+            out.name = r.text();
+            return;
+        }
+        case JournalRecord::Deal:
+            out.seed = r.u64();
+            out.version = r.u64();
+            out.gamesPlayed = r.u32();
+            return;
+        case JournalRecord::Play:
+        {
+            out.seat = r.u8();
+            uint8_t action = r.u8();
+            if (action >= ACTION_COUNT)
+                throw invalid_argument("Unknown action");
+            out.move.action = static_cast<ActionType>(action);
+            out.move.target = r.u8();
+            out.move.option = r.u8();
+            out.blocker = r.u8();
+            return;
+        }
+        case JournalRecord::Close:
+            return;
+        }
+        throw invalid_argument("Unknown record");
+    }
+
+    bool readFile(const string &path, vector<uint8_t> &out)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat info{};
+        out.clear();
+        if (fstat(fd, &info) == 0)
+            out.reserve(static_cast<size_t>(info.st_size));
+        uint8_t buffer[65536];
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof(buffer))) > 0 || (n < 0 && errno == EINTR))
+            if (n > 0)
+                out.insert(out.end(), buffer, buffer + n);
+        close(fd);
+        return true;
+    }
+
+    size_t readJournal(const string &path, const function<void(const JournalRecord &)> &visit)
+    {
+        vector<uint8_t> data;
+        if (!readFile(path, data))
+            return 0;
+
+        size_t pos = 0, count = 0;
+        JournalRecord record;
+        try
+        {
+            while (size_t size = frameSize(data.data() + pos, data.size() - pos))
+            {
+                decodeRecord(data.data() + pos, size, record);
+                pos += size;
+                ++count;
+                visit(record);
+            }
+        }
+        catch (const invalid_argument &)
+        {
+            // Torn tail: the records before it are whole, and nothing after it was ever acknowledged.
+        }
+        return count;
+    }
+
+    void writeFileSynced(const string &path, const vector<uint8_t> &data)
+    {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw runtime_error("Cannot write " + path);
+        size_t written = 0;
+        while (written < data.size())
+        {
+            ssize_t n = write(fd, data.data() + written, data.size() - written);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            written += static_cast<size_t>(n);
+        }
+        bool synced = written == data.size() && fsync(fd) == 0;
+        close(fd);
+        if (!synced)
+            throw runtime_error("Cannot write " + path);
+    }
+
+    void syncDirectory(const string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        fsync(fd);
+        close(fd);
+    }
+
+    Journal::Journal(const string &path, chrono::milliseconds commitInterval, int notifyFd)
+        : notifyFd(notifyFd), interval(commitInterval)
+    {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw runtime_error("Cannot open journal " + path);
+        committer = thread(&Journal::commitLoop, this);
+    }
+
+    Journal::~Journal()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        committer.join();
+        for (const Switch &next : switches)
+            close(next.fd); // segments nothing was written to
+        close(fd);
+    }
+
+    void Journal::append(const JournalRecord &record)
+    {
+        bool first;
+        {
+            lock_guard<mutex> guard(lock);
+            first = pending.empty();
+            encodeRecord(pending, record);
+            pendingCount = ++appendedCount;
+        }
+        if (first)
+            wake.notify_one();
+    }
+
+    void Journal::rotate(const string &path)
+    {
+        int next = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (next < 0)
+            throw runtime_error("Cannot open journal " + path);
+        lock_guard<mutex> guard(lock);
+        switches.push_back(Switch{pending.size(), next});
+    }
+
+    /**
+     * Writes all bytes; false on a write error (disk full or gone).
+     */
+    static bool writeAll(int fd, const uint8_t *data, size_t size)
+    {
+        size_t written = 0;
+        while (written < size)
+        {
+            ssize_t n = write(fd, data + written, size - written);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * Waits for a record, lets the batch grow for one interval, then writes and syncs it in one go
+     * (segment by segment when rotate() was called in between). After a failure the batches are only consumed:
+     * the segments still change files, but nothing is written and durableCount stays where it was.
+     */
+    void Journal::commitLoop()
+    {
+        vector<uint8_t> batch;
+        vector<Switch> batchSwitches;
+        unique_lock<mutex> guard(lock);
+        while (true)
+        {
+            wake.wait(guard, [this]
+                      { return stopping || !pending.empty(); });
+            if (pending.empty())
+                return; // stopping, and nothing left to commit
+            if (!stopping)
+                wake.wait_for(guard, interval, [this]
+                              { return stopping; });
+            batch.swap(pending);
+            batchSwitches.swap(switches);
+            uint64_t count = pendingCount;
+            guard.unlock();
+
+            bool ok = !failedFlag.load(memory_order_relaxed);
+            size_t from = 0;
+            for (const Switch &next : batchSwitches)
+            {
+                ok = ok && writeAll(fd, batch.data() + from, next.offset - from) && fdatasync(fd) == 0;
+                close(fd);
+                fd = next.fd;
+                from = next.offset;
+            }
+            ok = ok && writeAll(fd, batch.data() + from, batch.size() - from) && fdatasync(fd) == 0;
+            if (ok)
+            {
+                durableCount.store(count, memory_order_release);
+                uint64_t one = 1;
+                if (notifyFd >= 0 && ::write(notifyFd, &one, sizeof(one)) < 0)
+                    one = 0; // the counter is full: the shard is awake anyway
+            }
+            else if (!failedFlag.exchange(true, memory_order_release))
+                Logger::instance().log(LogLevel::Error, "Journal write failed (", strerror(errno),
+                                       "): no record is acknowledged from now on");
+            batchSwitches.clear();
+            batch.clear();
+            guard.lock();
+        }
+    }
+}
@@ -0,0 +1,128 @@
+// ronamsalem4@gmail.com
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+#include "Protocol.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file Journal.hpp
+ * The write-ahead journal of a server shard: every seat taken, deal, move and closed table, in the order the shard
+ * applied them. Records are framed like protocol messages (u16 size, u8 kind, fields) and end with a checksum, so a
+ * record torn by a crash ends the replay instead of corrupting it.
+ *
+ * Group commit: append() only copies the record into memory. A committer thread waits for the first record, lets
+ * more arrive for the commit interval, then writes the batch and fdatasync()s it once. The shard holds back the
+ * answers that depend on a record (see durable()) until its batch is on disk, and is woken through notifyFd when a
+ * batch lands. rotate() starts a new segment file at a record boundary (snapshots, see Snapshot.hpp, make the
+ * segments before them unnecessary).
+ * A failed write or sync latches the journal as failed: the batch may be torn in the middle of its segment, and a
+ * replay stops there, so nothing appended from then on can ever be durable. durable() stops advancing (the answers
+ * waiting for it stay held), later batches are discarded and the failure is logged once.
+ */
+namespace coup
+{
+    struct JournalRecord
+    {
+        enum Kind : uint8_t
+        {
+            Seat = 1, // a player took a seat: table, size, seat, role, name
+            Deal,     // a game was dealt: table, seed, version, gamesPlayed
+            Play,     // a move was played: table, move (actor, action, target, option), blocker
+            Close     // the table was removed: table
+        };
+
+        Kind kind = Seat;
+        uint32_t table = NO_TABLE;
+        uint8_t size = 0;
+        uint8_t seat = NO_SEAT; // Seat: the seat taken. Play: the actor.
+        RoleType role = RoleType::Governor;
+        string name;
+        uint64_t seed = 0;
+        uint64_t version = 0;
+        uint32_t gamesPlayed = 0;
+        Move move;
+        uint8_t blocker = NO_SEAT;
+    };
+
+    void encodeRecord(vector<uint8_t> &out, const JournalRecord &record); // Appends one record (with its checksum).
+
+    /**
+     * Reads the records of a journal file in order.
+     * @param path ---> The file.
+     * @param visit ---> Called for every whole, intact record.
+     * @return ---> Number of records read; reading stops at the first torn or corrupt record (the crash point).
+     *              A missing file has no records.
+     */
+    size_t readJournal(const string &path, const function<void(const JournalRecord &)> &visit);
+
+    uint32_t checksum32(const uint8_t *data, size_t size);  // FNV-1a, to tell torn or damaged data from whole data.
+    bool readFile(const string &path, vector<uint8_t> &out); // @return ---> false if the file cannot be opened.
+
+    /**
+     * Writes a whole file and fsync()s it (for files that are replaced by rename, like compacted journals).
+     * @throws ---> runtime_error if the file cannot be written.
+     */
+    void writeFileSynced(const string &path, const vector<uint8_t> &data);
+    void syncDirectory(const string &path); // fsync()s a directory, so the renames and removals in it are durable.
+
+    class Journal
+    {
+    public:
+        /**
+         * Opens (or creates) a journal file for appending and starts its committer thread.
+         * @param path ---> The file.
+         * @param commitInterval ---> How long a batch collects records before it is written and synced.
+         * @param notifyFd ---> An eventfd written to after every commit (-1 for none).
+         * @throws ---> runtime_error if the file cannot be opened.
+         */
+        Journal(const string &path, chrono::milliseconds commitInterval, int notifyFd);
+        ~Journal(); // Commits what is pending, then closes the file.
+        Journal(const Journal &) = delete;
+        Journal &operator=(const Journal &) = delete;
+
+        void append(const JournalRecord &record); // Queues a record for the next commit (shard thread only).
+
+        /**
+         * Starts a new segment: the records appended from now on go to another file (shard thread only).
+         * The current segment is synced and closed by the commit that reaches the switch.
+         * @throws ---> runtime_error if the file cannot be opened.
+         */
+        void rotate(const string &path);
+
+        uint64_t appended() const { return appendedCount; }                       // @return ---> Records appended so far.
+        uint64_t durable() const { return durableCount.load(memory_order_acquire); } // @return ---> Records on disk.
+        bool failed() const { return failedFlag.load(memory_order_acquire); }         // @return ---> true after a write or sync failed.
+
+    private:
+        void commitLoop();
+
+        int fd = -1;
+        int notifyFd = -1;
+        chrono::milliseconds interval;
+        uint64_t appendedCount = 0;
+        atomic<uint64_t> durableCount{0};
+        atomic<bool> failedFlag{false}; // written by the committer only
+        mutex lock; // guards pending, pendingCount and stopping
+        condition_variable wake;
+        vector<uint8_t> pending;
+        uint64_t pendingCount = 0; // appendedCount as of the last record in pending
+        struct Switch
+        {
+            size_t offset; // bytes of pending that still belong to the previous segment
+            int fd;        // the next segment
+        };
+        vector<Switch> switches; // segment changes inside pending
+        bool stopping = false;
+        thread committer;
+    };
+}
+
+#endif
@@ -0,0 +1,336 @@
+// ronamsalem4@gmail.com
+#include "LoadGen.hpp"
+#include "Server.hpp"
+#include "../sim/RandomBot.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <exception>
+#include <fcntl.h>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace coup
+{
+    using Clock = chrono::steady_clock;
+
+    struct TableRun;
+
+    /**
+     * One simulated client: a connection holding one seat.
+     */
+    struct SeatConnection
+    {
+        int fd = -1;
+        TableRun *table = nullptr;
+        bool follows = false; // this connection's STATE stream drives the table's copy of the game
+        vector<uint8_t> in, out;
+    };
+
+    /**
+     * The client side of one table: its copy of the game and the action in flight.
+     */
+    struct TableRun
+    {
+        uint32_t id;
+        uint8_t size;
+        Game mirror;
+        RandomBot bot;
+        mt19937 rng; // answers to ASK
+        SeatConnection *bySeat[Game::MAX_PLAYERS] = {};
+        bool started = false;
+        bool waitingResult = false;
+        uint32_t tag = 0;
+        uint64_t applied = 0;       // version of the last STATE replayed on the mirror
+        uint64_t sentVersion = 0;   // version the move in flight was chosen at
+        uint64_t targetVersion = 0; // the next move waits until the mirror reaches this version
+        uint32_t games = 0;
+        uint32_t movesThisGame = 0;
+        Clock::time_point sentAt;
+        TableRun(uint32_t id, uint8_t size, uint64_t seed) : id(id), size(size), bot(seed), rng(static_cast<uint32_t>(seed)) {}
+    };
+
+    /**
+     * One client event loop driving a share of the tables.
+     */
+    class LoadWorker
+    {
+    public:
+        LoadWorker(const LoadGenConfig &config, size_t index) : config(config), index(index) {}
+
+        void run()
+        {
+            try
+            {
+                setUp();
+                loop();
+            }
+            catch (...)
+            {
+                error = current_exception();
+            }
+            for (auto &c : connections)
+                close(c->fd);
+            if (epfd >= 0)
+                close(epfd);
+        }
+
+        vector<uint64_t> latencies;
+        uint64_t rejected = 0;
+        uint64_t games = 0;
+        exception_ptr error;
+
+    private:
+        void setUp()
+        {
+            epfd = epoll_create1(0);
+            mt19937_64 rng(config.seed * 0x9E3779B97F4A7C15ULL + index);
+            for (size_t t = index; t < config.tables; t += config.threads)
+            {
+                uint32_t id = config.firstTable + static_cast<uint32_t>(t);
+                tables.push_back(make_unique<TableRun>(id, config.seats, rng()));
+                for (uint8_t s = 0; s < config.seats; ++s)
+                {
+                    auto c = make_unique<SeatConnection>();
+                    c->fd = connectTo(config.port);
+                    c->table = tables.back().get();
+                    c->follows = s == 0;
+                    encodeJoin(c->out, id, config.seats, static_cast<RoleType>(rng() % ROLE_COUNT), "Bot " + to_string(s + 1));
+                    epoll_event event{};
+                    event.events = EPOLLIN;
+                    event.data.ptr = c.get();
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &event);
+                    flush(*c);
+                    connections.push_back(std::move(c));
+                }
+            }
+        }
+
+        static int connectTo(uint16_t port)
+        {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(port);
+            if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+            {
+                if (fd >= 0)
+                    close(fd);
+                throw runtime_error("Cannot connect to 127.0.0.1:" + to_string(port));
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            return fd;
+        }
+
+        void loop()
+        {
+            Clock::time_point end = Clock::now() + config.duration;
+            epoll_event events[256];
+            while (Clock::now() < end)
+            {
+                int n = epoll_wait(epfd, events, 256, 50);
+                for (int i = 0; i < n; ++i)
+                    readFrom(*static_cast<SeatConnection *>(events[i].data.ptr));
+            }
+        }
+
+        void readFrom(SeatConnection &c)
+        {
+            uint8_t buffer[16384];
+            while (true)
+            {
+                ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+                if (n > 0)
+                {
+                    c.in.insert(c.in.end(), buffer, buffer + n);
+                    continue;
+                }
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    break;
+                throw runtime_error("The server closed a connection");
+            }
+            size_t pos = 0;
+            while (size_t size = frameSize(c.in.data() + pos, c.in.size() - pos))
+            {
+                decode(c.in.data() + pos, size, message);
+                pos += size;
+                handle(c, message);
+            }
+            c.in.erase(c.in.begin(), c.in.begin() + pos);
+        }
+
+        void handle(SeatConnection &c, const Message &m)
+        {
+            TableRun &t = *c.table;
+            switch (m.type)
+            {
+            case MsgType::Joined:
+                t.bySeat[m.seat] = &c;
+                break;
+            case MsgType::Result:
+                if (!t.waitingResult || m.tag != t.tag)
+                    break;
+                t.waitingResult = false;
+                if (m.status == Status::Ok)
+                {
+                    latencies.push_back(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - t.sentAt).count()));
+                    t.targetVersion = t.sentVersion + 1; // its STATE may come before or after the RESULT
+                }
+                else
+                    ++rejected;
+                break;
+            case MsgType::State:
+                if (c.follows)
+                    replay(t, m);
+                break;
+            case MsgType::Ask:
+                encodeReact(c.out, t.rng() % 4 == 0); // block one move in four
+                flush(c);
+                break;
+            case MsgType::Error:
+                throw runtime_error(string("Server error: ") + statusName(m.status) + ", " + m.text);
+            default:
+                break;
+            }
+            act(t);
+        }
+
+        /**
+         * Brings the table's copy of the game up to the STATE: deals it, plays (and blocks) the last move, or deals the next game.
+         */
+        void replay(TableRun &t, const Message &m)
+        {
+            const GameState &s = m.state;
+            if (!t.started || s.gamesPlayed != t.games)
+            {
+                if (s.numSeats < t.size)
+                    return; // still filling up
+                vector<RoleType> roles(s.numSeats);
+                for (uint8_t i = 0; i < s.numSeats; ++i)
+                    roles[i] = s.seats[i].role;
+                if (t.started)
+                    ++games;
+                t.mirror.reset(t.id, roles);
+                t.started = true;
+                t.games = s.gamesPlayed;
+                t.applied = t.targetVersion = s.version;
+                t.movesThisGame = 0;
+                return;
+            }
+            if (s.version != t.applied + 1)
+                return;
+            applyMove(t.mirror, m.move);
+            if (m.seat != NO_SEAT)
+                applyBlock(t.mirror, m.seat, s.lastActor, m.move);
+            t.applied = s.version;
+            ++t.movesThisGame;
+        }
+
+        /**
+         * Sends the next move of the table once the last one was answered and replayed.
+         */
+        void act(TableRun &t)
+        {
+            if (!t.started || t.waitingResult || t.applied < t.targetVersion || t.mirror.isOver() ||
+                t.movesThisGame >= Server::MAX_MOVES_PER_GAME)
+                return;
+            SeatConnection *c = t.bySeat[t.mirror.turnSeat()];
+            if (c == nullptr)
+                return;
+            encodeAct(c->out, ++t.tag, t.bot.choose(t.mirror));
+            t.waitingResult = true;
+            t.sentVersion = t.applied;
+            t.sentAt = Clock::now();
+            flush(*c);
+        }
+
+        /**
+         * Frames are tiny and the socket buffers large, so a short write means the server is gone.
+         */
+        void flush(SeatConnection &c)
+        {
+            size_t sent = 0;
+            while (sent < c.out.size())
+            {
+                ssize_t n = send(c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                {
+                    this_thread::yield();
+                    continue;
+                }
+                if (n <= 0)
+                    throw runtime_error("Connection to the server lost");
+                sent += static_cast<size_t>(n);
+            }
+            c.out.clear();
+        }
+
+        const LoadGenConfig &config;
+        size_t index;
+        int epfd = -1;
+        vector<unique_ptr<TableRun>> tables;
+        vector<unique_ptr<SeatConnection>> connections;
+        Message message;
+    };
+
+    static uint64_t percentile(vector<uint64_t> &sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+        size_t i = static_cast<size_t>(p * (sorted.size() - 1));
+        return sorted[i];
+    }
+
+    LoadGenReport runLoad(const LoadGenConfig &config)
+    {
+        if (config.seats < 2 || config.seats > Game::MAX_PLAYERS)
+            throw invalid_argument("A table has 2 to 6 seats");
+        size_t threadCount = std::max<size_t>(1, std::min(config.threads, config.tables));
+        LoadGenConfig shared = config;
+        shared.threads = threadCount;
+
+        vector<unique_ptr<LoadWorker>> workers;
+        vector<thread> threads;
+        for (size_t i = 0; i < threadCount; ++i)
+            workers.push_back(make_unique<LoadWorker>(shared, i));
+        Clock::time_point start = Clock::now();
+        for (auto &worker : workers)
+            threads.emplace_back(&LoadWorker::run, worker.get());
+        for (thread &t : threads)
+            t.join();
+
+        LoadGenReport report;
+        report.seconds = chrono::duration<double>(Clock::now() - start).count();
+        report.connections = config.tables * config.seats;
+        vector<uint64_t> all;
+        for (auto &worker : workers)
+        {
+            if (worker->error)
+                rethrow_exception(worker->error);
+            all.insert(all.end(), worker->latencies.begin(), worker->latencies.end());
+            report.rejected += worker->rejected;
+            report.games += worker->games;
+        }
+        sort(all.begin(), all.end());
+        report.actions = all.size();
+        report.p50Ns = percentile(all, 0.50);
+        report.p99Ns = percentile(all, 0.99);
+        report.p999Ns = percentile(all, 0.999);
+        report.maxNs = all.empty() ? 0 : all.back();
+        return report;
+    }
+}
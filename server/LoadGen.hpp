@@ -0,0 +1,48 @@
+// ronamsalem4@gmail.com
+#ifndef LOADGEN_HPP
+#define LOADGEN_HPP
+#include "Protocol.hpp"
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @file LoadGen.hpp
+ * Load generator for coup_server: fills many tables with simulated clients (one connection per seat) that play
+ * random legal moves (and block one move in four when asked), and measures throughput and the end-to-end latency
+ * of every action (ACT sent -> RESULT read).
+ * Each table keeps a copy of its game on the client side, replayed from the STATE messages through the engine, so
+ * the clients choose their moves with the real rules (legalMoves) and should never be rejected.
+ */
+namespace coup
+{
+    struct LoadGenConfig
+    {
+        uint16_t port = 7777;
+        size_t tables = 250;                     // Tables to fill; connections = tables * seats.
+        uint8_t seats = 4;                       // Seats per table (2..6).
+        size_t threads = 1;                      // Client event loops; each one drives whole tables.
+        chrono::milliseconds duration{5000};     // How long to measure, after every table was joined.
+        uint32_t firstTable = 1;                 // Id of the first table (use another range per run or client).
+        uint64_t seed = 1;                       // Seed of the roles and the moves.
+    };
+
+    struct LoadGenReport
+    {
+        size_t connections = 0;
+        uint64_t actions = 0;  // ACTs the server accepted during the measurement.
+        uint64_t rejected = 0; // ACTs answered with anything but Ok (a client's copy of a game went out of sync).
+        uint64_t games = 0;    // Games finished during the measurement.
+        double seconds = 0;
+        uint64_t p50Ns = 0, p99Ns = 0, p999Ns = 0, maxNs = 0; // Latency of the accepted actions.
+
+        double actionsPerSecond() const { return seconds > 0 ? actions / seconds : 0; }
+    };
+
+    /**
+     * Connects, joins every table, plays until the duration is over and closes the connections.
+     * @throws ---> runtime_error if the server cannot be reached.
+     */
+    LoadGenReport runLoad(const LoadGenConfig &config);
+}
+
+#endif
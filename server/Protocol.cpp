@@ -0,0 +1,212 @@
+// ronamsalem4@gmail.com
+#include "Protocol.hpp"
+#include <stdexcept>
+
+namespace coup
+{
+    const char *statusName(Status status)
+    {
+        switch (status)
+        {
+        case Status::Ok:
+            return "ok";
+        case Status::BadRequest:
+            return "bad request";
+        case Status::TableFull:
+            return "table full";
+        case Status::AlreadySeated:
+            return "already seated";
+        case Status::NotSeated:
+            return "not seated";
+        case Status::NotStarted:
+            return "table not started";
+        case Status::NotYourTurn:
+            return "not your turn";
+        case Status::IllegalMove:
+            return "illegal move";
+        case Status::NotAsked:
+            return "nothing to answer";
+        }
+        return "unknown";
+    }
+
+    void encodeJoin(vector<uint8_t> &out, uint32_t table, uint8_t tableSize, RoleType role, const string &name)
+    {
+        FrameWriter w(out, MsgType::Join);
+        w.u32(table);
+        w.u8(tableSize);
+        w.u8(static_cast<uint8_t>(role));
+        w.text(name);
+    }
+
+    void encodeAct(vector<uint8_t> &out, uint32_t tag, const Move &move)
+    {
+        FrameWriter w(out, MsgType::Act);
+        w.u32(tag);
+        w.u8(static_cast<uint8_t>(move.action));
+        w.u8(move.target);
+        w.u8(move.option);
+    }
+
+    void encodeObserve(vector<uint8_t> &out, uint32_t table)
+    {
+        FrameWriter w(out, MsgType::Observe);
+        w.u32(table);
+    }
+
+    void encodeReact(vector<uint8_t> &out, bool block)
+    {
+        FrameWriter w(out, MsgType::React);
+        w.u8(block ? 1 : 0);
+    }
+
+    void encodeJoined(vector<uint8_t> &out, uint32_t table, uint8_t seat)
+    {
+        FrameWriter w(out, MsgType::Joined);
+        w.u32(table);
+        w.u8(seat);
+    }
+
+    void encodeResult(vector<uint8_t> &out, uint32_t tag, Status status)
+    {
+        FrameWriter w(out, MsgType::Result);
+        w.u32(tag);
+        w.u8(static_cast<uint8_t>(status));
+    }
+
+    void encodeState(vector<uint8_t> &out, uint32_t table, const GameState &state, uint8_t lastOption, uint8_t lastBlocker)
+    {
+        FrameWriter w(out, MsgType::State);
+        w.u32(table);
+        w.u64(state.version);
+        w.u32(state.gamesPlayed);
+        w.u8(state.numSeats);
+        w.u8(state.turn);
+        w.u8(state.winner);
+        w.u8(static_cast<uint8_t>(state.lastAction));
+        w.u8(state.lastActor);
+        w.u8(state.lastTarget);
+        w.u8(lastOption);
+        w.u8(lastBlocker);
+        for (uint8_t s = 0; s < state.numSeats; ++s)
+        {
+            w.u8(static_cast<uint8_t>(state.seats[s].role));
+            w.u8(state.seats[s].alive ? 1 : 0);
+            w.u16(static_cast<uint16_t>(state.seats[s].coins));
+        }
+    }
+
+    void encodeAsk(vector<uint8_t> &out, uint32_t table, uint8_t actor, const Move &move)
+    {
+        FrameWriter w(out, MsgType::Ask);
+        w.u32(table);
+        w.u8(actor);
+        w.u8(static_cast<uint8_t>(move.action));
+        w.u8(move.target);
+        w.u8(move.option);
+    }
+
+    void encodeError(vector<uint8_t> &out, Status status, const string &text)
+    {
+        FrameWriter w(out, MsgType::Error);
+        w.u8(static_cast<uint8_t>(status));
+        w.text(text);
+    }
+
+    size_t frameSize(const uint8_t *data, size_t available)
+    {
+        if (available < 2)
+            return 0;
+        size_t size = 2 + (data[0] | (static_cast<size_t>(data[1]) << 8));
+        if (size < FRAME_HEADER || size > MAX_FRAME_SIZE)
+            throw invalid_argument("Bad frame size");
+        return available < size ? 0 : size;
+    }
+
+    void decode(const uint8_t *frame, size_t size, Message &out)
+    {
+        FrameReader r(frame + 2, size - 2);
+        out.type = static_cast<MsgType>(r.u8());
+        switch (out.type)
+        {
+        case MsgType::Join:
+        {
+            out.table = r.u32();
+            out.tableSize = r.u8();
+            uint8_t role = r.u8();
+            if (role >= ROLE_COUNT)
+                throw invalid_argument("Unknown role");
+            out.role = static_cast<RoleType>(role);
+            out.text = r.text();
+            return;
+        }
+        case MsgType::Act:
+        {
+            out.tag = r.u32();
+            uint8_t action = r.u8();
+            if (action >= ACTION_COUNT)
+                throw invalid_argument("Unknown action");
+            out.move.action = static_cast<ActionType>(action);
+            out.move.target = r.u8();
+            out.move.option = r.u8();
+            return;
+        }
+        case MsgType::Observe:
+            out.table = r.u32();
+            return;
+        case MsgType::React:
+            out.block = r.u8() != 0;
+            return;
+        case MsgType::Joined:
+            out.table = r.u32();
+            out.seat = r.u8();
+            return;
+        case MsgType::Result:
+            out.tag = r.u32();
+            out.status = static_cast<Status>(r.u8());
+            return;
+        case MsgType::State:
+        {
+            out.table = r.u32();
+            GameState &state = out.state;
+            state.version = r.u64();
+            state.gamesPlayed = r.u32();
+            state.numSeats = r.u8();
+            if (state.numSeats > Game::MAX_PLAYERS)
+                throw invalid_argument("Too many seats");
+            state.turn = r.u8();
+            state.winner = r.u8();
+            state.lastAction = static_cast<ActionType>(r.u8());
+            state.lastActor = r.u8();
+            state.lastTarget = r.u8();
+            out.move = Move{state.lastAction, state.lastTarget, r.u8()};
+            out.seat = r.u8();
+            for (uint8_t s = 0; s < state.numSeats; ++s)
+            {
+                state.seats[s].role = static_cast<RoleType>(r.u8() % ROLE_COUNT);
+                state.seats[s].alive = r.u8() != 0;
+                state.seats[s].coins = static_cast<int16_t>(r.u16());
+                state.seats[s].name[0] = '\0';
+            }
+            return;
+        }
+        case MsgType::Ask:
+        {
+            out.table = r.u32();
+            out.seat = r.u8();
+            uint8_t action = r.u8();
+            if (action >= ACTION_COUNT)
+                throw invalid_argument("Unknown action");
+            out.move.action = static_cast<ActionType>(action);
+            out.move.target = r.u8();
+            out.move.option = r.u8();
+            return;
+        }
+        case MsgType::Error:
+            out.status = static_cast<Status>(r.u8());
+            out.text = r.text();
+            return;
+        }
+        throw invalid_argument("Unknown message type");
+    }
+}
@@ -0,0 +1,221 @@
+// ronamsalem4@gmail.com
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+#include "../sim/GameState.hpp"
+#include "../game/Moves.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * @file Protocol.hpp
+ * The binary protocol of coup_server.
+ * Every message is a frame: u16 size (bytes that follow), u8 type, then the payload. Integers are little-endian.
+ *
+ * Client -> server:
+ *   JOIN    u32 table, u8 tableSize (2..6), u8 role, u8 nameLength, name   (sit down; the game starts when the table is full)
+ *   ACT     u32 tag, u8 action, u8 target, u8 option                     (a turn move of the seat this connection holds)
+ *   OBSERVE u32 table                                                    (receive every STATE of a table without a seat)
+ *   REACT   u8 block                                                     (answer to ASK: 1 blocks the move, 0 lets it be)
+ * Server -> client:
+ *   JOINED  u32 table, u8 seat
+ *   RESULT  u32 tag, u8 status                                           (answer to ACT, tag echoed)
+ *   STATE   u32 table, u64 version, u32 gamesPlayed, u8 numSeats, u8 turn, u8 winner,
+ *           u8 lastAction, u8 lastActor, u8 lastTarget, u8 lastOption, u8 lastBlocker,
+ *           numSeats x (u8 role, u8 alive, i16 coins)
+ *           (the last move is complete, so a client can replay it on its own copy of the game: applyMove, then
+ *           applyBlock if lastBlocker is a seat)
+ *   ASK     u32 table, u8 actor, u8 action, u8 target, u8 option         (the seat may block this move: answer with REACT)
+ *   ERROR   u8 status, u8 length, text
+ * A connection holds at most one seat or observes one table.
+ */
+namespace coup
+{
+    enum class MsgType : uint8_t
+    {
+        Join = 1,
+        Act = 2,
+        Observe = 3,
+        React = 4,
+        Joined = 64,
+        Result = 65,
+        State = 66,
+        Error = 67,
+        Ask = 68
+    };
+
+    enum class Status : uint8_t
+    {
+        Ok = 0,
+        BadRequest,    // malformed frame or field out of range
+        TableFull,     // every seat of the table is taken (or its size differs)
+        AlreadySeated, // the connection already holds a seat or observes a table
+        NotSeated,     // ACT from a connection without a seat
+        NotStarted,    // the table is still waiting for players
+        NotYourTurn,
+        IllegalMove,   // not one of legalMoves()
+        NotAsked       // REACT from a seat that has no move to answer
+    };
+
+    const char *statusName(Status status); // @return ---> A short description of the status, for logs and errors.
+
+    constexpr size_t FRAME_HEADER = 3;       // u16 size + u8 type.
+    constexpr size_t MAX_FRAME_SIZE = 512;   // Largest frame either side accepts (header included).
+    constexpr uint32_t NO_TABLE = 0xFFFFFFFF;
+
+    /**
+     * A decoded message. Only the fields of its type are meaningful.
+     */
+    struct Message
+    {
+        MsgType type = MsgType::Error;
+        uint32_t table = NO_TABLE;
+        uint32_t tag = 0;
+        uint8_t seat = NO_SEAT; // JOINED: the seat taken; ASK: the actor; STATE: the blocker of the last move.
+        uint8_t tableSize = 0;
+        RoleType role = RoleType::Governor;
+        Status status = Status::Ok;
+        Move move;          // ACT: the move; STATE: the last move played; ASK: the move to answer.
+        bool block = false; // REACT: the answer.
+        string text; // JOIN: the player's name; ERROR: the reason.
+        GameState state;
+    };
+
+    /**
+     * Little-endian field writer: the constructor reserves the frame header and the destructor fills in its size.
+     * The server's journal (Journal.hpp) writes its records with the same framing.
+     */
+    class FrameWriter
+    {
+    public:
+        FrameWriter(vector<uint8_t> &out, uint8_t type) : out(out), start(out.size())
+        {
+            out.resize(start + FRAME_HEADER);
+            out[start + 2] = type;
+        }
+        FrameWriter(vector<uint8_t> &out, MsgType type) : FrameWriter(out, static_cast<uint8_t>(type)) {}
+        ~FrameWriter()
+        {
+            size_t size = out.size() - start - 2;
+            out[start] = static_cast<uint8_t>(size);
+            out[start + 1] = static_cast<uint8_t>(size >> 8);
+        }
+        void u8(uint8_t v) { out.push_back(v); }
+        void u16(uint16_t v)
+        {
+            u8(static_cast<uint8_t>(v));
+            u8(static_cast<uint8_t>(v >> 8));
+        }
+        void u32(uint32_t v)
+        {
+            u16(static_cast<uint16_t>(v));
+            u16(static_cast<uint16_t>(v >> 16));
+        }
+        void u64(uint64_t v)
+        {
+            u32(static_cast<uint32_t>(v));
+            u32(static_cast<uint32_t>(v >> 32));
+        }
+        void text(const string &s)
+        {
+            size_t n = s.size() < 255 ? s.size() : 255;
+            u8(static_cast<uint8_t>(n));
+            out.insert(out.end(), s.begin(), s.begin() + n);
+        }
+        void bytes(const void *data, size_t n)
+        {
+            const uint8_t *b = static_cast<const uint8_t *>(data);
+            out.insert(out.end(), b, b + n);
+        }
+
+    private:
+        vector<uint8_t> &out;
+        size_t start;
+    };
+
+    /**
+     * Little-endian field reader over one frame's payload; throws instead of reading past its end.
+     */
+    class FrameReader
+    {
+    public:
+        FrameReader(const uint8_t *data, size_t size) : p(data), left(size) {}
+        uint8_t u8()
+        {
+            need(1);
+            --left;
+            return *p++;
+        }
+        uint16_t u16()
+        {
+            uint16_t lo = u8();
+            return static_cast<uint16_t>(lo | (u8() << 8));
+        }
+        uint32_t u32()
+        {
+            uint32_t lo = u16();
+            return lo | (static_cast<uint32_t>(u16()) << 16);
+        }
+        uint64_t u64()
+        {
+            uint64_t lo = u32();
+            return lo | (static_cast<uint64_t>(u32()) << 32);
+        }
+        string text()
+        {
+            size_t n = u8();
+            need(n);
+            string s(reinterpret_cast<const char *>(p), n);
+            p += n;
+            left -= n;
+            return s;
+        }
+        void bytes(void *data, size_t n)
+        {
+            need(n);
+            memcpy(data, p, n);
+            p += n;
+            left -= n;
+        }
+
+    private:
+        void need(size_t n) const
+        {
+            if (left < n)
+                throw invalid_argument("Truncated frame");
+        }
+        const uint8_t *p;
+        size_t left;
+    };
+
+    /**
+     * Appends one frame to a buffer (nothing is allocated beyond the buffer's growth).
+     */
+    void encodeJoin(vector<uint8_t> &out, uint32_t table, uint8_t tableSize, RoleType role, const string &name);
+    void encodeAct(vector<uint8_t> &out, uint32_t tag, const Move &move);
+    void encodeObserve(vector<uint8_t> &out, uint32_t table);
+    void encodeReact(vector<uint8_t> &out, bool block);
+    void encodeJoined(vector<uint8_t> &out, uint32_t table, uint8_t seat);
+    void encodeResult(vector<uint8_t> &out, uint32_t tag, Status status);
+    void encodeState(vector<uint8_t> &out, uint32_t table, const GameState &state, uint8_t lastOption, uint8_t lastBlocker);
+    void encodeAsk(vector<uint8_t> &out, uint32_t table, uint8_t actor, const Move &move);
+    void encodeError(vector<uint8_t> &out, Status status, const string &text);
+
+    /**
+     * Size of the first frame in a buffer.
+     * @return ---> The frame's total size (header included), or 0 if the buffer does not hold a whole frame yet.
+     * @throws ---> invalid_argument if the frame is larger than MAX_FRAME_SIZE or empty.
+     */
+    size_t frameSize(const uint8_t *data, size_t available);
+
+    /**
+     * Decodes one whole frame (see frameSize).
+     * @throws ---> invalid_argument if the frame is malformed.
+     */
+    void decode(const uint8_t *frame, size_t size, Message &out);
+}
+
+#endif
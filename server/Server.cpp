@@ -0,0 +1,1080 @@
+// ronamsalem4@gmail.com
+#include "Server.hpp"
+#include "../game/Logger.hpp"
+#include "../game/Player.hpp"
+#include "../roles/RoleFactory.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace coup
+{
+    /**
+     * Opens the listening socket on 127.0.0.1 and one epoll instance per shard (nothing runs before start()).
+     */
+    Server::Server(uint16_t port, size_t shardCount, chrono::milliseconds reactionTimeout, const string &journalDir,
+                   chrono::milliseconds snapshotInterval)
+        : reactionTimeout(reactionTimeout), journalDir(journalDir), snapshotInterval(snapshotInterval)
+    {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (listenFd < 0)
+            throw runtime_error("socket() failed");
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(listenFd, 4096) < 0)
+        {
+            close(listenFd);
+            throw runtime_error("Cannot listen on 127.0.0.1:" + to_string(port));
+        }
+        socklen_t length = sizeof(address);
+        getsockname(listenFd, reinterpret_cast<sockaddr *>(&address), &length);
+        boundPort = ntohs(address.sin_port);
+
+        for (size_t i = 0; i < (shardCount == 0 ? 1 : shardCount); ++i)
+        {
+            auto shard = make_unique<Shard>();
+            shard->epfd = epoll_create1(0);
+            shard->wakeFd = eventfd(0, EFD_NONBLOCK);
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = shard->wakeFd;
+            epoll_ctl(shard->epfd, EPOLL_CTL_ADD, shard->wakeFd, &event);
+            event.events = EPOLLIN | EPOLLEXCLUSIVE; // one shard is woken per incoming connection
+            event.data.fd = listenFd;
+            epoll_ctl(shard->epfd, EPOLL_CTL_ADD, listenFd, &event);
+            shards.push_back(std::move(shard));
+        }
+        if (!journalDir.empty())
+            recover();
+    }
+
+    Server::~Server()
+    {
+        stop();
+        for (auto &shard : shards)
+        {
+            if (shard->snapshotWriter.joinable())
+                shard->snapshotWriter.join();
+            for (auto &entry : shard->connections)
+                close(entry.first);
+            for (Connection &connection : shard->inbox)
+                close(connection.fd);
+            close(shard->wakeFd);
+            close(shard->epfd);
+        }
+        close(listenFd);
+    }
+
+    void Server::start()
+    {
+        if (running.exchange(true))
+            return;
+        for (size_t i = 0; i < shards.size(); ++i)
+            shards[i]->worker = thread(&Server::run, this, i);
+    }
+
+    void Server::stop()
+    {
+        if (!running.exchange(false))
+            return;
+        uint64_t one = 1;
+        for (auto &shard : shards)
+            if (write(shard->wakeFd, &one, sizeof(one)) < 0)
+                continue; // the counter is full: the shard is awake anyway
+        for (auto &shard : shards)
+            shard->worker.join();
+    }
+
+    uint64_t Server::actions() const
+    {
+        uint64_t total = 0;
+        for (const auto &shard : shards)
+            total += shard->actions.load(memory_order_relaxed);
+        return total;
+    }
+
+    uint64_t Server::connections() const
+    {
+        uint64_t total = 0;
+        for (const auto &shard : shards)
+            total += shard->open.load(memory_order_relaxed);
+        return total;
+    }
+
+    uint64_t Server::games() const
+    {
+        uint64_t total = 0;
+        for (const auto &shard : shards)
+            total += shard->games.load(memory_order_relaxed);
+        return total;
+    }
+
+    size_t Server::tables() const
+    {
+        size_t total = 0;
+        for (const auto &shard : shards)
+            total += shard->tables.size();
+        return total;
+    }
+
+    uint64_t Server::snapshots() const
+    {
+        return snapshotCount.load(memory_order_relaxed);
+    }
+
+    /**
+     * The event loop of one shard: new connections, connections handed over by other shards, reads and writes,
+     * reaction deadlines, journal commits and snapshots.
+     */
+    void Server::run(size_t index)
+    {
+        Shard &shard = *shards[index];
+        epoll_event events[128];
+        while (running.load(memory_order_relaxed))
+        {
+            int timeout = 100;
+            if (!shard.timers.empty())
+            {
+                auto left = chrono::ceil<chrono::milliseconds>(shard.timers.top().first - chrono::steady_clock::now());
+                timeout = static_cast<int>(std::clamp<chrono::milliseconds::rep>(left.count(), 0, timeout));
+            }
+            if (shard.capturing)
+                timeout = 0; // a snapshot slice is waiting
+            int n = epoll_wait(shard.epfd, events, 128, timeout);
+            for (int i = 0; i < n; ++i)
+            {
+                int fd = events[i].data.fd;
+                if (fd == listenFd)
+                {
+                    acceptAll(index);
+                    continue;
+                }
+                if (fd == shard.wakeFd)
+                {
+                    uint64_t count;
+                    if (read(shard.wakeFd, &count, sizeof(count)) < 0)
+                        count = 0;
+                    vector<Connection> arrived;
+                    {
+                        lock_guard<mutex> lock(shard.inboxLock);
+                        arrived.swap(shard.inbox);
+                    }
+                    for (Connection &connection : arrived)
+                        adopt(index, std::move(connection));
+                    releaseHeld(shard);
+                    continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+                    readFrom(index, fd);
+                auto it = shard.connections.find(fd); // reading may have dropped or handed over the connection
+                if (it != shard.connections.end() && (events[i].events & EPOLLOUT))
+                    send(shard, it->second);
+            }
+            expireReactions(shard);
+            snapshotStep(index);
+        }
+    }
+
+    void Server::acceptAll(size_t index)
+    {
+        while (true)
+        {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0)
+                return; // EAGAIN: another shard took it, or nothing left
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            Connection connection;
+            connection.fd = fd;
+            adopt(index, std::move(connection));
+        }
+    }
+
+    /**
+     * Registers a connection with this shard (new, or handed over with bytes it has not parsed yet).
+     */
+    void Server::adopt(size_t index, Connection &&connection)
+    {
+        Shard &shard = *shards[index];
+        int fd = connection.fd;
+        bool pending = !connection.in.empty();
+        connection.writing = false;
+        connection.held = false; // a connection changes shards before it has a table, so it waits for no record
+        connection.waitsFor = 0;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(shard.epfd, EPOLL_CTL_ADD, fd, &event);
+        shard.connections.emplace(fd, std::move(connection));
+        shard.open.fetch_add(1, memory_order_relaxed);
+        if (pending)
+            readFrom(index, fd);
+    }
+
+    /**
+     * Reads what the socket has and handles every whole frame.
+     * A JOIN / OBSERVE for a table of another shard moves the connection there, with the frame still unparsed.
+     */
+    void Server::readFrom(size_t index, int fd)
+    {
+        Shard &shard = *shards[index];
+        auto it = shard.connections.find(fd);
+        if (it == shard.connections.end())
+            return;
+        Connection &connection = it->second;
+        uint8_t buffer[16384];
+        while (true)
+        {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n > 0)
+            {
+                connection.in.insert(connection.in.end(), buffer, buffer + n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            drop(shard, fd); // closed by the peer, or an error
+            return;
+        }
+
+        size_t pos = 0;
+        Message message;
+        try
+        {
+            while (size_t size = frameSize(connection.in.data() + pos, connection.in.size() - pos))
+            {
+                decode(connection.in.data() + pos, size, message);
+                if ((message.type == MsgType::Join || message.type == MsgType::Observe) && connection.table == NO_TABLE &&
+                    shardOf(message.table) != index)
+                {
+                    connection.in.erase(connection.in.begin(), connection.in.begin() + pos);
+                    send(shard, connection);
+                    handOver(index, fd, shardOf(message.table));
+                    return;
+                }
+                pos += size;
+                handle(shard, connection, message);
+            }
+        }
+        catch (const invalid_argument &e)
+        {
+            // A malformed frame ends the connection: the rest of its stream cannot be trusted.
+            encodeError(connection.out, Status::BadRequest, e.what());
+            send(shard, connection);
+            drop(shard, fd);
+            return;
+        }
+        connection.in.erase(connection.in.begin(), connection.in.begin() + pos);
+        send(shard, connection);
+    }
+
+    void Server::handle(Shard &shard, Connection &connection, const Message &message)
+    {
+        switch (message.type)
+        {
+        case MsgType::Join:
+            join(shard, connection, message);
+            break;
+        case MsgType::Act:
+            act(shard, connection, message);
+            break;
+        case MsgType::React:
+            react(shard, connection, message);
+            break;
+        case MsgType::Observe:
+            observe(shard, connection, message);
+            break;
+        default:
+            encodeError(connection.out, Status::BadRequest, "Not a client message");
+            break;
+        }
+    }
+
+    /**
+     * Seats the connection at a table (creating the table on its first JOIN); a full table deals its first game.
+     */
+    void Server::join(Shard &shard, Connection &connection, const Message &message)
+    {
+        if (connection.table != NO_TABLE)
+        {
+            encodeError(connection.out, Status::AlreadySeated, "This connection already has a table");
+            return;
+        }
+        if (message.tableSize < 2 || message.tableSize > Game::MAX_PLAYERS || message.table == NO_TABLE)
+        {
+            encodeError(connection.out, Status::BadRequest, "A table has 2 to 6 seats");
+            return;
+        }
+        unique_ptr<Table> &slot = shard.tables[message.table];
+        if (!slot)
+        {
+            slot = make_unique<Table>();
+            slot->size = message.tableSize;
+            slot->snapshotEpoch = shard.epoch; // a snapshot running now started before the table existed
+        }
+        Table &table = *slot;
+        if (table.size == message.tableSize && table.roles.size() == table.size)
+        {
+            // A full table gives a free seat back to its player (after a restart or a lost connection).
+            for (uint8_t seat = 0; seat < table.size; ++seat)
+                if (table.seatFd[seat] < 0 && table.game.getPlayer(seat).GetName() == message.text)
+                {
+                    table.seatFd[seat] = connection.fd;
+                    connection.table = message.table;
+                    connection.seat = seat;
+                    encodeJoined(connection.out, message.table, seat);
+                    broadcast(shard, message.table, table);
+                    return;
+                }
+        }
+        if (table.size != message.tableSize || table.roles.size() >= table.size)
+        {
+            encodeError(connection.out, Status::TableFull, "Table " + to_string(message.table) + " is full");
+            return;
+        }
+
+        uint8_t seat = static_cast<uint8_t>(table.roles.size());
+        string name = message.text.empty() ? "Player " + to_string(seat + 1) : message.text;
+        preserve(shard, message.table, table);
+        table.roles.push_back(message.role);
+        emplaceRole(table.game, message.role, name);
+        table.seatFd[seat] = connection.fd;
+        connection.table = message.table;
+        connection.seat = seat;
+        JournalRecord entry;
+        entry.kind = JournalRecord::Seat;
+        entry.table = message.table;
+        entry.size = table.size;
+        entry.seat = seat;
+        entry.role = message.role;
+        entry.name = name;
+        record(shard, entry);
+        encodeJoined(connection.out, message.table, seat);
+        if (table.roles.size() == table.size)
+        {
+            entry = JournalRecord{};
+            entry.kind = JournalRecord::Deal;
+            entry.table = message.table;
+            entry.seed = table.game.getSeed();
+            entry.version = table.state.version;
+            entry.gamesPlayed = table.state.gamesPlayed;
+            record(shard, entry);
+            table.loop = play(shard, message.table, table);
+        }
+        broadcast(shard, message.table, table);
+    }
+
+    /**
+     * Hands a move of the seat whose turn it is to the table loop, and answers with RESULT.
+     * The move is played (and the new STATE sent) once every player who may block it has answered.
+     */
+    void Server::act(Shard &shard, Connection &connection, const Message &message)
+    {
+        Status status = Status::Ok;
+        auto it = shard.tables.find(connection.table);
+        Table *table = (connection.seat == NO_SEAT || it == shard.tables.end()) ? nullptr : it->second.get();
+        if (table == nullptr)
+            status = Status::NotSeated;
+        else if (table->roles.size() < table->size)
+            status = Status::NotStarted;
+        else if (table->decision.kind != Decision::Turn || table->decision.seat != connection.seat)
+            status = Status::NotYourTurn;
+        else if (!legalMoves(table->game).contains(message.move))
+            status = Status::IllegalMove;
+        encodeResult(connection.out, message.tag, status);
+        if (status != Status::Ok)
+            return;
+
+        shard.actions.fetch_add(1, memory_order_relaxed);
+        table->decision.move = message.move;
+        resume(shard, connection.table, *table);
+    }
+
+    /**
+     * Answers the block question the table loop is waiting for.
+     */
+    void Server::react(Shard &shard, Connection &connection, const Message &message)
+    {
+        auto it = shard.tables.find(connection.table);
+        Table *table = (connection.seat == NO_SEAT || it == shard.tables.end()) ? nullptr : it->second.get();
+        if (table == nullptr || table->decision.kind != Decision::Reaction || table->decision.seat != connection.seat)
+        {
+            encodeError(connection.out, Status::NotAsked, "No move to answer");
+            return;
+        }
+        table->decision.block = message.block;
+        resume(shard, connection.table, *table);
+    }
+
+    /**
+     * The games of a table, one move at a time: wait for the move of the seat whose turn it is, ask every player
+     * who may block it (in turn order, the first block wins), play it, and deal the next game when one ends.
+     */
+    TableLoop Server::play(Shard &shard, uint32_t tableId, Table &table)
+    {
+        GameState &state = table.state;
+        while (true)
+        {
+            uint8_t actor = static_cast<uint8_t>(table.game.turnSeat());
+            Move move = (co_await table.decision.expect(Decision::Turn, actor)).move;
+
+            uint8_t blocker = NO_SEAT;
+            for (uint8_t k = 1; k < table.size && blocker == NO_SEAT; ++k)
+            {
+                uint8_t seat = static_cast<uint8_t>((actor + k) % table.size);
+                auto connection = shard.connections.find(table.seatFd[seat]);
+                if (!canBlock(table.game, seat, move) || connection == shard.connections.end())
+                    continue;
+                Decision::Wait reaction = table.decision.expect(Decision::Reaction, seat, move);
+                table.decision.deadline = chrono::steady_clock::now() + reactionTimeout;
+                shard.timers.emplace(table.decision.deadline, tableId);
+                encodeAsk(connection->second.out, tableId, actor, move);
+                send(shard, connection->second);
+                if ((co_await reaction).block)
+                    blocker = seat;
+            }
+
+            preserve(shard, tableId, table);
+            applyMove(table.game, move); // still legal: nothing changed while the players answered
+            if (blocker != NO_SEAT)
+            {
+                try
+                {
+                    applyBlock(table.game, blocker, actor, move);
+                }
+                catch (const invalid_argument &)
+                {
+                    blocker = NO_SEAT; // the rules refused the block (say, a tax that can no longer be undone)
+                }
+            }
+            ++state.version;
+            ++table.movesThisGame;
+            state.lastAction = move.action;
+            state.lastActor = actor;
+            state.lastTarget = move.target;
+            table.lastOption = move.option;
+            table.lastBlocker = blocker;
+            JournalRecord entry;
+            entry.kind = JournalRecord::Play;
+            entry.table = tableId;
+            entry.seat = actor;
+            entry.move = move;
+            entry.blocker = blocker;
+            record(shard, entry);
+            broadcast(shard, tableId, table);
+
+            if (table.game.isOver() || table.movesThisGame >= MAX_MOVES_PER_GAME)
+                deal(shard, tableId, table); // the STATE just sent showed the winner
+        }
+    }
+
+    /**
+     * Deals the next game to the same seats.
+     */
+    void Server::deal(Shard &shard, uint32_t tableId, Table &table)
+    {
+        preserve(shard, tableId, table);
+        GameState &state = table.state;
+        shard.games.fetch_add(1, memory_order_relaxed);
+        ++state.gamesPlayed;
+        table.game.reset(table.game.getSeed() + 1, table.roles);
+        table.movesThisGame = 0;
+        state.lastAction = ActionType::None;
+        state.lastActor = NO_SEAT;
+        state.lastTarget = NO_SEAT;
+        table.lastOption = 0;
+        table.lastBlocker = NO_SEAT;
+        JournalRecord entry;
+        entry.kind = JournalRecord::Deal;
+        entry.table = tableId;
+        entry.seed = table.game.getSeed();
+        entry.version = state.version;
+        entry.gamesPlayed = state.gamesPlayed;
+        record(shard, entry);
+        broadcast(shard, tableId, table);
+    }
+
+    /**
+     * Resumes the table loop with the answer stored in its Decision.
+     * A loop ended by an exception (a bug in the rules, not in a client) is logged and the table deals a new game.
+     */
+    void Server::resume(Shard &shard, uint32_t tableId, Table &table)
+    {
+        table.decision.resume();
+        if (exception_ptr error = table.loop.failed())
+        {
+            try
+            {
+                rethrow_exception(error);
+            }
+            catch (const exception &e)
+            {
+                Logger::instance().log(LogLevel::Error, "Table ", tableId, " failed: ", e.what());
+            }
+            table.decision = Decision{};
+            deal(shard, tableId, table);
+            table.loop = play(shard, tableId, table);
+        }
+    }
+
+    /**
+     * Lets the players who did not answer in time pass on the moves they were asked about.
+     */
+    void Server::expireReactions(Shard &shard)
+    {
+        auto now = chrono::steady_clock::now();
+        while (!shard.timers.empty() && shard.timers.top().first <= now)
+        {
+            Shard::Timer timer = shard.timers.top();
+            shard.timers.pop();
+            auto it = shard.tables.find(timer.second);
+            if (it == shard.tables.end())
+                continue;
+            Decision &decision = it->second->decision;
+            if (decision.kind == Decision::Reaction && decision.deadline == timer.first)
+                resume(shard, timer.second, *it->second); // block is still false
+        }
+    }
+
+    /**
+     * Lets the connection receive every STATE of an existing table.
+     */
+    void Server::observe(Shard &shard, Connection &connection, const Message &message)
+    {
+        auto it = shard.tables.find(message.table);
+        if (connection.table != NO_TABLE)
+            encodeError(connection.out, Status::AlreadySeated, "This connection already has a table");
+        else if (it == shard.tables.end())
+            encodeError(connection.out, Status::BadRequest, "No table " + to_string(message.table));
+        else
+        {
+            connection.table = message.table;
+            it->second->observers.push_back(connection.fd);
+            captureState(it->second->game, it->second->state);
+            encodeState(connection.out, message.table, it->second->state, it->second->lastOption, it->second->lastBlocker);
+        }
+    }
+
+    /**
+     * Encodes the table's state once and queues it on every seated and observing connection.
+     */
+    void Server::broadcast(Shard &shard, uint32_t tableId, Table &table)
+    {
+        captureState(table.game, table.state);
+        static thread_local vector<uint8_t> frame;
+        frame.clear();
+        encodeState(frame, tableId, table.state, table.lastOption, table.lastBlocker);
+        auto queue = [&](int fd)
+        {
+            auto it = shard.connections.find(fd);
+            if (it == shard.connections.end())
+                return;
+            it->second.out.insert(it->second.out.end(), frame.begin(), frame.end());
+            send(shard, it->second);
+        };
+        for (uint8_t s = 0; s < table.roles.size(); ++s)
+            if (table.seatFd[s] >= 0)
+                queue(table.seatFd[s]);
+        for (int fd : table.observers)
+            queue(fd);
+    }
+
+    /**
+     * Writes as much of the output buffer as the socket takes; the rest waits for EPOLLOUT.
+     * Errors are left to the read side, which sees the same socket fail and drops it.
+     */
+    void Server::send(Shard &shard, Connection &connection)
+    {
+        if (shard.journal)
+        {
+            // Output waits until every record appended before it was queued is on disk.
+            if (connection.out.size() > connection.queued)
+                connection.waitsFor = shard.journal->appended();
+            connection.queued = connection.out.size();
+            if (connection.waitsFor > shard.journal->durable())
+            {
+                if (!connection.held)
+                    shard.held.push_back(connection.fd);
+                connection.held = true;
+                return;
+            }
+        }
+        size_t sent = 0;
+        while (sent < connection.out.size())
+        {
+            ssize_t n = ::send(connection.fd, connection.out.data() + sent, connection.out.size() - sent, MSG_NOSIGNAL);
+            if (n > 0)
+                sent += static_cast<size_t>(n);
+            else if (n < 0 && errno == EINTR)
+                continue;
+            else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            else
+            {
+                sent = connection.out.size(); // broken: discard, the read side drops the connection
+                break;
+            }
+        }
+        connection.out.erase(connection.out.begin(), connection.out.begin() + sent);
+        connection.queued = connection.out.size();
+        bool wantWrite = !connection.out.empty();
+        if (wantWrite != connection.writing)
+        {
+            epoll_event event{};
+            event.events = static_cast<uint32_t>(EPOLLIN) | (wantWrite ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+            event.data.fd = connection.fd;
+            epoll_ctl(shard.epfd, EPOLL_CTL_MOD, connection.fd, &event);
+            connection.writing = wantWrite;
+        }
+    }
+
+    /**
+     * Closes a connection and frees its seat; a table nobody is connected to any more is removed.
+     */
+    void Server::drop(Shard &shard, int fd)
+    {
+        auto it = shard.connections.find(fd);
+        if (it == shard.connections.end())
+            return;
+        Connection &connection = it->second;
+        auto t = shard.tables.find(connection.table);
+        if (t != shard.tables.end())
+        {
+            Table &table = *t->second;
+            if (connection.seat != NO_SEAT)
+                table.seatFd[connection.seat] = -1;
+            else
+                table.observers.erase(std::remove(table.observers.begin(), table.observers.end(), fd), table.observers.end());
+            bool anyone = !table.observers.empty();
+            for (uint8_t s = 0; s < table.roles.size(); ++s)
+                anyone = anyone || table.seatFd[s] >= 0;
+            if (!anyone)
+            {
+                JournalRecord entry;
+                entry.kind = JournalRecord::Close;
+                entry.table = connection.table;
+                record(shard, entry);
+                preserve(shard, connection.table, table);
+                shard.tables.erase(t);
+            }
+        }
+        epoll_ctl(shard.epfd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        shard.connections.erase(it);
+        shard.open.fetch_sub(1, memory_order_relaxed);
+    }
+
+    /**
+     * Moves a connection (and its unparsed bytes) to the shard that owns the table it asked for.
+     */
+    void Server::handOver(size_t from, int fd, size_t to)
+    {
+        Shard &source = *shards[from];
+        Shard &target = *shards[to];
+        auto it = source.connections.find(fd);
+        epoll_ctl(source.epfd, EPOLL_CTL_DEL, fd, nullptr);
+        Connection connection = std::move(it->second);
+        source.connections.erase(it);
+        source.open.fetch_sub(1, memory_order_relaxed);
+        {
+            lock_guard<mutex> lock(target.inboxLock);
+            target.inbox.push_back(std::move(connection));
+        }
+        uint64_t one = 1;
+        if (write(target.wakeFd, &one, sizeof(one)) < 0)
+            return; // the counter is full: the target shard is awake anyway
+    }
+
+    void Server::record(Shard &shard, const JournalRecord &entry)
+    {
+        if (shard.journal)
+            shard.journal->append(entry);
+    }
+
+    /**
+     * Sends the output that was waiting for the journal commit that just landed.
+     */
+    void Server::releaseHeld(Shard &shard)
+    {
+        vector<int> held;
+        held.swap(shard.held);
+        for (int fd : held)
+        {
+            auto it = shard.connections.find(fd);
+            if (it == shard.connections.end())
+                continue;
+            it->second.held = false;
+            send(shard, it->second);
+        }
+    }
+
+
+    /**
+     * Drives the snapshot of a shard, one step per pass of its event loop.
+     * When the interval is up it rotates the journal to a new segment and notes the tables that exist; then it
+     * copies a slice of them per pass (tables about to change are copied first, see preserve()), and once all are
+     * copied hands the file to a writer thread.
+     */
+    void Server::snapshotStep(size_t index)
+    {
+        Shard &shard = *shards[index];
+        if (!shard.journal)
+            return;
+        if (!shard.capturing)
+        {
+            if (shard.snapshotBusy.load(memory_order_acquire) || chrono::steady_clock::now() < shard.nextSnapshot)
+                return;
+            if (shard.snapshotWriter.joinable())
+                shard.snapshotWriter.join();
+            try
+            {
+                shard.journal->rotate(journalDir + "/" + fileName("journal", index, shard.segment + 1));
+            }
+            catch (const exception &e)
+            {
+                Logger::instance().log(LogLevel::Error, "Snapshot of shard ", index, " skipped: ", e.what());
+                shard.nextSnapshot = chrono::steady_clock::now() + snapshotInterval;
+                return;
+            }
+            ++shard.segment;
+            ++shard.epoch;
+            shard.capturing = true;
+            shard.captureIds.clear();
+            for (const auto &entry : shard.tables)
+                shard.captureIds.push_back(entry.first);
+            shard.captureNext = 0;
+            shard.captured = 0;
+            shard.snapshot.clear();
+            beginSnapshot(shard.snapshot);
+        }
+
+        size_t end = std::min(shard.captureNext + SNAPSHOT_SLICE, shard.captureIds.size());
+        for (; shard.captureNext < end; ++shard.captureNext)
+        {
+            auto it = shard.tables.find(shard.captureIds[shard.captureNext]);
+            if (it != shard.tables.end())
+                preserve(shard, it->first, *it->second);
+        }
+        if (shard.captureNext < shard.captureIds.size())
+            return;
+
+        endSnapshot(shard.snapshot, shard.captured);
+        shard.capturing = false;
+        shard.nextSnapshot = chrono::steady_clock::now() + snapshotInterval;
+        shard.snapshotBusy.store(true, memory_order_release);
+        shard.snapshotWriter = thread(&Server::writeSnapshot, this, index, shard.segment, std::move(shard.snapshot));
+        shard.snapshot = vector<uint8_t>();
+    }
+
+    /**
+     * Copies a table into the running snapshot unless it is already there, before it changes (or is removed).
+     */
+    void Server::preserve(Shard &shard, uint32_t tableId, Table &table)
+    {
+        if (!shard.capturing || table.snapshotEpoch == shard.epoch)
+            return;
+        captureTable(shard.snapshot, tableId, table);
+        table.snapshotEpoch = shard.epoch;
+        ++shard.captured;
+    }
+
+    void Server::captureTable(vector<uint8_t> &out, uint32_t tableId, const Table &table)
+    {
+        static thread_local TableImage image;
+        image.id = tableId;
+        image.size = table.size;
+        image.seated = static_cast<uint8_t>(table.roles.size());
+        for (uint8_t s = 0; s < image.seated; ++s)
+        {
+            image.roles[s] = table.roles[s];
+            image.names[s] = table.game.getPlayer(s).GetName();
+        }
+        image.version = table.state.version;
+        image.gamesPlayed = table.state.gamesPlayed;
+        image.movesThisGame = table.movesThisGame;
+        image.lastAction = table.state.lastAction;
+        image.lastActor = table.state.lastActor;
+        image.lastTarget = table.state.lastTarget;
+        image.lastOption = table.lastOption;
+        image.lastBlocker = table.lastBlocker;
+        image.game = GameImage{};
+        if (image.seated == image.size)
+            table.game.captureImage(image.game);
+        encodeTable(out, image);
+    }
+
+    /**
+     * Writes a snapshot in place (temporary file, fsync, rename), then removes the journal segments and snapshots of
+     * the shard that it replaces. Runs on the shard's snapshot writer thread.
+     */
+    void Server::writeSnapshot(size_t index, uint32_t segment, vector<uint8_t> data)
+    {
+        namespace fs = std::filesystem;
+        try
+        {
+            string path = journalDir + "/" + fileName("snapshot", index, segment);
+            writeFileSynced(path + ".tmp", data);
+            fs::rename(path + ".tmp", path);
+            syncDirectory(journalDir);
+            for (uint32_t old = 0; old < segment; ++old)
+            {
+                std::error_code ignored;
+                fs::remove(journalDir + "/" + fileName("journal", index, old), ignored);
+                fs::remove(journalDir + "/" + fileName("snapshot", index, old), ignored);
+            }
+            snapshotCount.fetch_add(1, memory_order_relaxed);
+        }
+        catch (const exception &e)
+        {
+            Logger::instance().log(LogLevel::Error, "Snapshot of shard ", index, " failed: ", e.what());
+        }
+        shards[index]->snapshotBusy.store(false, memory_order_release);
+    }
+
+    /**
+     * @return ---> <kind>-<generation>-<shard>-<segment>.wal for journals, .snap for snapshots.
+     */
+    string Server::fileName(const char *kind, size_t shard, uint32_t segment) const
+    {
+        string kindName = kind;
+        return kindName + "-" + to_string(generation) + "-" + to_string(shard) + "-" + to_string(segment) +
+               (kindName == "journal" ? ".wal" : ".snap");
+    }
+
+    /**
+     * Splits a journal or snapshot file name (see fileName; journal-<generation>-<shard>.wal is segment 0).
+     * @return ---> false for any other file.
+     */
+    static bool parseFileName(const string &name, string &kind, uint64_t &generation, uint64_t &shard, uint64_t &segment)
+    {
+        size_t dot = name.rfind('.');
+        if (dot == string::npos)
+            return false;
+        string extension = name.substr(dot + 1);
+        vector<string> parts;
+        size_t from = 0;
+        for (size_t dash; (dash = name.find('-', from)) < dot; from = dash + 1)
+            parts.push_back(name.substr(from, dash - from));
+        parts.push_back(name.substr(from, dot - from));
+        if (parts.size() < 3 || parts.size() > 4)
+            return false;
+        kind = parts[0];
+        if (!(kind == "journal" && extension == "wal") && !(kind == "snapshot" && extension == "snap"))
+            return false;
+        for (size_t i = 1; i < parts.size(); ++i)
+            if (parts[i].empty() || parts[i].find_first_not_of("0123456789") != string::npos)
+                return false;
+        generation = stoull(parts[1]);
+        shard = stoull(parts[2]);
+        segment = parts.size() == 4 ? stoull(parts[3]) : 0;
+        return true;
+    }
+
+    /**
+     * Rebuilds the tables of the last generation, then starts a new one from a snapshot of them.
+     * The CURRENT file names the generation in use and is replaced (by rename) only once the new generation is on
+     * disk, so a crash during recovery recovers from the old one again. Per shard of the old generation, the tables
+     * come from its latest snapshot and the journal segments from that snapshot's on, replayed through the rules.
+     */
+    void Server::recover()
+    {
+        namespace fs = std::filesystem;
+        fs::create_directories(journalDir);
+        ifstream(journalDir + "/CURRENT") >> generation;
+
+        struct Files
+        {
+            bool snapshotted = false;
+            uint64_t snapshot = 0;     // segment of the latest snapshot
+            vector<uint64_t> segments; // journal segments
+        };
+        map<uint64_t, Files> oldShards;
+        for (const auto &file : fs::directory_iterator(journalDir))
+        {
+            string kind;
+            uint64_t fileGeneration, shard, segment;
+            if (generation == 0 || !parseFileName(file.path().filename().string(), kind, fileGeneration, shard, segment) ||
+                fileGeneration != generation)
+                continue;
+            Files &files = oldShards[shard];
+            if (kind == "journal")
+                files.segments.push_back(segment);
+            else if (!files.snapshotted || segment > files.snapshot)
+            {
+                files.snapshotted = true;
+                files.snapshot = segment;
+            }
+        }
+
+        struct History
+        {
+            TableImage base;     // the snapshot's copy of the table, or the seats the journal gave it
+            bool imaged = false; // base.game is the game in progress
+            JournalRecord deal;
+            bool dealt = false;          // a game was dealt after the snapshot
+            vector<JournalRecord> plays; // since the image or the deal
+        };
+        map<uint32_t, History> histories;
+        string oldDir = journalDir + "/";
+        for (auto &[shard, files] : oldShards)
+        {
+            string prefix = to_string(generation) + "-" + to_string(shard) + "-";
+            if (files.snapshotted)
+                readSnapshot(oldDir + "snapshot-" + prefix + to_string(files.snapshot) + ".snap", [&](const TableImage &image)
+                             {
+                    History &history = histories[image.id];
+                    history.base = image;
+                    history.imaged = image.size > 0 && image.seated == image.size; });
+            std::sort(files.segments.begin(), files.segments.end());
+            for (uint64_t segment : files.segments)
+            {
+                if (segment < files.snapshot)
+                    continue; // older than the snapshot (the writer had not removed it yet)
+                string path = oldDir + "journal-" + prefix + to_string(segment) + ".wal";
+                if (segment == 0 && !fs::exists(path))
+                    path = oldDir + "journal-" + to_string(generation) + "-" + to_string(shard) + ".wal";
+                readJournal(path, [&](const JournalRecord &entry)
+                            {
+                    History &history = histories[entry.table];
+                    switch (entry.kind)
+                    {
+                    case JournalRecord::Seat:
+                        history.base.id = entry.table;
+                        history.base.size = entry.size;
+                        if (history.base.seated < entry.size)
+                        {
+                            history.base.roles[history.base.seated] = entry.role;
+                            history.base.names[history.base.seated++] = entry.name;
+                        }
+                        break;
+                    case JournalRecord::Deal:
+                        history.deal = entry;
+                        history.dealt = true;
+                        history.imaged = false;
+                        history.plays.clear();
+                        break;
+                    case JournalRecord::Play:
+                        history.plays.push_back(entry);
+                        break;
+                    case JournalRecord::Close:
+                        histories.erase(entry.table);
+                        break;
+                    } });
+            }
+        }
+
+        generation += 1;
+        vector<vector<uint8_t>> snapshots(shards.size());
+        vector<uint32_t> counts(shards.size(), 0);
+        for (vector<uint8_t> &out : snapshots)
+            beginSnapshot(out);
+        for (auto &[id, history] : histories)
+        {
+            const TableImage &base = history.base;
+            if (base.seated == 0)
+                continue;
+            Shard &shard = *shards[shardOf(id)];
+            unique_ptr<Table> &slot = shard.tables[id];
+            slot = make_unique<Table>();
+            Table &table = *slot;
+            table.size = base.size;
+            for (uint8_t s = 0; s < base.seated; ++s)
+            {
+                table.roles.push_back(base.roles[s]);
+                emplaceRole(table.game, base.roles[s], base.names[s]);
+            }
+            if (history.imaged || history.dealt)
+            {
+                // The moves are played again through the rules, exactly as the table loop played them.
+                try
+                {
+                    if (history.imaged)
+                    {
+                        table.game.restoreImage(base.game);
+                        table.state.version = base.version;
+                        table.state.gamesPlayed = base.gamesPlayed;
+                        table.movesThisGame = base.movesThisGame;
+                        table.state.lastAction = base.lastAction;
+                        table.state.lastActor = base.lastActor;
+                        table.state.lastTarget = base.lastTarget;
+                        table.lastOption = base.lastOption;
+                        table.lastBlocker = base.lastBlocker;
+                    }
+                    else
+                    {
+                        table.game.reset(history.deal.seed, table.roles);
+                        table.state.version = history.deal.version;
+                        table.state.gamesPlayed = history.deal.gamesPlayed;
+                    }
+                    for (const JournalRecord &entry : history.plays)
+                    {
+                        applyMove(table.game, entry.move);
+                        if (entry.blocker != NO_SEAT)
+                            applyBlock(table.game, entry.blocker, entry.seat, entry.move);
+                        ++table.state.version;
+                        ++table.movesThisGame;
+                        table.state.lastAction = entry.move.action;
+                        table.state.lastActor = entry.seat;
+                        table.state.lastTarget = entry.move.target;
+                        table.lastOption = entry.move.option;
+                        table.lastBlocker = entry.blocker;
+                    }
+                }
+                catch (const exception &e)
+                {
+                    Logger::instance().log(LogLevel::Error, "Table ", id, " cannot be replayed: ", e.what());
+                    table.movesThisGame = MAX_MOVES_PER_GAME; // dealt again below
+                }
+            }
+            captureState(table.game, table.state);
+            if (table.roles.size() == table.size)
+            {
+                if (table.game.isOver() || table.movesThisGame >= MAX_MOVES_PER_GAME)
+                    deal(shard, id, table); // the crash came between the last move and the next deal
+                table.loop = play(shard, id, table);
+            }
+            captureTable(snapshots[shardOf(id)], id, table);
+            ++counts[shardOf(id)];
+        }
+
+        string next = to_string(generation);
+        for (size_t i = 0; i < shards.size(); ++i)
+        {
+            endSnapshot(snapshots[i], counts[i]);
+            writeFileSynced(journalDir + "/" + fileName("snapshot", i, 0), snapshots[i]);
+        }
+        writeFileSynced(journalDir + "/CURRENT.tmp", vector<uint8_t>(next.begin(), next.end()));
+        fs::rename(journalDir + "/CURRENT.tmp", journalDir + "/CURRENT");
+        syncDirectory(journalDir);
+        for (const auto &file : fs::directory_iterator(journalDir))
+        {
+            string name = file.path().filename().string(), kind;
+            uint64_t fileGeneration, shard, segment;
+            bool old = parseFileName(name, kind, fileGeneration, shard, segment) && fileGeneration != generation;
+            if (old || (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0))
+                fs::remove(file.path()); // older generations, and snapshots a crash left half written
+        }
+        for (size_t i = 0; i < shards.size(); ++i)
+        {
+            shards[i]->journal = make_unique<Journal>(journalDir + "/" + fileName("journal", i, 0), COMMIT_INTERVAL,
+                                                      shards[i]->wakeFd);
+            shards[i]->nextSnapshot = chrono::steady_clock::now() + snapshotInterval;
+        }
+    }
+}
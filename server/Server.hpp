@@ -0,0 +1,172 @@
+// ronamsalem4@gmail.com
+#ifndef SERVER_HPP
+#define SERVER_HPP
+#include "Protocol.hpp"
+#include "Journal.hpp"
+#include "Snapshot.hpp"
+#include "TableLoop.hpp"
+#include "../game/Game.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class Server
+ * Hosts many Game tables over TCP (see Protocol.hpp), from one process.
+ * Tables are sharded over worker threads by table id; each shard runs its own epoll loop and owns its tables and
+ * the connections seated at them, so JOIN / ACT / STATE never take a lock. All shards wait on the shared listening
+ * socket (EPOLLEXCLUSIVE) and accept connections; the first JOIN or OBSERVE for a table of another shard hands the
+ * connection over to that shard once, through the shard's inbox (a mutex-guarded list and an eventfd wake-up).
+ * A table starts when it is full, and deals a new game with the same seats whenever one ends. Its games are played by
+ * a coroutine (see TableLoop.hpp, play()) that suspends for each turn's move and for each player who may block it
+ * (ASK / REACT); a player who does not answer within the reaction timeout lets the move be.
+ *
+ * With a journal directory, every shard appends what it applies to its write-ahead journal (Journal.hpp), and the
+ * answers to a client are only sent once the records they depend on are on disk. A server started on the same
+ * directory rebuilds every table from the last snapshot of each shard (Snapshot.hpp) and the journal segments
+ * written after it, replayed through the rules, then starts a new generation from a fresh snapshot. Players get
+ * their seats back by joining the table again under the same name.
+ * Every snapshot interval a shard rotates its journal to a new segment and snapshots its tables as they were at
+ * that point: a slice of tables per pass of its event loop, and any table about to change is copied first (copy on
+ * write), so moves are never held up. A background thread writes the snapshot and removes the segments before it.
+ */
+namespace coup
+{
+    class Server
+    {
+    public:
+        static constexpr uint32_t MAX_MOVES_PER_GAME = 1000; // A game still running after this many moves is dealt again.
+        static constexpr chrono::milliseconds COMMIT_INTERVAL{2}; // How long a journal batch collects records before its fsync.
+        static constexpr size_t SNAPSHOT_SLICE = 1024;            // Tables a shard copies per loop pass while it snapshots.
+
+        /**
+         * @param port ---> TCP port on 127.0.0.1 (0 picks a free port, see port()).
+         * @param shards ---> Number of worker threads (at least 1).
+         * @param reactionTimeout ---> How long a player asked to block a move has to answer.
+         * @param journalDir ---> Directory of the journals and snapshots (created if needed); empty runs without.
+         * @param snapshotInterval ---> Time between two snapshots of a shard.
+         * @throws ---> runtime_error if the socket or the journals cannot be opened, or a snapshot is damaged.
+         */
+        Server(uint16_t port, size_t shards, chrono::milliseconds reactionTimeout = chrono::milliseconds(2000),
+               const string &journalDir = "", chrono::milliseconds snapshotInterval = chrono::seconds(10));
+        ~Server(); // Stops the shards and closes every connection.
+        Server(const Server &) = delete;
+        Server &operator=(const Server &) = delete;
+
+        void start(); // Starts the shard threads.
+        void stop();  // Stops and joins the shard threads.
+
+        uint16_t port() const { return boundPort; } // @return ---> The port the server listens on.
+        uint64_t actions() const;                   // @return ---> ACT messages accepted over all shards.
+        uint64_t connections() const;               // @return ---> Connections currently open over all shards.
+        uint64_t games() const;                     // @return ---> Games finished over all shards.
+        size_t tables() const;                      // @return ---> Tables hosted (call while stopped).
+        uint64_t snapshots() const;                 // @return ---> Snapshots the shards have written since the start.
+
+    private:
+        struct Connection
+        {
+            int fd = -1;
+            uint32_t table = NO_TABLE;
+            uint8_t seat = NO_SEAT;  // NO_SEAT for observers (and before JOIN)
+            vector<uint8_t> in;      // bytes received and not parsed yet
+            vector<uint8_t> out;     // bytes not sent yet
+            bool writing = false;    // EPOLLOUT is armed
+            bool held = false;       // out waits for a journal commit (listed in Shard::held)
+            uint64_t waitsFor = 0;   // journal records that must be durable before out is sent
+            size_t queued = 0;       // size of out when send() last saw it
+        };
+
+        struct Table
+        {
+            Game game;
+            uint8_t size = 0;
+            vector<RoleType> roles;
+            int seatFd[Game::MAX_PLAYERS];
+            vector<int> observers;
+            GameState state;
+            uint8_t lastOption = 0;        // sanction option of the last move (GameState has the rest of it)
+            uint8_t lastBlocker = NO_SEAT; // seat that blocked the last move
+            uint32_t movesThisGame = 0;
+            Decision decision; // what the loop waits for
+            uint32_t snapshotEpoch = 0; // the shard's snapshot that holds this table, or the one running when it was created
+            TableLoop loop;    // runs from the moment the table is full; destroyed first
+            Table() { std::fill(seatFd, seatFd + Game::MAX_PLAYERS, -1); }
+        };
+
+        struct Shard
+        {
+            int epfd = -1;
+            int wakeFd = -1; // eventfd: inbox has connections, or the server stops
+            thread worker;
+            unordered_map<int, Connection> connections;
+            unordered_map<uint32_t, unique_ptr<Table>> tables;
+            mutex inboxLock; // only taken when a connection changes shards
+            vector<Connection> inbox;
+            using Timer = pair<chrono::steady_clock::time_point, uint32_t>; // reaction deadline, table
+            priority_queue<Timer, vector<Timer>, greater<Timer>> timers;
+            unique_ptr<Journal> journal; // null without a journal directory
+            vector<int> held;            // connections waiting for a journal commit
+            uint32_t segment = 0;        // journal segment being written
+            uint32_t epoch = 0;          // snapshot being captured, or the last one
+            bool capturing = false;
+            vector<uint32_t> captureIds; // tables that existed when the snapshot started
+            size_t captureNext = 0;
+            uint32_t captured = 0;
+            vector<uint8_t> snapshot; // the snapshot file being built
+            chrono::steady_clock::time_point nextSnapshot;
+            thread snapshotWriter;
+            atomic<bool> snapshotBusy{false}; // snapshotWriter has not finished
+            atomic<uint64_t> actions{0};
+            atomic<uint64_t> open{0};
+            atomic<uint64_t> games{0};
+        };
+
+        void run(size_t shard);
+        void acceptAll(size_t shard);
+        void adopt(size_t shard, Connection &&connection);
+        void readFrom(size_t shard, int fd);
+        void handle(Shard &shard, Connection &connection, const Message &message);
+        void join(Shard &shard, Connection &connection, const Message &message);
+        void act(Shard &shard, Connection &connection, const Message &message);
+        void react(Shard &shard, Connection &connection, const Message &message);
+        void observe(Shard &shard, Connection &connection, const Message &message);
+        TableLoop play(Shard &shard, uint32_t tableId, Table &table);
+        void resume(Shard &shard, uint32_t tableId, Table &table);
+        void expireReactions(Shard &shard);
+        void deal(Shard &shard, uint32_t tableId, Table &table);
+        void record(Shard &shard, const JournalRecord &entry);
+        void releaseHeld(Shard &shard);
+        void recover();
+        void snapshotStep(size_t shard);
+        void preserve(Shard &shard, uint32_t tableId, Table &table);
+        void captureTable(vector<uint8_t> &out, uint32_t tableId, const Table &table);
+        void writeSnapshot(size_t shard, uint32_t segment, vector<uint8_t> data);
+        string fileName(const char *kind, size_t shard, uint32_t segment) const;
+        void broadcast(Shard &shard, uint32_t tableId, Table &table);
+        void send(Shard &shard, Connection &connection);
+        void drop(Shard &shard, int fd);
+        void handOver(size_t from, int fd, size_t to);
+        size_t shardOf(uint32_t table) const { return table % shards.size(); }
+
+        int listenFd = -1;
+        uint16_t boundPort = 0;
+        chrono::milliseconds reactionTimeout;
+        string journalDir;
+        uint64_t generation = 0; // of the journal and snapshot files (see recover())
+        chrono::milliseconds snapshotInterval;
+        atomic<uint64_t> snapshotCount{0};
+        vector<unique_ptr<Shard>> shards;
+        atomic<bool> running{false};
+    };
+}
+
+#endif
@@ -0,0 +1,118 @@
+// ronamsalem4@gmail.com
+#include "Snapshot.hpp"
+#include "Journal.hpp"
+#include <stdexcept>
+
+namespace coup
+{
+    static constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'S', 'N', 'A', 'P'};
+    static constexpr uint32_t FORMAT = 1;
+    static constexpr uint8_t TABLE_FRAME = 1;
+    static constexpr uint8_t END_FRAME = 2;
+
+    void beginSnapshot(vector<uint8_t> &out)
+    {
+        out.insert(out.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        for (int i = 0; i < 4; ++i)
+            out.push_back(static_cast<uint8_t>(FORMAT >> (8 * i)));
+    }
+
+    void encodeTable(vector<uint8_t> &out, const TableImage &table)
+    {
+        FrameWriter w(out, TABLE_FRAME);
+        w.u32(table.id);
+        w.u8(table.size);
+        w.u8(table.seated);
+        for (uint8_t s = 0; s < table.seated; ++s)
+        {
+            w.u8(static_cast<uint8_t>(table.roles[s]));
+            w.text(table.names[s]);
+        }
+        w.u64(table.version);
+        w.u32(table.gamesPlayed);
+        w.u32(table.movesThisGame);
+        w.u8(static_cast<uint8_t>(table.lastAction));
+        w.u8(table.lastActor);
+        w.u8(table.lastTarget);
+        w.u8(table.lastOption);
+        w.u8(table.lastBlocker);
+        w.bytes(&table.game, sizeof(GameImage));
+    }
+
+    void endSnapshot(vector<uint8_t> &out, uint32_t tables)
+    {
+        uint32_t sum = checksum32(out.data(), out.size());
+        FrameWriter w(out, END_FRAME);
+        w.u32(tables);
+        w.u32(sum);
+    }
+
+    size_t readSnapshot(const string &path, const function<void(const TableImage &)> &visit)
+    {
+        vector<uint8_t> data;
+        if (!readFile(path, data))
+            throw runtime_error("Cannot read snapshot " + path);
+        size_t header = sizeof(MAGIC) + 4;
+        if (data.size() < header || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+            throw runtime_error("Not a snapshot: " + path);
+        FrameReader format(data.data() + sizeof(MAGIC), 4);
+        if (format.u32() != FORMAT)
+            throw runtime_error("Unknown snapshot format: " + path);
+
+        // The end frame (u16 size, kind, count, checksum) closes the file; check it before reading any table.
+        constexpr size_t END_SIZE = FRAME_HEADER + 8;
+        if (data.size() < header + END_SIZE)
+            throw runtime_error("Damaged snapshot: " + path);
+        size_t end = data.size() - END_SIZE;
+        FrameReader footer(data.data() + end, END_SIZE);
+        bool closed = footer.u16() == END_SIZE - 2 && footer.u8() == END_FRAME;
+        uint32_t tables = footer.u32();
+        if (!closed || footer.u32() != checksum32(data.data(), end))
+            throw runtime_error("Damaged snapshot: " + path);
+
+        // Table frames can be longer than protocol frames, so their size is read here rather than with frameSize().
+        size_t pos = header, count = 0;
+        TableImage table;
+        try
+        {
+            while (pos < end)
+            {
+                size_t size = 2 + (data[pos] | (static_cast<size_t>(data[pos + 1]) << 8));
+                if (size < FRAME_HEADER || pos + size > end)
+                    break;
+                FrameReader r(data.data() + pos + 2, size - 2);
+                if (r.u8() != TABLE_FRAME)
+                    break;
+                table.id = r.u32();
+                table.size = r.u8();
+                table.seated = r.u8();
+                if (table.size > Game::MAX_PLAYERS || table.seated > table.size)
+                    break;
+                for (uint8_t s = 0; s < table.seated; ++s)
+                {
+                    table.roles[s] = static_cast<RoleType>(r.u8() % ROLE_COUNT);
+                    table.names[s] = r.text();
+                }
+                table.version = r.u64();
+                table.gamesPlayed = r.u32();
+                table.movesThisGame = r.u32();
+                table.lastAction = static_cast<ActionType>(r.u8());
+                table.lastActor = r.u8();
+                table.lastTarget = r.u8();
+                table.lastOption = r.u8();
+                table.lastBlocker = r.u8();
+                r.bytes(&table.game, sizeof(GameImage));
+                pos += size;
+                ++count;
+                visit(table);
+            }
+        }
+        catch (const invalid_argument &)
+        {
+            // a truncated field: reported below like any damage
+        }
+        if (pos == end && count == tables)
+            return count;
+        throw runtime_error("Damaged snapshot: " + path);
+    }
+}
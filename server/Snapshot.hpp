@@ -0,0 +1,51 @@
+// ronamsalem4@gmail.com
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+#include "Protocol.hpp"
+#include "../game/GameImage.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @file Snapshot.hpp
+ * Snapshot files of a server shard: every table of the shard at one point of its journal, so that recovery reads
+ * the snapshot and only the journal segments written after it.
+ * File: "COUPSNAP", u32 format, then one frame per table (u16 size, u8 kind, fields, see encodeTable), then an end
+ * frame with the table count and a checksum of everything before it. Files are written whole and renamed into
+ * place, so a snapshot either exists complete or not at all.
+ */
+namespace coup
+{
+    /**
+     * One table as a snapshot keeps it.
+     */
+    struct TableImage
+    {
+        uint32_t id = NO_TABLE;
+        uint8_t size = 0;
+        uint8_t seated = 0; // seats taken (the game starts when seated == size)
+        RoleType roles[Game::MAX_PLAYERS] = {};
+        string names[Game::MAX_PLAYERS];
+        uint64_t version = 0;
+        uint32_t gamesPlayed = 0;
+        uint32_t movesThisGame = 0;
+        ActionType lastAction = ActionType::None;
+        uint8_t lastActor = NO_SEAT, lastTarget = NO_SEAT, lastOption = 0, lastBlocker = NO_SEAT;
+        GameImage game; // meaningful once the table is full
+    };
+
+    void beginSnapshot(vector<uint8_t> &out);                         // Starts a snapshot buffer (the file header).
+    void encodeTable(vector<uint8_t> &out, const TableImage &table);  // Appends one table.
+    void endSnapshot(vector<uint8_t> &out, uint32_t tables);          // Appends the end frame (count and checksum).
+
+    /**
+     * Reads every table of a snapshot file.
+     * @param visit ---> Called once per table, in file order.
+     * @return ---> Number of tables.
+     * @throws ---> runtime_error if the file cannot be read or is not a whole, intact snapshot.
+     */
+    size_t readSnapshot(const string &path, const function<void(const TableImage &)> &visit);
+}
+
+#endif
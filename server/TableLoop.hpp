@@ -0,0 +1,124 @@
+// ronamsalem4@gmail.com
+#ifndef TABLELOOP_HPP
+#define TABLELOOP_HPP
+#include "../game/Moves.hpp"
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+/**
+ * @file TableLoop.hpp
+ * The game loop of a server table as a C++20 coroutine.
+ * The loop is written top to bottom (wait for the turn's move, ask each player who may block it, play it, deal the
+ * next game) and suspends at every point where it needs a player's decision. Whoever receives the decision (the
+ * network handler, or a timer when a player does not answer) stores it in the table's Decision and resumes the loop.
+ * A suspended table costs its coroutine frame and no thread, so one shard drives as many tables as it has sockets.
+ */
+namespace coup
+{
+    /**
+     * The decision a suspended table loop waits for, and the answer that resumes it.
+     */
+    struct Decision
+    {
+        enum Kind : uint8_t
+        {
+            None,    // the loop is running (or finished)
+            Turn,    // a move of the seat whose turn it is
+            Reaction // whether the seat blocks `move`
+        };
+
+        Kind kind = None;
+        uint8_t seat = NO_SEAT;                     // Seat that must decide.
+        Move move;                                  // Turn: the move received. Reaction: the move to answer.
+        bool block = false;                         // Reaction: the answer.
+        chrono::steady_clock::time_point deadline;  // Reaction: when no answer counts as no block.
+        coroutine_handle<> waiter;                  // The suspended loop.
+
+        /**
+         * Awaitable that suspends the loop until resume(); co_await yields this Decision with the answer.
+         */
+        struct Wait
+        {
+            Decision &decision;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(coroutine_handle<> handle) noexcept { decision.waiter = handle; }
+            Decision &await_resume() const noexcept
+            {
+                decision.kind = None;
+                return decision;
+            }
+        };
+
+        /**
+         * Declares what the loop waits for.
+         * @return ---> The awaitable to co_await.
+         */
+        Wait expect(Kind what, uint8_t who, const Move &about = Move{})
+        {
+            kind = what;
+            seat = who;
+            move = about;
+            block = false;
+            return Wait{*this};
+        }
+
+        /**
+         * Resumes the loop once the answer is stored; it runs until its next decision.
+         */
+        void resume()
+        {
+            coroutine_handle<> handle = std::exchange(waiter, nullptr);
+            if (handle)
+                handle.resume();
+        }
+    };
+
+    /**
+     * Owner of one table loop coroutine. The loop starts running as soon as it is created and never finishes on its
+     * own; destroying the owner destroys the suspended frame.
+     */
+    class TableLoop
+    {
+    public:
+        struct promise_type
+        {
+            exception_ptr error;
+            TableLoop get_return_object() { return TableLoop(coroutine_handle<promise_type>::from_promise(*this)); }
+            suspend_never initial_suspend() noexcept { return {}; }
+            suspend_always final_suspend() noexcept { return {}; } // kept until the owner reads failed()
+            void return_void() {}
+            void unhandled_exception() { error = current_exception(); }
+        };
+
+        TableLoop() = default;
+        TableLoop(TableLoop &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+        TableLoop &operator=(TableLoop &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle)
+                    handle.destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+        ~TableLoop()
+        {
+            if (handle)
+                handle.destroy();
+        }
+
+        /**
+         * @return ---> The exception that ended the loop, or nullptr while it runs.
+         */
+        exception_ptr failed() const { return handle && handle.done() ? handle.promise().error : nullptr; }
+
+    private:
+        explicit TableLoop(coroutine_handle<promise_type> handle) : handle(handle) {}
+        coroutine_handle<promise_type> handle;
+    };
+}
+
+#endif
@@ -0,0 +1,74 @@
+// ronamsalem4@gmail.com
+#include "LoadGen.hpp"
+#include "../game/Logger.hpp"
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+
+/**
+ * coup_loadgen: fills a running coup_server with simulated clients and reports throughput and latency.
+ * Usage: coup_loadgen [--port=7777] [--tables=250] [--seats=4] [--threads=1] [--seconds=5] [--first_table=1] [--seed=1]
+ */
+
+using namespace coup;
+using namespace std;
+
+static double toMicros(uint64_t ns) { return ns / 1000.0; }
+
+int main(int argc, char **argv)
+{
+    LoadGenConfig config;
+    for (int a = 1; a < argc; ++a)
+    {
+        string arg = argv[a];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--port")
+            config.port = static_cast<uint16_t>(stoi(value));
+        else if (key == "--tables")
+            config.tables = stoul(value);
+        else if (key == "--seats")
+            config.seats = static_cast<uint8_t>(stoi(value));
+        else if (key == "--threads")
+            config.threads = stoul(value);
+        else if (key == "--seconds")
+            config.duration = chrono::milliseconds(static_cast<long long>(stod(value) * 1000));
+        else if (key == "--first_table")
+            config.firstTable = static_cast<uint32_t>(stoul(value));
+        else if (key == "--seed")
+            config.seed = stoull(value);
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 2;
+        }
+    }
+
+    // One descriptor per seat: thousands of connections need more than the usual soft limit.
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    Logger::instance().setLevel(LogLevel::Warn); // the clients' copies of the games run the rules too
+    Logger::instance().start();                  // so the client threads never wait on stdout
+
+    try
+    {
+        LoadGenReport report = runLoad(config);
+        cout << fixed << setprecision(1)
+             << report.connections << " connections, " << report.seconds << " s\n"
+             << report.actionsPerSecond() << " actions/s (" << report.actions << " actions, "
+             << report.games << " games, " << report.rejected << " rejected)\n"
+             << "latency us: p50 " << toMicros(report.p50Ns) << "   p99 " << toMicros(report.p99Ns)
+             << "   p99.9 " << toMicros(report.p999Ns) << "   max " << toMicros(report.maxNs) << endl;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
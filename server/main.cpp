@@ -0,0 +1,79 @@
+// ronamsalem4@gmail.com
+#include "Server.hpp"
+#include "../game/Logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+
+/**
+ * coup_server: hosts Coup tables over TCP on 127.0.0.1 (protocol in Protocol.hpp) until Ctrl+C.
+ * Usage: coup_server [--port=7777] [--shards=N] [--reaction_ms=2000] [--journal=<dir>] [--snapshot_s=10]
+ * With a journal directory the tables survive a crash or a restart (see Server.hpp); every shard snapshots its
+ * tables every snapshot_s seconds so that recovery replays only the journal written since.
+ * Prints one line of statistics per second.
+ */
+
+using namespace coup;
+using namespace std;
+
+static atomic<bool> interrupted{false};
+
+int main(int argc, char **argv)
+{
+    uint16_t port = 7777;
+    size_t shards = std::max(1u, std::thread::hardware_concurrency());
+    int reactionMs = 2000;
+    string journal;
+    int snapshotSeconds = 10;
+    for (int a = 1; a < argc; ++a)
+    {
+        string arg = argv[a];
+        if (arg.rfind("--port=", 0) == 0)
+            port = static_cast<uint16_t>(stoi(arg.substr(7)));
+        else if (arg.rfind("--shards=", 0) == 0)
+            shards = std::max(1, stoi(arg.substr(9)));
+        else if (arg.rfind("--reaction_ms=", 0) == 0)
+            reactionMs = std::max(0, stoi(arg.substr(14)));
+        else if (arg.rfind("--journal=", 0) == 0)
+            journal = arg.substr(10);
+        else if (arg.rfind("--snapshot_s=", 0) == 0)
+            snapshotSeconds = std::max(1, stoi(arg.substr(13)));
+    }
+
+    // One descriptor per connection: load tests open thousands of them.
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    Logger::instance().setLevel(LogLevel::Warn); // the rules log every coup; a server hosts far too many
+    Logger::instance().start();                  // shard threads only queue their warnings, never wait on stdout
+    signal(SIGINT, [](int)
+           { interrupted = true; });
+    signal(SIGPIPE, SIG_IGN);
+
+    Server server(port, shards, chrono::milliseconds(reactionMs), journal, chrono::seconds(snapshotSeconds));
+    server.start();
+    cout << "coup_server listening on 127.0.0.1:" << server.port() << " with " << shards << " shards";
+    if (!journal.empty())
+        cout << ", " << server.tables() << " tables recovered from " << journal;
+    cout << endl;
+
+    uint64_t lastActions = 0;
+    while (!interrupted)
+    {
+        this_thread::sleep_for(chrono::seconds(1));
+        uint64_t actions = server.actions();
+        cout << server.connections() << " connections   " << (actions - lastActions) << " actions/s   "
+             << server.games() << " games" << endl;
+        lastActions = actions;
+    }
+    server.stop();
+    return 0;
+}
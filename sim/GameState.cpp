@@ -0,0 +1,27 @@
+// ronamsalem4@gmail.com
+#include "GameState.hpp"
+#include "../game/Player.hpp"
+#include <cstring>
+
+namespace coup
+{
+    void captureState(const Game &game, GameState &out)
+    {
+        out.numSeats = static_cast<uint8_t>(game.numPlayers());
+        out.turn = static_cast<uint8_t>(game.turnSeat());
+        optional<size_t> winner = game.winnerSeat();
+        out.winner = winner ? static_cast<uint8_t>(*winner) : NO_SEAT;
+        for (size_t s = 0; s < game.numPlayers(); ++s)
+        {
+            Player &p = game.getPlayer(s);
+            SeatState &seat = out.seats[s];
+            seat.role = p.GetRoleType();
+            seat.alive = p.Getstillingame();
+            seat.coins = static_cast<int16_t>(p.coins());
+            string_view name = p.GetNameView();
+            size_t n = name.size() < sizeof(seat.name) - 1 ? name.size() : sizeof(seat.name) - 1;
+            memcpy(seat.name, name.data(), n);
+            seat.name[n] = '\0';
+        }
+    }
+}
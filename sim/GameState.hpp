@@ -0,0 +1,46 @@
+// ronamsalem4@gmail.com
+#ifndef GAMESTATE_HPP
+#define GAMESTATE_HPP
+#include "../game/Game.hpp"
+#include "../game/Events.hpp"
+#include "../game/RoleType.hpp"
+#include <cstdint>
+
+/**
+ * @file GameState.hpp
+ * A self-contained, fixed-size copy of what a viewer needs to draw one table.
+ * Simulator threads fill a GameState after every move and hand it to the render thread through a TripleBuffer,
+ * so the renderer never touches a Game that another thread is playing.
+ */
+namespace coup
+{
+    struct SeatState
+    {
+        RoleType role = RoleType::Governor;
+        bool alive = false;
+        int16_t coins = 0;
+        char name[16] = {}; // The player's name, cut to 15 characters.
+    };
+
+    struct GameState
+    {
+        uint64_t version = 0;                 // Moves played on the table so far, over all its games.
+        uint32_t gamesPlayed = 0;             // Games finished on the table.
+        uint8_t numSeats = 0;                 // Seats in the current game.
+        uint8_t turn = NO_SEAT;               // Seat whose turn it is.
+        uint8_t winner = NO_SEAT;             // Seat of the winner once the game is over.
+        ActionType lastAction = ActionType::None; // The last move played (None at the start of a game).
+        uint8_t lastActor = NO_SEAT;
+        uint8_t lastTarget = NO_SEAT;
+        SeatState seats[Game::MAX_PLAYERS];
+    };
+
+    /**
+     * Copies the state of a game into a snapshot (version, gamesPlayed and the last move are left to the caller).
+     * @param game ---> The game to copy.
+     * @param out ---> The snapshot to fill.
+     */
+    void captureState(const Game &game, GameState &out);
+}
+
+#endif
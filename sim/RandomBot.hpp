@@ -0,0 +1,36 @@
+// ronamsalem4@gmail.com
+#ifndef RANDOMBOT_HPP
+#define RANDOMBOT_HPP
+#include "../game/Moves.hpp"
+#include <cstdint>
+#include <random>
+
+/**
+ * @class RandomBot
+ * Plays a uniformly random legal move. Used to keep simulated tables busy.
+ */
+namespace coup
+{
+    class RandomBot
+    {
+    public:
+        explicit RandomBot(uint64_t seed) : rng(seed) {}
+
+        /**
+         * @param game ---> A game that is not over.
+         * @return ---> One of legalMoves(game), chosen at random.
+         */
+        Move choose(const Game &game)
+        {
+            MoveList moves = legalMoves(game);
+            return moves[uniform_int_distribution<size_t>(0, moves.size() - 1)(rng)];
+        }
+
+        void reseed(uint64_t seed) { rng.seed(seed); } // Restarts the bot's random sequence.
+
+    private:
+        mt19937_64 rng;
+    };
+}
+
+#endif
@@ -0,0 +1,41 @@
+// ronamsalem4@gmail.com
+#include "RolloutBot.hpp"
+
+namespace coup
+{
+    Move RolloutBot::choose(const Game &game, double *value)
+    {
+        MoveList moves = legalMoves(game);
+        size_t seat = game.turnSeat();
+        if (moves.size() == 1)
+        {
+            if (value)
+                *value = 0;
+            return moves[0];
+        }
+
+        GameImage start;
+        game.captureImage(start);
+        size_t best = 0, bestWins = 0;
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            size_t wins = 0;
+            for (size_t p = 0; p < playouts; ++p)
+            {
+                scratch.restoreImage(start);
+                applyMove(scratch, moves[i]);
+                for (uint32_t n = 0; n < horizon && !scratch.isOver(); ++n)
+                    applyMove(scratch, random.choose(scratch));
+                wins += scratch.winnerSeat() == seat;
+            }
+            if (wins > bestWins)
+            {
+                best = i;
+                bestWins = wins;
+            }
+        }
+        if (value)
+            *value = static_cast<double>(bestWins) / playouts;
+        return moves[best];
+    }
+}
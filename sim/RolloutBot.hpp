@@ -0,0 +1,48 @@
+// ronamsalem4@gmail.com
+#ifndef ROLLOUTBOT_HPP
+#define ROLLOUTBOT_HPP
+#include "RandomBot.hpp"
+#include "../game/Game.hpp"
+#include "../game/GameImage.hpp"
+#include <cstdint>
+
+/**
+ * @class RolloutBot
+ * A search bot: flat Monte Carlo over the legal moves. Each move is played on a scratch copy of the game (restored
+ * from a GameImage) and followed by random playouts; the move whose playouts the player won most often is chosen.
+ * Blocks are not played in the playouts. Slow (playouts x moves games per decision), so it is used offline (see
+ * the opening book) or where strength matters more than speed.
+ */
+namespace coup
+{
+    class RolloutBot
+    {
+    public:
+        /**
+         * @param seed ---> Seed of the playouts.
+         * @param playouts ---> Playouts per legal move.
+         * @param horizon ---> Moves after which a playout counts as lost (a random game can run very long).
+         */
+        explicit RolloutBot(uint64_t seed, size_t playouts = 32, uint32_t horizon = 300)
+            : random(seed), playouts(playouts == 0 ? 1 : playouts), horizon(horizon) {}
+        RolloutBot(const RolloutBot &) = delete;
+        RolloutBot &operator=(const RolloutBot &) = delete;
+
+        /**
+         * @param game ---> A started game that is not over (not changed).
+         * @param value ---> If not null, receives the share of the chosen move's playouts the player won.
+         * @return ---> The legal move with the most playouts won (the first one on a tie).
+         */
+        Move choose(const Game &game, double *value = nullptr);
+
+        void reseed(uint64_t seed) { random.reseed(seed); } // Restarts the playouts' random sequence.
+
+    private:
+        RandomBot random;
+        Game scratch;
+        size_t playouts;
+        uint32_t horizon;
+    };
+}
+
+#endif
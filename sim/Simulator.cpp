@@ -0,0 +1,124 @@
+// ronamsalem4@gmail.com
+#include "Simulator.hpp"
+#include "../game/Player.hpp"
+
+namespace coup
+{
+    /**
+     * Creates the tables and deals each one its first game.
+     */
+    Simulator::Simulator(size_t tables, size_t threads, uint64_t seed)
+        : threadCount(threads == 0 ? 1 : (threads > tables && tables > 0 ? tables : threads))
+    {
+        tableList.reserve(tables);
+        for (size_t i = 0; i < tables; ++i)
+        {
+            tableList.push_back(make_unique<Table>(seed * 0x9E3779B97F4A7C15ULL + i + 1));
+            newGame(*tableList.back());
+        }
+    }
+
+    Simulator::~Simulator()
+    {
+        stop();
+    }
+
+    void Simulator::setMoveInterval(chrono::microseconds newInterval)
+    {
+        interval = newInterval;
+    }
+
+    void Simulator::start()
+    {
+        if (running.exchange(true))
+            return;
+        for (size_t t = 0; t < threadCount; ++t)
+            workers.emplace_back(&Simulator::work, this, t, threadCount);
+    }
+
+    void Simulator::stop()
+    {
+        running.store(false);
+        for (thread &worker : workers)
+            worker.join();
+        workers.clear();
+    }
+
+    /**
+     * Seats 3 to 6 players with random roles (derived from the table's seed and game count) and publishes the start.
+     */
+    void Simulator::newGame(Table &table)
+    {
+        uint64_t gameSeed = table.seed ^ (uint64_t(table.finished + 1) * 0xBF58476D1CE4E5B9ULL) ^ table.moves;
+        mt19937_64 rng(gameSeed);
+        vector<RoleType> layout(3 + rng() % 4);
+        for (RoleType &role : layout)
+            role = static_cast<RoleType>(rng() % ROLE_COUNT);
+        table.game.reset(gameSeed, layout);
+        table.movesThisGame = 0;
+        publish(table, nullptr, NO_SEAT);
+    }
+
+    /**
+     * Fills the table's back snapshot and hands it to the reader.
+     */
+    void Simulator::publish(Table &table, const Move *last, uint8_t actor)
+    {
+        GameState &state = table.out.back();
+        captureState(table.game, state);
+        state.version = table.moves;
+        state.gamesPlayed = table.finished;
+        state.lastAction = last ? last->action : ActionType::None;
+        state.lastActor = actor;
+        state.lastTarget = last ? last->target : NO_SEAT;
+        table.out.publish();
+    }
+
+    /**
+     * Plays one bot move; starts a new game first if the last one is over.
+     */
+    void Simulator::step(size_t index)
+    {
+        Table &table = *tableList.at(index);
+        if (table.game.isOver() || table.movesThisGame >= MAX_MOVES_PER_GAME)
+        {
+            if (table.game.isOver())
+            {
+                ++table.finished;
+                totalGames.fetch_add(1, memory_order_relaxed);
+            }
+            newGame(table);
+            return;
+        }
+        uint8_t actor = static_cast<uint8_t>(table.game.turnSeat());
+        Move move = table.bot.choose(table.game);
+        applyMove(table.game, move);
+        ++table.moves;
+        ++table.movesThisGame;
+        totalMoves.fetch_add(1, memory_order_relaxed);
+        publish(table, &move, actor);
+    }
+
+    const GameState &Simulator::latest(size_t index, bool *changed)
+    {
+        Table &table = *tableList.at(index);
+        bool fresh = table.out.update();
+        if (changed)
+            *changed = fresh;
+        return table.out.front();
+    }
+
+    /**
+     * Worker thread: plays one move on each of its tables per round, then pauses for the move interval.
+     */
+    void Simulator::work(size_t first, size_t stride)
+    {
+        while (running.load(memory_order_relaxed))
+        {
+            for (size_t i = first; i < tableList.size(); i += stride)
+                step(i);
+            if (interval.count() > 0)
+                this_thread::sleep_for(interval);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+// ronamsalem4@gmail.com
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+#include "GameState.hpp"
+#include "RandomBot.hpp"
+#include "TripleBuffer.hpp"
+#include "../game/Game.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * @class Simulator
+ * Plays many tables of bot games on worker threads and publishes a GameState of every table after each move.
+ * Each table belongs to one worker (tables are dealt round-robin), so games need no locking; a viewer reads the
+ * newest snapshot of a table through its TripleBuffer without ever waiting for the workers.
+ * When a game ends (or runs too long) the table starts a new one with a random seating, reusing its Game.
+ */
+namespace coup
+{
+    class Simulator
+    {
+    public:
+        static constexpr uint32_t MAX_MOVES_PER_GAME = 1000; // A game still running after this many moves is abandoned.
+
+        /**
+         * @param tables ---> Number of tables.
+         * @param threads ---> Number of worker threads (at least 1, at most one per table).
+         * @param seed ---> Seed of the whole simulation; each table derives its own.
+         */
+        Simulator(size_t tables, size_t threads, uint64_t seed);
+        ~Simulator(); // Stops the workers.
+        Simulator(const Simulator &) = delete;
+        Simulator &operator=(const Simulator &) = delete;
+
+        void setMoveInterval(chrono::microseconds interval); // Pause of a worker after each round over its tables (call before start()).
+        void start();                                        // Starts the worker threads.
+        void stop();                                         // Stops and joins the worker threads.
+
+        /**
+         * Plays one move on a table from the calling thread. Only while the workers are stopped.
+         */
+        void step(size_t table);
+
+        /**
+         * Reader side: the newest snapshot of a table. Call from one thread only (the viewer).
+         * @param changed ---> Set to true if the snapshot is newer than the one returned before.
+         */
+        const GameState &latest(size_t table, bool *changed = nullptr);
+
+        size_t tables() const { return tableList.size(); }
+        uint64_t movesPlayed() const { return totalMoves.load(memory_order_relaxed); } // @return ---> Moves played on all tables.
+        uint64_t gamesFinished() const { return totalGames.load(memory_order_relaxed); } // @return ---> Games won on all tables.
+
+    private:
+        struct Table
+        {
+            Game game;
+            RandomBot bot;
+            TripleBuffer<GameState> out;
+            uint64_t seed;
+            uint64_t moves = 0;
+            uint32_t finished = 0;
+            uint32_t movesThisGame = 0;
+            explicit Table(uint64_t seed) : bot(seed), seed(seed) {}
+        };
+
+        void newGame(Table &table);
+        void publish(Table &table, const Move *last, uint8_t actor);
+        void work(size_t first, size_t stride);
+
+        vector<unique_ptr<Table>> tableList;
+        size_t threadCount;
+        vector<thread> workers;
+        atomic<bool> running{false};
+        chrono::microseconds interval{0};
+        atomic<uint64_t> totalMoves{0};
+        atomic<uint64_t> totalGames{0};
+    };
+}
+
+#endif
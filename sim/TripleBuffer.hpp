@@ -0,0 +1,61 @@
+// ronamsalem4@gmail.com
+#ifndef TRIPLEBUFFER_HPP
+#define TRIPLEBUFFER_HPP
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class TripleBuffer
+ * Lock-free handoff of the latest value from one writer thread to one reader thread.
+ * The writer fills its back slot and publishes it by swapping it with the middle slot; the reader swaps
+ * the middle slot into its front slot only when something new was published. Neither side ever waits,
+ * and the reader always sees a complete value (the newest one; older ones it missed are skipped).
+ */
+namespace coup
+{
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() = default;
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+        T &back() { return slots[backIndex]; } // Writer: the slot to fill before publish().
+
+        /**
+         * Writer: makes the back slot the newest value, and takes the old middle slot as the new back slot.
+         */
+        void publish()
+        {
+            uint8_t old = middle.exchange(static_cast<uint8_t>(backIndex | FRESH), std::memory_order_acq_rel);
+            backIndex = old & INDEX;
+        }
+
+        /**
+         * Reader: switches to the newest published value, if there is one.
+         * @return ---> true if the front slot changed.
+         */
+        bool update()
+        {
+            if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+                return false;
+            uint8_t old = middle.exchange(frontIndex, std::memory_order_acq_rel);
+            frontIndex = old & INDEX;
+            return true;
+        }
+
+        const T &front() const { return slots[frontIndex]; } // Reader: the value last taken by update().
+
+    private:
+        static constexpr uint8_t INDEX = 0x3;
+        static constexpr uint8_t FRESH = 0x4; // set in middle while it holds a value the reader has not taken
+
+        T slots[3] = {};
+        uint8_t backIndex = 0;              // owned by the writer
+        uint8_t frontIndex = 1;             // owned by the reader
+        std::atomic<uint8_t> middle{2};     // shared
+    };
+}
+
+#endif
@@ -0,0 +1,268 @@
+// ronamsalem4@gmail.com
+#include "Records.hpp"
+#include "../game/Player.hpp"
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace coup
+{
+    static constexpr char MAGIC[8] = {'C', 'O', 'U', 'P', 'R', 'E', 'C', 'S'};
+    static constexpr size_t FILE_HEADER = 16; // magic, u32 format, u32 reserved: blocks start 8-aligned
+    static constexpr size_t BLOCK_HEADER = 16;
+
+    /**
+     * Bytes of a block's columns (header included), before the padding to 8.
+     */
+    static size_t blockBytes(size_t games, size_t moves)
+    {
+        return BLOCK_HEADER + games * (8 + 2 + 1 + 1 + Game::MAX_PLAYERS) + moves * 5;
+    }
+
+    static uint32_t get32(const uint8_t *p)
+    {
+        uint32_t value;
+        memcpy(&value, p, 4);
+        return value;
+    }
+
+    void RecordBlockBuilder::begin(uint64_t gameSeed, const Game &game)
+    {
+        seed.push_back(gameSeed);
+        length.push_back(0);
+        seats.push_back(static_cast<uint8_t>(game.numPlayers()));
+        for (size_t s = 0; s < Game::MAX_PLAYERS; ++s)
+            roles.push_back(s < game.numPlayers() ? static_cast<uint8_t>(game.getPlayer(s).GetRoleType()) : NO_SEAT);
+    }
+
+    void RecordBlockBuilder::move(uint8_t who, const Move &played, uint8_t blockedBy)
+    {
+        ++length.back();
+        actor.push_back(who);
+        action.push_back(static_cast<uint8_t>(played.action));
+        target.push_back(played.target);
+        option.push_back(played.option);
+        blocker.push_back(blockedBy);
+    }
+
+    void RecordBlockBuilder::end(uint8_t gameWinner)
+    {
+        winner.push_back(gameWinner);
+    }
+
+    void RecordBlockBuilder::encode(vector<uint8_t> &out) const
+    {
+        size_t games = seed.size(), moves = actor.size();
+        size_t size = (blockBytes(games, moves) + 7) & ~size_t(7);
+        size_t start = out.size();
+        out.resize(start + size, 0);
+        uint8_t *p = out.data() + start;
+        uint32_t header[4] = {static_cast<uint32_t>(games), static_cast<uint32_t>(moves), static_cast<uint32_t>(size), 0};
+        memcpy(p, header, BLOCK_HEADER);
+        p += BLOCK_HEADER;
+        auto column = [&p](const void *data, size_t bytes)
+        {
+            memcpy(p, data, bytes);
+            p += bytes;
+        };
+        column(seed.data(), games * 8);
+        column(length.data(), games * 2);
+        column(seats.data(), games);
+        column(winner.data(), games);
+        column(roles.data(), games * Game::MAX_PLAYERS);
+        column(actor.data(), moves);
+        column(action.data(), moves);
+        column(target.data(), moves);
+        column(option.data(), moves);
+        column(blocker.data(), moves);
+    }
+
+    void RecordBlockBuilder::clear()
+    {
+        seed.clear();
+        length.clear();
+        for (vector<uint8_t> *column : {&seats, &winner, &roles, &actor, &action, &target, &option, &blocker})
+            column->clear();
+    }
+
+    RecordWriter::RecordWriter(const string &path) : file(path, ios::binary | ios::trunc)
+    {
+        if (!file)
+            throw runtime_error("Cannot create " + path);
+        uint32_t header[2] = {RECORD_FORMAT, 0};
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    }
+
+    void RecordWriter::write(const RecordBlockBuilder &block)
+    {
+        if (block.empty())
+            return;
+        lock_guard<mutex> guard(lock);
+        buffer.clear();
+        block.encode(buffer);
+        file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<streamsize>(buffer.size()));
+        file.flush();
+        if (!file)
+            throw runtime_error("Cannot write the record file");
+        gameCount += block.games();
+    }
+
+    RecordFile::RecordFile(const string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw runtime_error("Cannot open " + path);
+        struct stat info{};
+        fstat(fd, &info);
+        size = static_cast<size_t>(info.st_size);
+        void *mapped = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (mapped == MAP_FAILED)
+            throw runtime_error("Cannot map " + path);
+        data = static_cast<const uint8_t *>(mapped);
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        if (size < FILE_HEADER || memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || get32(data + sizeof(MAGIC)) != RECORD_FORMAT)
+        {
+            munmap(mapped, size);
+            throw runtime_error("Not a record file: " + path);
+        }
+
+        for (size_t pos = FILE_HEADER; pos < size;)
+        {
+            size_t games = pos + BLOCK_HEADER <= size ? get32(data + pos) : 0;
+            size_t moves = games > 0 ? get32(data + pos + 4) : 0;
+            size_t blockSize = games > 0 ? get32(data + pos + 8) : 0;
+            if (games == 0 || blockSize < blockBytes(games, moves) || blockSize % 8 != 0 || pos + blockSize > size)
+            {
+                munmap(mapped, size);
+                throw runtime_error("Damaged record file: " + path);
+            }
+            offsets.push_back(pos);
+            gameCount += games;
+            pos += blockSize;
+        }
+    }
+
+    RecordFile::~RecordFile()
+    {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+
+    RecordBlock RecordFile::block(size_t index) const
+    {
+        const uint8_t *p = data + offsets[index];
+        RecordBlock block;
+        block.games = get32(p);
+        block.moves = get32(p + 4);
+        p += BLOCK_HEADER;
+        block.seed = reinterpret_cast<const uint64_t *>(p); // 8-aligned: the header and every block size are multiples of 8
+        p += block.games * 8;
+        block.length = reinterpret_cast<const uint16_t *>(p);
+        p += block.games * 2;
+        block.seats = p;
+        block.winner = (p += block.games);
+        block.roles = (p += block.games);
+        block.actor = (p += block.games * Game::MAX_PLAYERS);
+        block.action = (p += block.moves);
+        block.target = (p += block.moves);
+        block.option = (p += block.moves);
+        block.blocker = (p += block.moves);
+        return block;
+    }
+
+    /**
+     * splitmix64: the per-game random numbers (roles and block decisions) in a couple of instructions.
+     */
+    static uint64_t nextRandom(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    void recordGame(Game &game, RandomBot &bot, uint64_t seed, RecordBlockBuilder &out)
+    {
+        uint64_t random = seed;
+        vector<RoleType> layout(2 + nextRandom(random) % 5);
+        for (RoleType &role : layout)
+            role = static_cast<RoleType>(nextRandom(random) % ROLE_COUNT);
+        game.reset(seed, layout);
+        bot.reseed(seed);
+        out.begin(seed, game);
+
+        size_t seats = layout.size();
+        for (uint32_t moves = 0; !game.isOver() && moves < MAX_RECORDED_MOVES; ++moves)
+        {
+            uint8_t actor = static_cast<uint8_t>(game.turnSeat());
+            Move move = bot.choose(game);
+            uint8_t blocker = NO_SEAT;
+            for (size_t k = 1; k < seats && blocker == NO_SEAT; ++k)
+            {
+                size_t seat = (actor + k) % seats;
+                if (canBlock(game, seat, move) && nextRandom(random) % 2 == 0)
+                    blocker = static_cast<uint8_t>(seat);
+            }
+            applyMove(game, move);
+            if (blocker != NO_SEAT)
+            {
+                try
+                {
+                    applyBlock(game, blocker, actor, move);
+                }
+                catch (const invalid_argument &)
+                {
+                    blocker = NO_SEAT; // the rules refused the block
+                }
+            }
+            out.move(actor, move, blocker);
+        }
+        optional<size_t> winner = game.winnerSeat();
+        out.end(winner ? static_cast<uint8_t>(*winner) : NO_SEAT);
+    }
+
+    /**
+     * Each thread plays games i = t, t + threads, ... into its own block and writes the block when it is full.
+     */
+    uint64_t generateRecords(const string &path, uint64_t games, size_t threads, uint64_t seed)
+    {
+        RecordWriter writer(path);
+        threads = threads == 0 ? 1 : threads;
+        vector<thread> workers;
+        atomic<bool> failed{false};
+        for (size_t t = 0; t < threads; ++t)
+            workers.emplace_back([&, t]
+                                 {
+                try
+                {
+                    Game game;
+                    RandomBot bot(seed);
+                    RecordBlockBuilder block;
+                    for (uint64_t i = t; i < games; i += threads)
+                    {
+                        recordGame(game, bot, seed * 0x9E3779B97F4A7C15ULL + i + 1, block);
+                        if (block.full())
+                        {
+                            writer.write(block);
+                            block.clear();
+                        }
+                    }
+                    writer.write(block);
+                }
+                catch (const exception &)
+                {
+                    failed = true;
+                } });
+        for (thread &worker : workers)
+            worker.join();
+        if (failed)
+            throw runtime_error("Self-play failed while writing " + path);
+        return writer.games();
+    }
+}
@@ -0,0 +1,140 @@
+// ronamsalem4@gmail.com
+#ifndef RECORDS_HPP
+#define RECORDS_HPP
+#include "../game/Game.hpp"
+#include "../game/Moves.hpp"
+#include "../sim/RandomBot.hpp"
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file Records.hpp
+ * Binary records of finished games, for analytics (see Stats.hpp).
+ * A record file is "COUPRECS", u32 format, u32 reserved, then blocks of up to BLOCK_GAMES games stored by column:
+ *   header   u32 games, u32 moves, u32 block size in bytes (header included, a multiple of 8), u32 reserved
+ *   games    u64 seed[games], u16 length[games] (moves), u8 seats[games], u8 winner[games] (NO_SEAT: abandoned),
+ *            u8 roles[games * 6] (NO_SEAT after the last seat)
+ *   moves    u8 actor[moves], action[moves], target[moves], option[moves], blocker[moves] (NO_SEAT: not blocked),
+ *            the moves of each game in order, games one after the other
+ * Blocks are independent, so readers hand whole blocks to threads; columns let one statistic read only the bytes
+ * it needs. RecordFile maps the file and reads the columns in place.
+ */
+namespace coup
+{
+    static constexpr uint32_t RECORD_FORMAT = 2;
+    static constexpr size_t BLOCK_GAMES = 4096;          // Games per block at most.
+    static constexpr size_t BLOCK_MOVES = 1 << 20;       // Moves per block at most (a block ends early past this).
+    static constexpr uint32_t MAX_RECORDED_MOVES = 1000; // A self-play game still running after this many is abandoned.
+
+    /**
+     * The columns of one block, in place (pointers into the mapped file).
+     */
+    struct RecordBlock
+    {
+        uint32_t games = 0;
+        uint32_t moves = 0;
+        const uint64_t *seed = nullptr;
+        const uint16_t *length = nullptr;
+        const uint8_t *seats = nullptr;
+        const uint8_t *winner = nullptr;
+        const uint8_t *roles = nullptr; // 6 per game
+        const uint8_t *actor = nullptr;
+        const uint8_t *action = nullptr;
+        const uint8_t *target = nullptr;
+        const uint8_t *option = nullptr;
+        const uint8_t *blocker = nullptr;
+    };
+
+    /**
+     * Collects games into the columns of one block.
+     */
+    class RecordBlockBuilder
+    {
+    public:
+        void begin(uint64_t seed, const Game &game); // Starts the record of a dealt game (seats and roles).
+        void move(uint8_t actor, const Move &move, uint8_t blocker); // Adds a move of the game begun last.
+        void end(uint8_t winner);                    // Closes the game (NO_SEAT if it was abandoned).
+
+        bool full() const { return seed.size() >= BLOCK_GAMES || actor.size() >= BLOCK_MOVES; }
+        bool empty() const { return seed.empty(); }
+        size_t games() const { return seed.size(); }
+
+        void encode(vector<uint8_t> &out) const; // Appends the block in its file layout.
+        void clear();                            // Empties the columns (their storage is kept).
+
+    private:
+        vector<uint64_t> seed;
+        vector<uint16_t> length;
+        vector<uint8_t> seats, winner, roles, actor, action, target, option, blocker;
+    };
+
+    /**
+     * Appends blocks to a record file; write() may be called from several threads.
+     */
+    class RecordWriter
+    {
+    public:
+        /**
+         * @throws ---> runtime_error if the file cannot be created.
+         */
+        explicit RecordWriter(const string &path);
+
+        void write(const RecordBlockBuilder &block); // Appends a block (ignored if empty).
+        uint64_t games() const { return gameCount; } // @return ---> Games written so far.
+
+    private:
+        ofstream file;
+        mutex lock;
+        vector<uint8_t> buffer;
+        uint64_t gameCount = 0;
+    };
+
+    /**
+     * A record file mapped read-only; its blocks are found once when it is opened.
+     * Block sizes are checked, the values in the columns are not: record files are written by RecordWriter.
+     */
+    class RecordFile
+    {
+    public:
+        /**
+         * @throws ---> runtime_error if the file cannot be mapped, is not a record file, or a block is cut short.
+         */
+        explicit RecordFile(const string &path);
+        ~RecordFile();
+        RecordFile(const RecordFile &) = delete;
+        RecordFile &operator=(const RecordFile &) = delete;
+
+        size_t blocks() const { return offsets.size(); }
+        RecordBlock block(size_t index) const; // @return ---> The columns of a block, valid while the file is open.
+        uint64_t games() const { return gameCount; }
+
+    private:
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        vector<size_t> offsets;
+        uint64_t gameCount = 0;
+    };
+
+    /**
+     * Plays one self-play game with random bots and records it: random legal moves, and every player who may block
+     * a move is asked in turn order after the actor and blocks with probability 1/2 (the first block wins), as the
+     * server's table loop does.
+     * The game depends only on the seed (the bot is reseeded with it).
+     * @param game ---> Reused game; dealt 2 to 6 random roles from the seed.
+     * @param bot ---> Reused bot.
+     */
+    void recordGame(Game &game, RandomBot &bot, uint64_t seed, RecordBlockBuilder &out);
+
+    /**
+     * Writes self-play games to a record file, on several threads.
+     * @param games ---> How many games.
+     * @param seed ---> Seed of the whole run; game i is played from a seed derived from it.
+     * @return ---> Games written.
+     */
+    uint64_t generateRecords(const string &path, uint64_t games, size_t threads, uint64_t seed);
+}
+
+#endif
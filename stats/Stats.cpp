@@ -0,0 +1,182 @@
+// ronamsalem4@gmail.com
+#include "Stats.hpp"
+#include <atomic>
+#include <iomanip>
+#include <thread>
+
+namespace coup
+{
+    void GameStats::merge(const GameStats &other)
+    {
+        games += other.games;
+        abandoned += other.abandoned;
+        moves += other.moves;
+        for (size_t r = 0; r < ROLE_COUNT; ++r)
+            for (size_t s = 0; s < Game::MAX_PLAYERS; ++s)
+            {
+                played[r][s] += other.played[r][s];
+                won[r][s] += other.won[r][s];
+            }
+        for (size_t a = 0; a < ACTION_COUNT; ++a)
+        {
+            actions[a] += other.actions[a];
+            blocked[a] += other.blocked[a];
+        }
+        invests += other.invests;
+        barons += other.barons;
+        baronWins += other.baronWins;
+        investingBarons += other.investingBarons;
+        investingBaronWins += other.investingBaronWins;
+    }
+
+    static double share(uint64_t part, uint64_t whole)
+    {
+        return whole > 0 ? static_cast<double>(part) / whole : 0;
+    }
+
+    double GameStats::winRate(RoleType role) const
+    {
+        uint64_t games = 0, wins = 0;
+        for (size_t s = 0; s < Game::MAX_PLAYERS; ++s)
+        {
+            games += played[static_cast<size_t>(role)][s];
+            wins += won[static_cast<size_t>(role)][s];
+        }
+        return share(wins, games);
+    }
+
+    double GameStats::winRate(RoleType role, size_t seat) const
+    {
+        return share(won[static_cast<size_t>(role)][seat], played[static_cast<size_t>(role)][seat]);
+    }
+
+    double GameStats::blockRate(ActionType action) const
+    {
+        return share(blocked[static_cast<size_t>(action)], actions[static_cast<size_t>(action)]);
+    }
+
+    /**
+     * Two passes over the block: the game columns (seats, winner, roles) for the win rates, then the move columns
+     * game by game for the action counts and the Barons' invests.
+     * Win rates count only games with a winner.
+     */
+    void accumulate(GameStats &stats, const RecordBlock &block)
+    {
+        stats.games += block.games;
+        stats.moves += block.moves;
+        for (uint32_t g = 0; g < block.games; ++g)
+        {
+            uint8_t winner = block.winner[g];
+            if (winner == NO_SEAT)
+            {
+                ++stats.abandoned;
+                continue;
+            }
+            const uint8_t *roles = block.roles + g * Game::MAX_PLAYERS;
+            for (uint8_t s = 0; s < block.seats[g]; ++s)
+            {
+                ++stats.played[roles[s]][s];
+                stats.won[roles[s]][s] += s == winner;
+            }
+        }
+
+        const uint8_t *action = block.action, *actor = block.actor, *blocker = block.blocker;
+        for (uint32_t g = 0; g < block.games; ++g)
+        {
+            uint8_t invested = 0; // bit per seat
+            uint32_t invests = 0;
+            for (uint16_t m = 0; m < block.length[g]; ++m)
+            {
+                ++stats.actions[action[m]];
+                stats.blocked[action[m]] += blocker[m] != NO_SEAT;
+                if (action[m] == static_cast<uint8_t>(ActionType::Invest))
+                {
+                    invested |= static_cast<uint8_t>(1u << actor[m]);
+                    ++invests;
+                }
+            }
+            action += block.length[g];
+            actor += block.length[g];
+            blocker += block.length[g];
+
+            uint8_t winner = block.winner[g];
+            if (winner == NO_SEAT)
+                continue;
+            stats.invests += invests;
+            const uint8_t *roles = block.roles + g * Game::MAX_PLAYERS;
+            for (uint8_t s = 0; s < block.seats[g]; ++s)
+            {
+                if (roles[s] != static_cast<uint8_t>(RoleType::Baron))
+                    continue;
+                bool investor = (invested >> s) & 1;
+                ++stats.barons;
+                stats.baronWins += s == winner;
+                stats.investingBarons += investor;
+                stats.investingBaronWins += investor && s == winner;
+            }
+        }
+    }
+
+    /**
+     * Threads take blocks from a shared counter, so a slow block does not hold the others up.
+     */
+    GameStats aggregate(const RecordFile &file, size_t threads)
+    {
+        threads = threads == 0 ? 1 : threads;
+        vector<GameStats> partial(threads);
+        atomic<size_t> next{0};
+        vector<thread> workers;
+        for (size_t t = 0; t < threads; ++t)
+            workers.emplace_back([&file, &next, &partial, t]
+                                 {
+                GameStats local; // on the worker's own stack: no sharing of cache lines while summing
+                for (size_t b; (b = next.fetch_add(1, memory_order_relaxed)) < file.blocks();)
+                    accumulate(local, file.block(b));
+                partial[t] = local; });
+        for (thread &worker : workers)
+            worker.join();
+
+        GameStats total;
+        for (const GameStats &stats : partial)
+            total.merge(stats);
+        return total;
+    }
+
+    void printStats(ostream &out, const GameStats &stats)
+    {
+        out << fixed << setprecision(1);
+        out << stats.games << " games (" << stats.abandoned << " abandoned), " << stats.averageLength()
+            << " moves per game on average\n\n";
+
+        out << "Win rate by role and seat (%)\n" << setw(10) << "";
+        for (size_t s = 0; s < Game::MAX_PLAYERS; ++s)
+            out << setw(8) << ("seat " + to_string(s + 1));
+        out << setw(8) << "all" << "\n";
+        for (size_t r = 0; r < ROLE_COUNT; ++r)
+        {
+            RoleType role = static_cast<RoleType>(r);
+            out << setw(10) << roleName(role);
+            for (size_t s = 0; s < Game::MAX_PLAYERS; ++s)
+                out << setw(8) << 100 * stats.winRate(role, s);
+            out << setw(8) << 100 * stats.winRate(role) << "\n";
+        }
+
+        auto blockLine = [&](const char *what, ActionType action)
+        {
+            size_t a = static_cast<size_t>(action);
+            out << what << stats.blocked[a] << " of " << stats.actions[a] << " (" << 100 * stats.blockRate(action) << "%)\n";
+        };
+        out << "\n";
+        blockLine("Coups blocked by a General (player saved): ", ActionType::Coup);
+        blockLine("Bribes cancelled by a Judge:               ", ActionType::Bribe);
+        blockLine("Taxes undone by a Governor:                ", ActionType::Tax);
+
+        double investingRate = share(stats.investingBaronWins, stats.investingBarons);
+        double otherRate = share(stats.baronWins - stats.investingBaronWins, stats.barons - stats.investingBarons);
+        out << "\nBaron invest: " << share(stats.invests, stats.barons) << " invests per Baron, win rate "
+            << 100 * investingRate << "% when investing vs " << 100 * otherRate << "% without";
+        if (otherRate > 0)
+            out << " (return " << showpos << 100 * (investingRate / otherRate - 1) << noshowpos << "%)";
+        out << "\n";
+    }
+}
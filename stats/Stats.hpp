@@ -0,0 +1,50 @@
+// ronamsalem4@gmail.com
+#ifndef STATS_HPP
+#define STATS_HPP
+#include "Records.hpp"
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @file Stats.hpp
+ * Statistics over a record file (see Records.hpp): win rate by role and seat, game length, how often each action
+ * is blocked (a General saving a player from a coup, a Judge cancelling a bribe, a Governor undoing a tax) and what
+ * investing does for a Baron.
+ * aggregate() hands the blocks of the file to threads; each thread sums into its own GameStats, reading only the
+ * columns it needs, and the partial sums are merged at the end.
+ */
+namespace coup
+{
+    struct GameStats
+    {
+        uint64_t games = 0;
+        uint64_t abandoned = 0; // games without a winner (too long)
+        uint64_t moves = 0;
+        uint64_t played[ROLE_COUNT][Game::MAX_PLAYERS] = {}; // games by role and seat
+        uint64_t won[ROLE_COUNT][Game::MAX_PLAYERS] = {};
+        uint64_t actions[ACTION_COUNT] = {}; // moves by action
+        uint64_t blocked[ACTION_COUNT] = {}; // of those, blocked by another player
+        uint64_t invests = 0;                                // in games with a winner
+        uint64_t barons = 0, baronWins = 0;                 // Baron seats in games with a winner
+        uint64_t investingBarons = 0, investingBaronWins = 0; // those that invested at least once
+
+        void merge(const GameStats &other); // Adds another partial sum.
+
+        double winRate(RoleType role) const;            // @return ---> Share of the role's games it won (any seat).
+        double winRate(RoleType role, size_t seat) const; // @return ---> Share of the role's games from a seat it won.
+        double blockRate(ActionType action) const;      // @return ---> Share of the action's moves that were blocked.
+        double averageLength() const { return games > 0 ? static_cast<double>(moves) / games : 0; }
+    };
+
+    void accumulate(GameStats &stats, const RecordBlock &block); // Adds the games of one block.
+
+    /**
+     * Sums a whole record file.
+     * @param threads ---> Worker threads (at least 1).
+     */
+    GameStats aggregate(const RecordFile &file, size_t threads);
+
+    void printStats(ostream &out, const GameStats &stats); // Writes the statistics as a readable report.
+}
+
+#endif
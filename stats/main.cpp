@@ -0,0 +1,67 @@
+// ronamsalem4@gmail.com
+#include "Stats.hpp"
+#include "../game/Logger.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ * coup_stats: writes self-play game records and computes statistics over them.
+ * Usage: coup_stats --file=games.rec [--generate=N] [--threads=N] [--seed=1]
+ * With --generate the file is first filled with N new games; the statistics are then read back from it.
+ */
+
+using namespace coup;
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    string path = "games.rec";
+    uint64_t generate = 0, seed = 1;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int a = 1; a < argc; ++a)
+    {
+        string arg = argv[a];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--file")
+            path = value;
+        else if (key == "--generate")
+            generate = stoull(value);
+        else if (key == "--threads")
+            threads = std::max<size_t>(1, stoul(value));
+        else if (key == "--seed")
+            seed = stoull(value);
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 2;
+        }
+    }
+    Logger::instance().setLevel(LogLevel::Off); // the rules log every move of the self-play games
+
+    try
+    {
+        if (generate > 0)
+        {
+            auto start = chrono::steady_clock::now();
+            generateRecords(path, generate, threads, seed);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cerr << "wrote " << generate << " games to " << path << " in " << seconds << " s" << endl;
+        }
+        auto start = chrono::steady_clock::now();
+        RecordFile file(path);
+        GameStats stats = aggregate(file, threads);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printStats(cout, stats);
+        cerr << "read " << stats.games << " games in " << seconds << " s ("
+             << (seconds > 0 ? stats.games / seconds / 1e6 : 0) << " M games/s, " << threads << " threads)" << endl;
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
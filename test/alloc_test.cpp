@@ -0,0 +1,191 @@
+// ronamsalem4@gmail.com
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "../game/Player.hpp"
+#include "../roles/Governor.hpp"
+#include "../roles/Spy.hpp"
+#include "../roles/Baron.hpp"
+#include "../roles/General.hpp"
+#include "../roles/Judge.hpp"
+#include "../roles/Merchant.hpp"
+#include "../game/Game.hpp"
+#include "../game/Logger.hpp"
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace std;
+using namespace coup;
+
+/**
+ * Allocation guard for the engine's hot paths.
+ * This test binary replaces the global operator new/delete with counting versions, so every heap
+ * allocation made by the engine while a turn is played is visible.
+ * The steady-state turn loop (gather / tax / arrest / coup until one player is left) must not allocate at all.
+ * It is built as its own binary ("make alloc_test") because the replaced operators are process-wide.
+ */
+
+static size_t allocationCount = 0;
+
+static void *countedAlloc(size_t size)
+{
+    ++allocationCount;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+static void *countedAlignedAlloc(size_t size, std::align_val_t align)
+{
+    ++allocationCount;
+    size_t a = static_cast<size_t>(align);
+    size_t rounded = (size + a - 1) / a * a;
+    if (void *p = std::aligned_alloc(a, rounded == 0 ? a : rounded))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size) { return countedAlloc(size); }
+void *operator new[](size_t size) { return countedAlloc(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    ++allocationCount;
+    return std::malloc(size == 0 ? 1 : size);
+}
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    ++allocationCount;
+    return std::malloc(size == 0 ? 1 : size);
+}
+void *operator new(size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void *operator new[](size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+/**
+ * Counts the allocations made while running the given callable.
+ */
+template <typename F>
+static size_t allocationsDuring(F &&f)
+{
+    size_t before = allocationCount;
+    f();
+    return allocationCount - before;
+}
+
+/**
+ * Makes sure the hooks really see allocations, so a "zero" below means something.
+ */
+TEST_CASE("Allocation hooks are active")
+{
+    Game game;
+    Governor governor(game, "A name too long for the small string buffer");
+    Spy spy(game, "Another name too long for the small string buffer");
+    CHECK(allocationsDuring([&]
+                            { vector<string> names = game.players(); }) > 0);
+}
+
+/**
+ * Plays a whole 6-player game with the steady-state actions and checks that none of them allocates.
+ * Names are longer than the small string buffer on purpose, so any copy of a name would be counted.
+ */
+TEST_CASE("Steady-state turn loop does not allocate")
+{
+    Logger::instance().setLevel(LogLevel::Off); // coup logs; run silent like a batch simulation
+
+    Game game;
+    Governor governor(game, "Governor in the first seat");
+    Spy spy(game, "Spy sitting in the second seat");
+    Baron baron(game, "Baron sitting in the third seat");
+    General general(game, "General sitting in the fourth seat");
+    Judge judge(game, "Judge sitting in the fifth seat");
+    Merchant merchant(game, "Merchant sitting in the sixth seat");
+    Player *seats[] = {&governor, &spy, &baron, &general, &judge, &merchant};
+    const size_t n = 6;
+
+    enum
+    {
+        GATHER,
+        TAX,
+        ARREST,
+        COUP,
+        QUERY,
+        KINDS
+    };
+    const char *kindNames[KINDS] = {"gather", "tax", "arrest", "coup", "isPlayerTurn/turnName"};
+    size_t allocs[KINDS] = {0, 0, 0, 0, 0};
+    size_t counts[KINDS] = {0, 0, 0, 0, 0};
+
+    int alive = 6;
+    for (int turn = 0; alive > 1; ++turn)
+    {
+        size_t cur = 0;
+        string_view current;
+        allocs[QUERY] += allocationsDuring([&]
+                                           {
+                                               while (!game.isPlayerTurn(*seats[cur])) ++cur;
+                                               current = game.turnName(); });
+        ++counts[QUERY];
+        Player &p = *seats[cur];
+        REQUIRE(current == p.GetNameView());
+
+        if (p.coins() >= 7)
+        {
+            size_t t = (cur + 1) % n;
+            while (!seats[t]->Getstillingame())
+                t = (t + 1) % n;
+            allocs[COUP] += allocationsDuring([&]
+                                              { p.coup(*seats[t]); });
+            ++counts[COUP];
+            --alive;
+            continue;
+        }
+
+        if (turn % 3 == 0)
+        {
+            Player *target = nullptr;
+            for (size_t k = 1; k < n && target == nullptr; ++k)
+            {
+                Player *q = seats[(cur + k) % n];
+                int needed = (q == &merchant) ? 2 : 1;
+                if (q->Getstillingame() && q->coins() >= needed && q != game.getLastArrestedVictim())
+                    target = q;
+            }
+            if (target != nullptr)
+            {
+                allocs[ARREST] += allocationsDuring([&]
+                                                    { p.arrest(*target); });
+                ++counts[ARREST];
+                continue;
+            }
+        }
+
+        if (turn % 3 == 1)
+        {
+            allocs[GATHER] += allocationsDuring([&]
+                                                { p.gather(); });
+            ++counts[GATHER];
+        }
+        else
+        {
+            allocs[TAX] += allocationsDuring([&]
+                                             { p.tax(); });
+            ++counts[TAX];
+        }
+    }
+    Logger::instance().setLevel(LogLevel::Info);
+
+    CHECK(alive == 1);
+    for (int k = 0; k < KINDS; ++k)
+    {
+        MESSAGE(string(kindNames[k]) << ": " << counts[k] << " calls, " << allocs[k] << " allocations");
+        CHECK(counts[k] > 0);
+        CHECK_MESSAGE(allocs[k] == 0, string(kindNames[k]) << " allocated on the steady-state path");
+    }
+}
@@ -9,6 +9,25 @@
 #include "../roles/Judge.hpp"
 #include "../roles/Merchant.hpp"
 #include "../game/Game.hpp"
+#include "../game/GamePool.hpp"
+#include "../game/GameSave.hpp"
+#include "../game/Logger.hpp"
+#include "../GUI/PromptQueue.hpp"
+#include "../game/Moves.hpp"
+#include "../sim/Simulator.hpp"
+#include "../sim/TripleBuffer.hpp"
+#include "../server/Server.hpp"
+#include "../server/Client.hpp"
+#include "../server/LoadGen.hpp"
+#include "../stats/Stats.hpp"
+#include "../book/OpeningBook.hpp"
+#include "../endgame/Tablebase.hpp"
+#include "../nn/Gemm.hpp"
+#include "../nn/MctsBot.hpp"
+#include "../nn/Training.hpp"
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
 #include <exception>
 #include <iostream>
 #include <stdexcept>
@@ -17,6 +36,19 @@
 using namespace std;
 using namespace coup;
 
+/**
+ * Silences the rules code's log for the lifetime of the guard (long runs of bots, servers, searches) and
+ * restores the previous level when the test case ends, even if a REQUIRE aborts it.
+ */
+struct QuietLogger
+{
+    LogLevel previous = Logger::instance().getLevel();
+    QuietLogger() { Logger::instance().setLevel(LogLevel::Off); }
+    ~QuietLogger() { Logger::instance().setLevel(previous); }
+    QuietLogger(const QuietLogger &) = delete;
+    QuietLogger &operator=(const QuietLogger &) = delete;
+};
+
 /**
  * This test checks the situation where there is only one player in the game.
  */
@@ -741,3 +773,1472 @@ TEST_CASE("Governor tax gives 3 coins")
     spy.tax();
     CHECK(spy.coins() == 2);
 }
+
+/**
+ * Players created with Game::emplace live in the game's arena and follow the normal turn order.
+ */
+TEST_CASE("Players owned by the game (emplace)")
+{
+    Game game;
+    Governor &governor = game.emplace<Governor>("Ron");
+    Spy &spy = game.emplace<Spy>("Or");
+    Baron &baron = game.emplace<Baron>("Shir");
+    CHECK(game.players() == vector<string>{"Ron", "Or", "Shir"});
+    CHECK(game.turn() == "Ron");
+    governor.tax();
+    spy.tax();
+    baron.tax();
+    CHECK(governor.coins() == 3);
+    CHECK(spy.coins() == 2);
+    CHECK(baron.coins() == 2);
+    CHECK(game.turn() == "Ron");
+
+    game.emplace<General>("Yoram");
+    game.emplace<Judge>("Tali");
+    game.emplace<Merchant>("Dor");
+    CHECK_THROWS(game.emplace<Spy>("Boba"));
+}
+
+/**
+ * clear() empties the game and the next players reuse the same arena memory.
+ */
+TEST_CASE("Clearing a game reuses its arena")
+{
+    Game game;
+    Player *first = &game.emplace<Governor>("Ron");
+    Spy &spy = game.emplace<Spy>("Or");
+    first->tax();
+    spy.gather();
+    CHECK(first->coins() == 3);
+
+    game.clear();
+    CHECK(game.players().empty());
+    CHECK_THROWS(game.winner());
+
+    Merchant &merchant = game.emplace<Merchant>("Dor");
+    Judge &judge = game.emplace<Judge>("Tali");
+    CHECK(static_cast<Player *>(&merchant) == first);
+    CHECK(merchant.coins() == 0);
+    CHECK(game.turn() == "Dor");
+    merchant.tax();
+    judge.tax();
+    CHECK(merchant.coins() == 2);
+    CHECK(judge.coins() == 2);
+}
+
+/**
+ * reset() with the same layout keeps the player objects and restores all of their state in place.
+ */
+TEST_CASE("Reset a finished game in place")
+{
+    Game game;
+    Governor &governor = game.emplace<Governor>("Ron");
+    Spy &spy = game.emplace<Spy>("Or");
+    Baron &baron = game.emplace<Baron>("Shir");
+    governor.tax();
+    spy.tax();
+    baron.tax();
+    governor.tax();
+    spy.tax();
+    baron.tax();
+    governor.tax();
+    spy.gather();
+    baron.gather();
+    governor.coup(spy);
+    CHECK(game.turn() == "Shir");
+
+    game.reset(42, {RoleType::Governor, RoleType::Spy, RoleType::Baron});
+    CHECK(game.getSeed() == 42);
+    CHECK(game.players() == vector<string>{"Ron", "Or", "Shir"});
+    CHECK(game.turn() == "Ron");
+    CHECK(spy.Getstillingame());
+    CHECK(governor.coins() == 0);
+    CHECK(spy.coins() == 0);
+    CHECK(baron.coins() == 0);
+    CHECK(governor.GetLastAction().empty());
+    governor.tax();
+    spy.tax();
+    CHECK(governor.coins() == 3);
+    CHECK(spy.coins() == 2);
+    CHECK(game.turn() == "Shir");
+
+    // A different layout keeps the matching seats and rebuilds the others in place.
+    game.reset(7, {RoleType::Governor, RoleType::Judge});
+    CHECK(game.players() == vector<string>{"Ron", "Or"});
+    CHECK(governor.coins() == 0);
+    CHECK(game.turn() == "Ron");
+    governor.tax();
+    CHECK(game.turn() == "Or");
+    CHECK_THROWS(game.reset(1, vector<RoleType>(7, RoleType::Spy)));
+}
+
+/**
+ * Caller-owned players can be reset in place but not rebuilt.
+ */
+TEST_CASE("Reset with caller-owned players")
+{
+    Game game;
+    Governor governor(game, "Ron");
+    Spy spy(game, "Or");
+    governor.tax();
+    game.reset(1, {RoleType::Governor, RoleType::Spy});
+    CHECK(governor.coins() == 0);
+    CHECK(game.turn() == "Ron");
+    CHECK_THROWS(game.reset(1, {RoleType::Governor, RoleType::Judge}));
+}
+
+/**
+ * The game pool lends out the same Game again after it is returned.
+ */
+TEST_CASE("Game pool reuses games")
+{
+    GamePool pool;
+    vector<RoleType> layout = {RoleType::Governor, RoleType::Spy, RoleType::Merchant};
+    Game *first = nullptr;
+    {
+        GamePool::Handle game = pool.acquire(1, layout);
+        first = game.get();
+        CHECK(game->players() == vector<string>{"Player 1", "Player 2", "Player 3"});
+        CHECK(pool.available() == 0);
+    }
+    CHECK(pool.available() == 1);
+    GamePool::Handle again = pool.acquire(2, layout);
+    CHECK(again.get() == first);
+    CHECK(again->getSeed() == 2);
+    CHECK(pool.size() == 1);
+
+    pool.prewarm(3, layout);
+    CHECK(pool.available() == 3);
+    CHECK(pool.size() == 4);
+}
+
+/**
+ * Names are interned per game: players refer to them by seat and can be read without copies.
+ */
+TEST_CASE("Interned player names")
+{
+    Game game;
+    Governor governor(game, "Miran");
+    Spy spy(game, "Diana");
+    Judge judge(game, "Dana");
+    CHECK(governor.GetSeat() == 0);
+    CHECK(judge.GetSeat() == 2);
+    CHECK(spy.GetNameView() == "Diana");
+    CHECK(game.nameOf(2) == "Dana");
+    CHECK(game.turnName() == "Miran");
+    CHECK(game.turnSeat() == 0);
+    CHECK(&governor.GetName() == &game.nameRef(0));
+    CHECK_THROWS(game.nameOf(3));
+
+    // The name-based extra turn functions still work and share state with the seat-based ones.
+    game.addExtraTurns("Miran", 1);
+    CHECK(game.hasExtraTurn(governor.GetSeat()));
+    governor.tax();
+    CHECK(game.turnName() == "Miran");
+    CHECK_FALSE(game.hasExtraTurn("Miran"));
+    governor.tax();
+    CHECK(game.turnName() == "Diana");
+
+    CHECK_THROWS_AS(game.addExtraTurns("Nobody", 1), invalid_argument);
+    CHECK_THROWS_AS(game.addExtraTurns(3, 1), out_of_range);
+    CHECK_THROWS_AS(game.removeExtraTurns(Game::MAX_PLAYERS), out_of_range);
+    CHECK_FALSE(game.hasExtraTurn(3));
+}
+
+/**
+ * Copying a player copies its name and coins but not its seat: a copy is outside the game, and assignment keeps the
+ * assigned player's own seat, so eliminating either never touches the original.
+ */
+TEST_CASE("Player copies do not share the original's seat")
+{
+    Game game;
+    Governor governor(game, "Miran");
+    Spy spy(game, "Diana");
+    Judge judge(game, "Dana");
+    governor.AddCoins(3);
+
+    Governor copy(governor);
+    CHECK(copy.GetName() == "Miran");
+    CHECK(copy.coins() == 3);
+    CHECK(copy.GetSeat() == NO_SEAT);
+    copy.eliminated();
+    CHECK_FALSE(copy.Getstillingame());
+    CHECK(governor.Getstillingame());
+    CHECK(game.players() == vector<string>{"Miran", "Diana", "Dana"});
+    CHECK(game.alivePlayers() == 3);
+
+    Governor second(game, "Ron");
+    second = governor;
+    CHECK(second.GetSeat() == 3);
+    CHECK(second.GetName() == "Miran");
+    CHECK(second.coins() == 3);
+    second.eliminated();
+    CHECK(game.players() == vector<string>{"Miran", "Diana", "Dana"});
+    CHECK(game.alivePlayers() == 3);
+    CHECK(game.nameOf(governor.GetSeat()) == "Miran");
+}
+
+/**
+ * The event bus: events are queued in order and delivered by poll(); nothing is published without subscribers.
+ */
+TEST_CASE("Game events")
+{
+    Game game;
+    Governor governor(game, "Miran");
+    Spy spy(game, "Diana");
+    General general(game, "Dana");
+
+    governor.tax();
+    CHECK(game.events().published() == 0); // nobody listens yet
+
+    vector<GameEvent> seen;
+    game.events().subscribe([&](const GameEvent &e)
+                            { seen.push_back(e); });
+    spy.gather();
+    CHECK(seen.empty()); // delivered only by poll()
+    CHECK(game.events().poll() == 2);
+    REQUIRE(seen.size() == 2);
+    CHECK(seen[0].type == EventType::ActionPerformed);
+    CHECK(seen[0].action == ActionType::Gather);
+    CHECK(seen[0].actor == spy.GetSeat());
+    CHECK(seen[0].target == NO_SEAT);
+    CHECK(seen[0].coins == 1);
+    CHECK(seen[1].type == EventType::TurnAdvanced);
+    CHECK(seen[1].actor == general.GetSeat());
+    CHECK(seen[1].sequence == 1);
+
+    seen.clear();
+    general.AddCoins(5);
+    general.gather();
+    governor.AddCoins(4);
+    governor.coup(spy);
+    general.BlockCoup(spy);
+    game.events().poll();
+    REQUIRE(seen.size() == 7);
+    CHECK(seen[2].action == ActionType::Coup);
+    CHECK(seen[2].actor == governor.GetSeat());
+    CHECK(seen[2].target == spy.GetSeat());
+    CHECK(seen[2].coins == 0);
+    CHECK(seen[3].type == EventType::Eliminated);
+    CHECK(seen[3].actor == governor.GetSeat());
+    CHECK(seen[3].target == spy.GetSeat());
+    CHECK(seen[4].type == EventType::TurnAdvanced);
+    CHECK(seen[4].actor == general.GetSeat());
+    CHECK(seen[5].type == EventType::Blocked);
+    CHECK(seen[5].action == ActionType::Coup);
+    CHECK(seen[5].target == spy.GetSeat());
+    CHECK(seen[6].actor == spy.GetSeat()); // the returned player plays next
+}
+
+/**
+ * Events delivered by the bus's dispatcher thread, including more events than the ring holds.
+ */
+TEST_CASE("Game events on a dispatcher thread")
+{
+    Game game;
+    Governor governor(game, "Miran");
+    Spy spy(game, "Diana");
+    size_t delivered = 0;
+    game.events().subscribe([&](const GameEvent &)
+                            { ++delivered; });
+    game.events().startDispatcher();
+    CHECK_THROWS_AS(game.events().subscribe([](const GameEvent &) {}), logic_error);
+
+    for (size_t i = 0; i < EventBus::CAPACITY; ++i)
+    {
+        governor.gather();
+        spy.gather();
+        governor.DecreaseCoins(1);
+        spy.DecreaseCoins(1);
+    }
+    game.events().flush();
+    CHECK(delivered == 4 * EventBus::CAPACITY);
+    game.events().stopDispatcher();
+    CHECK(game.events().published() == 4 * EventBus::CAPACITY);
+}
+
+/**
+ * Without a dispatcher a full ring drops (and counts) events instead of delivering them on the game thread;
+ * clear() and returning a pooled game forget the subscribers and the queued events.
+ */
+TEST_CASE("Event bus overflow, clear and pooled games")
+{
+    Game game;
+    Governor governor(game, "Miran");
+    Spy spy(game, "Diana");
+    size_t delivered = 0;
+    game.events().subscribe([&](const GameEvent &)
+                            { ++delivered; });
+    for (size_t i = 0; i < EventBus::CAPACITY; ++i)
+    {
+        governor.gather();
+        spy.gather();
+        governor.DecreaseCoins(1);
+        spy.DecreaseCoins(1);
+    }
+    CHECK(delivered == 0); // the producer never consumes
+    CHECK(game.events().published() == 4 * EventBus::CAPACITY);
+    CHECK(game.events().dropped() == 3 * EventBus::CAPACITY);
+    CHECK(game.events().poll() == EventBus::CAPACITY);
+    CHECK(delivered == EventBus::CAPACITY);
+
+    governor.gather();
+    game.clear();
+    CHECK_FALSE(game.events().hasSubscribers());
+    CHECK(game.events().published() == 0);
+    CHECK(game.events().dropped() == 0);
+    CHECK(game.events().poll() == 0);
+    CHECK(delivered == EventBus::CAPACITY);
+
+    GamePool pool;
+    vector<RoleType> layout = {RoleType::Governor, RoleType::Spy};
+    {
+        GamePool::Handle pooled = pool.acquire(1, layout);
+        pooled->events().subscribe([&](const GameEvent &)
+                                   { ++delivered; });
+        applyMove(*pooled, Move{ActionType::Gather, NO_SEAT, 0});
+    }
+    GamePool::Handle again = pool.acquire(2, layout);
+    CHECK_FALSE(again->events().hasSubscribers());
+    CHECK(again->events().poll() == 0);
+    CHECK(delivered == EventBus::CAPACITY);
+}
+
+/**
+ * The rules code logs through the Logger: messages go to the sink, can be filtered out, and can be
+ * written by the background thread.
+ */
+TEST_CASE("Logger levels, sink and background writer")
+{
+    Logger &logger = Logger::instance();
+    vector<string> lines;
+    logger.setSink([&](LogLevel, string_view text)
+                   { lines.emplace_back(text); });
+
+    Game game;
+    Governor governor(game, "Miran");
+    Spy spy(game, "Diana");
+    spy.watchCoins(governor);
+    REQUIRE(lines.size() == 1);
+    CHECK(lines[0] == "Miran has 0 coins");
+
+    logger.setLevel(LogLevel::Off); // silent run
+    spy.watchCoins(governor);
+    logger.log(LogLevel::Error, "dropped");
+    CHECK(lines.size() == 1);
+
+    logger.setLevel(LogLevel::Warn);
+    logger.log(LogLevel::Info, "dropped");
+    logger.log(LogLevel::Warn, "seat ", 3, " of ", size_t(6));
+    CHECK(lines.back() == "seat 3 of 6");
+    logger.setLevel(LogLevel::Info);
+
+    lines.clear();
+    logger.start();
+    CHECK(logger.isRunning());
+    for (int i = 0; i < 3 * int(Logger::QUEUE_SIZE); ++i)
+        logger.log(LogLevel::Info, "line ", i);
+    logger.flush();
+    logger.stop();
+    CHECK_FALSE(logger.isRunning());
+    REQUIRE(lines.size() == 3 * Logger::QUEUE_SIZE);
+    CHECK(lines.front() == "line 0");
+    CHECK(lines.back() == "line " + to_string(3 * Logger::QUEUE_SIZE - 1));
+
+    logger.log(LogLevel::Info, string(2 * Logger::LINE_SIZE, 'x'));
+    CHECK(lines.back().size() == Logger::LINE_SIZE);
+    logger.setSink(nullptr);
+}
+
+/**
+ * The alive set is maintained incrementally: players(), winner() and isOver() follow eliminations and returns.
+ */
+TEST_CASE("Alive players are tracked incrementally")
+{
+    Game game;
+    CHECK_FALSE(game.isOver());
+    Governor &governor = game.emplace<Governor>("Miran");
+    Spy &spy = game.emplace<Spy>("Diana");
+    General &general = game.emplace<General>("Dana");
+    CHECK(game.alivePlayers() == 3);
+    const vector<string> &names = game.players();
+    CHECK(names == vector<string>{"Miran", "Diana", "Dana"});
+    CHECK(&game.players() == &names); // the same cached list, not a new vector
+
+    game.eliminatePlayer(&spy);
+    CHECK(game.players() == vector<string>{"Miran", "Dana"});
+    CHECK(game.alivePlayers() == 2);
+    CHECK_FALSE(game.isOver());
+    game.returnPlayer(&spy);
+    CHECK(game.players() == vector<string>{"Miran", "Diana", "Dana"});
+
+    governor.AddCoins(14);
+    governor.coup(spy);
+    general.gather();
+    governor.coup(general);
+    CHECK(game.isOver());
+    CHECK(game.alivePlayers() == 1);
+    CHECK(game.winner() == "Miran");
+    CHECK(game.players() == vector<string>{"Miran"});
+
+    game.reset(1, {RoleType::Governor, RoleType::Spy});
+    CHECK_FALSE(game.isOver());
+    CHECK(game.players() == vector<string>{"Miran", "Diana"});
+    game.clear();
+    CHECK(game.players().empty());
+    CHECK(game.alivePlayers() == 0);
+}
+
+/**
+ * tryWinner() never throws, and the end of the game is published as a GameOver event.
+ */
+TEST_CASE("Non-throwing winner and game over event")
+{
+    Game game;
+    CHECK_FALSE(game.tryWinner().has_value());
+    Governor governor(game, "Miran");
+    Spy spy(game, "Diana");
+    Judge judge(game, "Dana");
+    vector<GameEvent> over;
+    game.events().subscribe([&](const GameEvent &e)
+                            { if (e.type == EventType::GameOver) over.push_back(e); });
+
+    CHECK_FALSE(game.tryWinner().has_value());
+    CHECK_FALSE(game.winnerSeat().has_value());
+    governor.AddCoins(14);
+    governor.coup(spy);
+    game.events().poll();
+    CHECK(over.empty());
+    CHECK_FALSE(game.tryWinner().has_value());
+    judge.gather();
+    governor.coup(judge);
+    game.events().poll();
+    REQUIRE(over.size() == 1);
+    CHECK(over[0].actor == governor.GetSeat());
+    CHECK(over[0].coins == 0);
+    REQUIRE(game.tryWinner().has_value());
+    CHECK(*game.tryWinner() == "Miran");
+    CHECK(game.winnerSeat() == optional<size_t>(0));
+    CHECK(game.winner() == "Miran");
+}
+
+/**
+ * In-window questions of the GUI: answered by a click, by the default after the timeout, or instantly by a bot seat.
+ */
+TEST_CASE("Prompt queue answers, timeouts and bots")
+{
+    Game game;
+    General general(game, "Reut");
+    Judge judge(game, "Gilad");
+    PromptQueue prompts(chrono::milliseconds(100));
+    vector<size_t> answers;
+    auto record = [&](size_t choice)
+    { answers.push_back(choice); };
+
+    CHECK_FALSE(prompts.active());
+    CHECK_THROWS_AS(prompts.ask(&general, "Block?", {"yes", "no"}, 2, record), invalid_argument);
+    prompts.ask(&general, "Block?", {"yes", "no"}, 1, record);
+    prompts.ask(&judge, "Block?", {"yes", "no"}, 1, record);
+    REQUIRE(prompts.active());
+    CHECK(prompts.current().who == &general);
+    CHECK(answers.empty()); // asking never waits for the answer
+    CHECK_THROWS_AS(prompts.answer(2), out_of_range);
+    prompts.answer(0);
+    CHECK(answers == vector<size_t>{0});
+    CHECK(prompts.current().who == &judge);
+
+    CHECK_FALSE(prompts.update(PromptQueue::Clock::now()));
+    CHECK(prompts.secondsLeft() == 1);
+    CHECK(prompts.update(PromptQueue::Clock::now() + chrono::seconds(1))); // timed out: default answer
+    CHECK(answers == vector<size_t>{0, 1});
+    CHECK_FALSE(prompts.active());
+
+    prompts.setBot(&judge, [](const PromptQueue::Prompt &)
+                   { return size_t(0); });
+    prompts.ask(&judge, "Block?", {"yes", "no"}, 1, record);
+    CHECK_FALSE(prompts.active()); // the bot answered at once
+    CHECK(answers.back() == 0);
+}
+
+/**
+ * legalMoves lists exactly what the rules allow, and every listed move can be applied.
+ */
+TEST_CASE("Legal moves of the current player")
+{
+    Game game;
+    Baron &baron = game.emplace<Baron>("Meirav");
+    Merchant &merchant = game.emplace<Merchant>("Dana");
+    Judge &judge = game.emplace<Judge>("Gilad");
+
+    MoveList moves = legalMoves(game);
+    CHECK(moves.contains(Move{ActionType::Gather, NO_SEAT, 0}));
+    CHECK(moves.contains(Move{ActionType::Tax, NO_SEAT, 0}));
+    CHECK_FALSE(moves.contains(Move{ActionType::Bribe, NO_SEAT, 0}));                          // no coins yet
+    CHECK_FALSE(moves.contains(Move{ActionType::Arrest, static_cast<uint8_t>(merchant.GetSeat()), 0})); // nothing to take
+
+    baron.AddCoins(3);
+    merchant.AddCoins(2);
+    moves = legalMoves(game);
+    CHECK(moves.contains(Move{ActionType::Invest, NO_SEAT, 0}));
+    CHECK(moves.contains(Move{ActionType::Arrest, static_cast<uint8_t>(merchant.GetSeat()), 0}));
+    CHECK(moves.contains(Move{ActionType::Sanction, static_cast<uint8_t>(merchant.GetSeat()), 1}));
+    CHECK_FALSE(moves.contains(Move{ActionType::Sanction, static_cast<uint8_t>(judge.GetSeat()), 0})); // a Judge costs 4
+
+    applyMove(game, Move{ActionType::Sanction, static_cast<uint8_t>(merchant.GetSeat()), 0});
+    CHECK(game.turnSeat() == merchant.GetSeat());
+    CHECK_FALSE(legalMoves(game).contains(Move{ActionType::Gather, NO_SEAT, 0})); // sanctioned from gather
+    CHECK_THROWS(applyMove(game, Move{ActionType::Gather, NO_SEAT, 0}));
+
+    merchant.AddCoins(1);
+    CHECK(legalMoves(game).contains(Move{ActionType::Bribe, NO_SEAT, 0})); // 3 coins and the Merchant's bonus pay for it
+
+    merchant.AddCoins(10);
+    moves = legalMoves(game);
+    for (const Move &m : moves)
+        CHECK(m.action == ActionType::Coup); // 10 coins: coup is mandatory
+    CHECK(moves.size() == 2);
+}
+
+/**
+ * Blocks answer a move through the role functions: who may block what, and what a block undoes.
+ */
+TEST_CASE("Blocking moves through the move API")
+{
+    QuietLogger quiet;
+    Game game;
+    Spy &spy = game.emplace<Spy>("Yossi");
+    Governor &governor = game.emplace<Governor>("Moshe");
+    Judge &judge = game.emplace<Judge>("Gilad");
+    General &general = game.emplace<General>("Reut");
+
+    Move tax{ActionType::Tax, NO_SEAT, 0};
+    CHECK(canBlock(game, governor.GetSeat(), tax));
+    CHECK_FALSE(canBlock(game, judge.GetSeat(), tax));
+    applyMove(game, tax);
+    applyBlock(game, governor.GetSeat(), spy.GetSeat(), tax);
+    CHECK(spy.coins() == 0);
+    CHECK(game.turnSeat() == governor.GetSeat()); // the tax still used the turn
+
+    governor.AddCoins(4);
+    Move bribe{ActionType::Bribe, NO_SEAT, 0};
+    CHECK(canBlock(game, judge.GetSeat(), bribe));
+    CHECK_FALSE(canBlock(game, governor.GetSeat(), bribe)); // nobody blocks their own move
+    applyMove(game, bribe);
+    applyBlock(game, judge.GetSeat(), governor.GetSeat(), bribe);
+    CHECK(governor.coins() == 0);
+    CHECK(game.turnSeat() == judge.GetSeat()); // the extra turn is gone
+
+    judge.AddCoins(7);
+    Move coup{ActionType::Coup, static_cast<uint8_t>(spy.GetSeat()), 0};
+    CHECK_FALSE(canBlock(game, general.GetSeat(), coup)); // a General needs 5 coins
+    general.AddCoins(5);
+    CHECK(canBlock(game, general.GetSeat(), coup));
+    CHECK_FALSE(canBlock(game, general.GetSeat(), Move{ActionType::Coup, static_cast<uint8_t>(general.GetSeat()), 0}));
+    applyMove(game, coup);
+    CHECK_FALSE(spy.Getstillingame());
+    applyBlock(game, general.GetSeat(), judge.GetSeat(), coup);
+    CHECK(spy.Getstillingame());
+    CHECK(general.coins() == 0);
+    CHECK_THROWS_AS(applyBlock(game, spy.GetSeat(), judge.GetSeat(), coup), invalid_argument);
+}
+
+/**
+ * Random legal play always finishes: every listed move is accepted by the rules.
+ */
+TEST_CASE("Random bots play complete games through the move API")
+{
+    QuietLogger quiet;
+    Game game;
+    for (uint64_t seed = 1; seed <= 200; ++seed)
+    {
+        game.reset(seed, {RoleType::Governor, RoleType::Spy, RoleType::Baron, RoleType::General, RoleType::Judge, RoleType::Merchant});
+        RandomBot bot(seed);
+        size_t moves = 0;
+        while (!game.isOver() && moves < 20000)
+        {
+            Move move = bot.choose(game);
+            REQUIRE_NOTHROW(applyMove(game, move));
+            ++moves;
+        }
+        CHECK(game.isOver());
+    }
+}
+
+/**
+ * A game restored from an image mid-game goes on exactly like the original: same moves accepted, same state after
+ * each of them.
+ */
+TEST_CASE("Game images restore a game in progress")
+{
+    QuietLogger quiet;
+    vector<RoleType> roles = {RoleType::Governor, RoleType::Spy, RoleType::Baron, RoleType::General, RoleType::Judge, RoleType::Merchant};
+    for (uint64_t seed = 1; seed <= 50; ++seed)
+    {
+        Game original;
+        original.reset(seed, roles);
+        RandomBot bot(seed);
+        for (size_t moves = 0; moves < seed % 30 && !original.isOver(); ++moves)
+            applyMove(original, bot.choose(original));
+
+        GameImage image, copyImage;
+        original.captureImage(image);
+        Game copy;
+        copy.restoreImage(image);
+        copy.captureImage(copyImage);
+        REQUIRE(memcmp(&image, &copyImage, sizeof(GameImage)) == 0);
+        CHECK(copy.getSeed() == seed);
+
+        RandomBot first(seed + 1000), second(seed + 1000);
+        size_t moves = 0;
+        while (!original.isOver() && moves++ < 20000)
+        {
+            Move move = first.choose(original);
+            REQUIRE(second.choose(copy) == move);
+            applyMove(original, move);
+            REQUIRE_NOTHROW(applyMove(copy, move));
+            original.captureImage(image);
+            copy.captureImage(copyImage);
+            REQUIRE(memcmp(&image, &copyImage, sizeof(GameImage)) == 0);
+        }
+        CHECK(copy.isOver());
+    }
+
+    GameImage bad;
+    bad.numSeats = 7;
+    Game game;
+    CHECK_THROWS_AS(game.restoreImage(bad), invalid_argument);
+}
+
+/**
+ * A save is read where it lies (even unaligned), loads into a game with another seating, and rejects buffers that
+ * are cut short or from a newer format.
+ */
+TEST_CASE("Game saves load from a buffer")
+{
+    QuietLogger quiet;
+    Game original;
+    original.reset(9, {RoleType::Baron, RoleType::Judge, RoleType::Merchant});
+    original.setName(0, "Meirav");
+    original.setName(1, "Dana");
+    RandomBot bot(9);
+    for (int moves = 0; moves < 12 && !original.isOver(); ++moves)
+        applyMove(original, bot.choose(original));
+
+    vector<uint8_t> buffer(1, 0); // one byte ahead: the saves are not aligned
+    size_t first = saveGame(original, buffer);
+    Game other;
+    other.reset(1, {RoleType::Spy, RoleType::General});
+    size_t second = saveGame(other, buffer);
+    CHECK(buffer.size() == 1 + first + second);
+
+    SaveView save(buffer.data() + 1, buffer.size() - 1);
+    CHECK(save.format() == SAVE_FORMAT);
+    CHECK(save.size() == first);
+    CHECK(save.numSeats() == 3);
+    CHECK(save.name(0) == "Meirav");
+    CHECK(save.name(2) == "Player 3");
+    CHECK_THROWS_AS(save.name(3), out_of_range);
+    SaveView next(buffer.data() + 1 + save.size(), second);
+    CHECK(next.numSeats() == 2);
+
+    Game loaded;
+    loaded.reset(4, {RoleType::Spy, RoleType::General});
+    loadGame(loaded, save);
+    GameImage a, b;
+    original.captureImage(a);
+    loaded.captureImage(b);
+    CHECK(memcmp(&a, &b, sizeof(GameImage)) == 0);
+    CHECK(loaded.getPlayer(0).GetName() == "Meirav");
+    CHECK(loaded.turn() == original.turn());
+    CHECK(loaded.players() == original.players());
+    while (!original.isOver())
+    {
+        Move move = bot.choose(original);
+        applyMove(original, move);
+        REQUIRE_NOTHROW(applyMove(loaded, move));
+    }
+    CHECK(loaded.winner() == original.winner());
+
+    CHECK_THROWS_AS(SaveView(buffer.data() + 1, first - 1), invalid_argument);
+    CHECK_THROWS_AS(SaveView(buffer.data(), buffer.size()), invalid_argument);
+    vector<uint8_t> newer(buffer.begin() + 1, buffer.begin() + 1 + first);
+    newer[8] = SAVE_FORMAT + 1;
+    CHECK_THROWS_AS(SaveView(newer.data(), newer.size()), invalid_argument);
+}
+
+/**
+ * The triple buffer hands the newest complete value to the reader, skipping older ones.
+ */
+TEST_CASE("Triple buffer handoff")
+{
+    TripleBuffer<int> buffer;
+    CHECK_FALSE(buffer.update());
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.back() = 2;
+    buffer.publish();
+    CHECK(buffer.update());
+    CHECK(buffer.front() == 2);
+    CHECK_FALSE(buffer.update());
+    CHECK(buffer.front() == 2);
+
+    // One writer thread, one reader: the reader only ever sees increasing, complete values.
+    TripleBuffer<pair<int, int>> pairs;
+    thread writer([&]
+                  {
+                      for (int i = 1; i <= 100000; ++i)
+                      {
+                          pairs.back() = {i, -i};
+                          pairs.publish();
+                      } });
+    int last = 0;
+    bool consistent = true;
+    while (last < 100000)
+    {
+        if (pairs.update())
+        {
+            consistent = consistent && pairs.front().first > last && pairs.front().second == -pairs.front().first;
+            last = pairs.front().first;
+        }
+    }
+    writer.join();
+    CHECK(consistent);
+}
+
+/**
+ * The simulator plays its tables and publishes snapshots of them.
+ */
+TEST_CASE("Simulator tables and snapshots")
+{
+    QuietLogger quiet;
+    Simulator sim(4, 2, 7);
+    const GameState &first = sim.latest(0);
+    CHECK(first.numSeats >= 3);
+    CHECK(first.version == 0);
+    for (int i = 0; i < 2000; ++i)
+        for (size_t t = 0; t < sim.tables(); ++t)
+            sim.step(t);
+    CHECK(sim.movesPlayed() > 0);
+    CHECK(sim.gamesFinished() > 0);
+    bool changed = false;
+    const GameState &state = sim.latest(2, &changed);
+    CHECK(changed);
+    CHECK(state.version > 0);
+    CHECK(state.turn < state.numSeats);
+
+    sim.start();
+    uint64_t before = sim.movesPlayed();
+    while (sim.movesPlayed() < before + 1000)
+        this_thread::yield();
+    sim.stop();
+}
+
+/**
+ * Frames survive an encode / decode round trip, and a partial frame is not decoded.
+ */
+TEST_CASE("Server protocol frames")
+{
+    vector<uint8_t> buffer;
+    encodeJoin(buffer, 42, 4, RoleType::Judge, "Gilad");
+    encodeAct(buffer, 7, Move{ActionType::Sanction, 2, 1});
+    size_t first = frameSize(buffer.data(), buffer.size());
+    REQUIRE(first > 0);
+    CHECK(frameSize(buffer.data(), first - 1) == 0);
+
+    Message message;
+    decode(buffer.data(), first, message);
+    CHECK(message.type == MsgType::Join);
+    CHECK(message.table == 42);
+    CHECK(message.tableSize == 4);
+    CHECK(message.role == RoleType::Judge);
+    CHECK(message.text == "Gilad");
+    decode(buffer.data() + first, buffer.size() - first, message);
+    CHECK(message.type == MsgType::Act);
+    CHECK(message.tag == 7);
+    CHECK(message.move == Move{ActionType::Sanction, 2, 1});
+
+    buffer.clear();
+    encodeAsk(buffer, 9, 3, Move{ActionType::Coup, 1, 0});
+    encodeReact(buffer, true);
+    first = frameSize(buffer.data(), buffer.size());
+    decode(buffer.data(), first, message);
+    CHECK(message.type == MsgType::Ask);
+    CHECK(message.table == 9);
+    CHECK(message.seat == 3);
+    CHECK(message.move == Move{ActionType::Coup, 1, 0});
+    decode(buffer.data() + first, buffer.size() - first, message);
+    CHECK(message.type == MsgType::React);
+    CHECK(message.block);
+
+    vector<uint8_t> bad = {0xFF, 0xFF, 1};
+    CHECK_THROWS_AS(frameSize(bad.data(), bad.size()), invalid_argument);
+    vector<uint8_t> truncated = {2, 0, static_cast<uint8_t>(MsgType::Act)};
+    CHECK_THROWS_AS(decode(truncated.data(), truncated.size(), message), invalid_argument);
+}
+
+/**
+ * Two clients and an observer on a table of a 2-shard server, over 127.0.0.1: a whole game and the next deal.
+ */
+TEST_CASE("Game server over loopback")
+{
+    QuietLogger quiet;
+    Server server(0, 2);
+    server.start();
+
+    Client governor, spy, observer, late;
+    governor.connect(server.port());
+    spy.connect(server.port());
+    governor.join(7, 2, RoleType::Governor, "Moshe");
+    CHECK(governor.expect(MsgType::Joined).seat == 0);
+    spy.join(7, 2, RoleType::Spy, "Yossi");
+    CHECK(spy.expect(MsgType::Joined).seat == 1);
+
+    observer.connect(server.port());
+    observer.observe(7);
+    Message state = observer.expect(MsgType::State);
+    CHECK(state.state.numSeats == 2);
+    CHECK(state.state.turn == 0);
+
+    late.connect(server.port());
+    late.join(7, 2, RoleType::Baron, "Meirav");
+    CHECK(late.expect(MsgType::Error).status == Status::TableFull);
+
+    spy.act(1, Move{ActionType::Gather, NO_SEAT, 0});
+    CHECK(spy.expect(MsgType::Result).status == Status::NotYourTurn);
+    governor.act(2, Move{ActionType::Coup, 1, 0});
+    CHECK(governor.expect(MsgType::Result).status == Status::IllegalMove);
+
+    // Gather until 7 coins, then the Governor (first to 7) coups the Spy.
+    uint32_t tag = 10;
+    for (int round = 0; round < 7; ++round)
+    {
+        governor.act(tag, Move{ActionType::Gather, NO_SEAT, 0});
+        Message result = governor.expect(MsgType::Result);
+        CHECK(result.tag == tag++);
+        CHECK(result.status == Status::Ok);
+        spy.act(tag++, Move{ActionType::Gather, NO_SEAT, 0});
+        CHECK(spy.expect(MsgType::Result).status == Status::Ok);
+    }
+    governor.act(tag, Move{ActionType::Coup, 1, 0});
+    CHECK(governor.expect(MsgType::Result).status == Status::Ok);
+
+    // The observer saw every move; the last two states are the won game and the next deal.
+    uint64_t version = 0;
+    Message last;
+    while (version < 15)
+    {
+        last = observer.expect(MsgType::State);
+        version = last.state.version;
+    }
+    CHECK(last.state.winner == 0);
+    CHECK(last.move == Move{ActionType::Coup, 1, 0});
+    CHECK_FALSE(last.state.seats[1].alive);
+    Message next = observer.expect(MsgType::State);
+    CHECK(next.state.gamesPlayed == 1);
+    CHECK(next.state.winner == NO_SEAT);
+    CHECK(next.state.seats[1].alive);
+    CHECK(next.state.seats[0].coins == 0);
+
+    CHECK(server.actions() == 15);
+    CHECK(server.games() == 1);
+    CHECK(server.connections() == 4);
+    server.stop();
+}
+
+/**
+ * The table loop suspends for the Governor's answer to a tax: a block, then silence until the reaction timeout.
+ */
+TEST_CASE("Server asks the players who can block")
+{
+    QuietLogger quiet;
+    Server server(0, 1, chrono::milliseconds(100));
+    server.start();
+
+    Client spy, governor;
+    spy.connect(server.port());
+    governor.connect(server.port());
+    spy.join(3, 2, RoleType::Spy, "Yossi");
+    spy.expect(MsgType::Joined);
+    governor.join(3, 2, RoleType::Governor, "Moshe");
+    governor.expect(MsgType::Joined);
+    auto stateAt = [](Client &client, uint64_t version)
+    {
+        Message m = client.expect(MsgType::State);
+        while (m.state.version < version)
+            m = client.expect(MsgType::State);
+        return m;
+    };
+
+    spy.react(false);
+    CHECK(spy.expect(MsgType::Error).status == Status::NotAsked);
+
+    spy.act(1, Move{ActionType::Tax, NO_SEAT, 0});
+    CHECK(spy.expect(MsgType::Result).status == Status::Ok);
+    Message ask = governor.expect(MsgType::Ask);
+    CHECK(ask.seat == 0);
+    CHECK(ask.move.action == ActionType::Tax);
+    spy.act(2, Move{ActionType::Gather, NO_SEAT, 0});
+    CHECK(spy.expect(MsgType::Result).status == Status::NotYourTurn); // the tax is still waiting for the answer
+    governor.react(true);
+    Message blocked = stateAt(spy, 1);
+    CHECK(blocked.seat == 1);
+    CHECK(blocked.state.seats[0].coins == 0);
+    CHECK(blocked.state.turn == 1);
+
+    governor.act(3, Move{ActionType::Gather, NO_SEAT, 0});
+    CHECK(governor.expect(MsgType::Result).status == Status::Ok);
+    spy.act(4, Move{ActionType::Tax, NO_SEAT, 0});
+    CHECK(spy.expect(MsgType::Result).status == Status::Ok);
+    governor.expect(MsgType::Ask); // no answer: the tax stands after the timeout
+    Message passed = stateAt(spy, 3);
+    CHECK(passed.seat == NO_SEAT);
+    CHECK(passed.state.seats[0].coins == 2);
+
+    server.stop();
+}
+
+/**
+ * Tables rebuilt from the journal after the server goes away: same state, seats taken back by name, on another
+ * number of shards, and a torn record at the end of a journal ignored.
+ */
+TEST_CASE("Server journal survives a restart")
+{
+    QuietLogger quiet;
+    string dir = (std::filesystem::temp_directory_path() / ("coup_journal_" + to_string(getpid()))).string();
+    std::filesystem::remove_all(dir);
+    auto stateAt = [](Client &client, uint64_t version)
+    {
+        Message m = client.expect(MsgType::State);
+        while (m.state.version < version)
+            m = client.expect(MsgType::State);
+        return m;
+    };
+
+    Message before;
+    {
+        Server server(0, 2, chrono::milliseconds(100), dir);
+        server.start();
+        Client spy, governor;
+        spy.connect(server.port());
+        governor.connect(server.port());
+        spy.join(5, 2, RoleType::Spy, "Yossi");
+        spy.expect(MsgType::Joined);
+        governor.join(5, 2, RoleType::Governor, "Moshe");
+        governor.expect(MsgType::Joined);
+        spy.act(1, Move{ActionType::Tax, NO_SEAT, 0});
+        governor.expect(MsgType::Ask);
+        governor.react(true);
+        governor.act(2, Move{ActionType::Gather, NO_SEAT, 0});
+        CHECK(governor.expect(MsgType::Result).status == Status::Ok);
+        spy.act(3, Move{ActionType::Gather, NO_SEAT, 0});
+        before = stateAt(spy, 3); // sent only once the moves were committed
+        server.stop();
+    }
+
+    {
+        Server server(0, 3, chrono::milliseconds(100), dir);
+        CHECK(server.tables() == 1);
+        server.start();
+        Client observer, spy, governor;
+        observer.connect(server.port());
+        observer.observe(5);
+        Message after = observer.expect(MsgType::State);
+        CHECK(after.state.version == 3);
+        CHECK(after.state.turn == 1);
+        CHECK(after.state.seats[0].coins == before.state.seats[0].coins);
+        CHECK(after.state.seats[1].coins == before.state.seats[1].coins);
+
+        spy.connect(server.port());
+        spy.join(5, 2, RoleType::Spy, "Yossi");
+        CHECK(spy.expect(MsgType::Joined).seat == 0);
+        governor.connect(server.port());
+        governor.join(5, 2, RoleType::Governor, "Moshe");
+        CHECK(governor.expect(MsgType::Joined).seat == 1);
+        governor.act(4, Move{ActionType::Gather, NO_SEAT, 0});
+        CHECK(governor.expect(MsgType::Result).status == Status::Ok);
+        CHECK(stateAt(observer, 4).state.seats[1].coins == 2);
+        server.stop();
+    }
+
+    std::ofstream(dir + "/journal-2-2-0.wal", ios::app | ios::binary) << string("\x20\x00\x01", 3); // torn record
+    {
+        Server server(0, 1, chrono::milliseconds(100), dir);
+        server.start();
+        Client observer;
+        observer.connect(server.port());
+        observer.observe(5);
+        CHECK(observer.expect(MsgType::State).state.version == 4);
+        server.stop();
+    }
+    std::filesystem::remove_all(dir);
+}
+
+/**
+ * A write that fails (here: a segment on /dev/full) latches the journal: neither the lost records nor any record
+ * appended after them are ever reported durable, even once the segments are writable again.
+ */
+TEST_CASE("Journal stops acknowledging after a failed write")
+{
+    QuietLogger quiet;
+    string dir = (std::filesystem::temp_directory_path() / ("coup_failing_journal_" + to_string(getpid()))).string();
+    std::filesystem::create_directories(dir);
+    auto waitFor = [](const function<bool()> &done)
+    {
+        for (int i = 0; i < 2000 && !done(); ++i)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        return done();
+    };
+    JournalRecord record;
+    record.kind = JournalRecord::Close;
+    record.table = 1;
+    {
+        Journal journal(dir + "/a.wal", chrono::milliseconds(1), -1);
+        journal.append(record);
+        REQUIRE(waitFor([&]
+                        { return journal.durable() == 1; }));
+        CHECK_FALSE(journal.failed());
+
+        journal.rotate("/dev/full");
+        journal.append(record);
+        REQUIRE(waitFor([&]
+                        { return journal.failed(); }));
+        CHECK(journal.durable() == 1);
+
+        journal.rotate(dir + "/b.wal");
+        journal.append(record);
+        journal.append(record);
+        this_thread::sleep_for(chrono::milliseconds(20));
+        CHECK(journal.appended() == 4);
+        CHECK(journal.durable() == 1);
+    }
+    CHECK(readJournal(dir + "/a.wal", [](const JournalRecord &) {}) == 1);
+    CHECK(readJournal(dir + "/b.wal", [](const JournalRecord &) {}) == 0);
+    std::filesystem::remove_all(dir);
+}
+
+/**
+ * With snapshots the journal is cut into segments: a restart reads the last snapshot and the segment after it, and a
+ * damaged snapshot stops the server from starting rather than losing tables.
+ */
+TEST_CASE("Server snapshots shorten recovery")
+{
+    QuietLogger quiet;
+    string dir = (std::filesystem::temp_directory_path() / ("coup_snapshot_" + to_string(getpid()))).string();
+    std::filesystem::remove_all(dir);
+    auto stateAt = [](Client &client, uint64_t version)
+    {
+        Message m = client.expect(MsgType::State);
+        while (m.state.version < version)
+            m = client.expect(MsgType::State);
+        return m;
+    };
+    auto files = [&dir](const string &prefix)
+    {
+        size_t count = 0;
+        for (const auto &file : std::filesystem::directory_iterator(dir))
+            count += file.path().filename().string().rfind(prefix, 0) == 0;
+        return count;
+    };
+
+    Message before;
+    {
+        Server server(0, 1, chrono::milliseconds(100), dir, chrono::milliseconds(20));
+        server.start();
+        Client spy, governor, waiting;
+        spy.connect(server.port());
+        governor.connect(server.port());
+        waiting.connect(server.port());
+        waiting.join(8, 3, RoleType::Judge, "Dana"); // a table that is not full yet
+        waiting.expect(MsgType::Joined);
+        spy.join(5, 2, RoleType::Spy, "Yossi");
+        spy.expect(MsgType::Joined);
+        governor.join(5, 2, RoleType::Governor, "Moshe");
+        governor.expect(MsgType::Joined);
+        spy.act(1, Move{ActionType::Tax, NO_SEAT, 0});
+        governor.expect(MsgType::Ask);
+        governor.react(false);
+        stateAt(spy, 1);
+        while (server.snapshots() < 2)
+            this_thread::sleep_for(chrono::milliseconds(5));
+        governor.act(2, Move{ActionType::Gather, NO_SEAT, 0});
+        CHECK(governor.expect(MsgType::Result).status == Status::Ok);
+        before = stateAt(spy, 2);
+        server.stop();
+    }
+    CHECK(files("snapshot-") == 1);
+    CHECK(files("journal-") == 1); // the segments before the snapshot are gone
+
+    {
+        Server server(0, 2, chrono::milliseconds(100), dir, chrono::seconds(60));
+        CHECK(server.tables() == 2);
+        server.start();
+        Client observer;
+        observer.connect(server.port());
+        observer.observe(5);
+        Message after = observer.expect(MsgType::State);
+        CHECK(after.state.version == 2);
+        CHECK(after.state.turn == 0);
+        CHECK(after.state.seats[0].coins == before.state.seats[0].coins);
+        CHECK(after.state.seats[1].coins == before.state.seats[1].coins);
+        Client late;
+        late.connect(server.port());
+        late.join(8, 3, RoleType::Baron, "Meirav");
+        CHECK(late.expect(MsgType::Joined).seat == 1);
+        server.stop();
+    }
+    CHECK(files("snapshot-2-") == 2);
+
+    std::string snapshot = dir + "/snapshot-2-1-0.snap";
+    std::filesystem::resize_file(snapshot, std::filesystem::file_size(snapshot) - 1);
+    CHECK_THROWS_AS(Server(0, 1, chrono::milliseconds(100), dir), runtime_error);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Load generator against a local server")
+{
+    QuietLogger quiet;
+    Server server(0, 2);
+    server.start();
+
+    LoadGenConfig config;
+    config.port = server.port();
+    config.tables = 8;
+    config.seats = 3;
+    config.threads = 2;
+    config.duration = chrono::milliseconds(300);
+    LoadGenReport report = runLoad(config);
+
+    CHECK(report.connections == 24);
+    CHECK(report.actions > 0);
+    CHECK(report.rejected == 0); // the clients replay the STATEs with the same rules, so every move is legal
+    CHECK(report.p50Ns <= report.p99Ns);
+    CHECK(report.p99Ns <= report.maxNs);
+    CHECK(server.actions() >= report.actions);
+
+    config.seats = 7;
+    CHECK_THROWS_AS(runLoad(config), invalid_argument);
+    server.stop();
+}
+
+/**
+ * Records written by several threads read back by column: every game replays to its recorded winner, and the
+ * statistics do not depend on how many threads sum them.
+ */
+TEST_CASE("Game records and statistics")
+{
+    QuietLogger quiet;
+    string path = (std::filesystem::temp_directory_path() / ("coup_records_" + to_string(getpid()) + ".rec")).string();
+    CHECK(generateRecords(path, 300, 3, 7) == 300);
+
+    RecordFile file(path);
+    CHECK(file.games() == 300);
+    Game game;
+    uint64_t games = 0, moves = 0;
+    for (size_t b = 0; b < file.blocks(); ++b)
+    {
+        RecordBlock block = file.block(b);
+        CHECK(reinterpret_cast<uintptr_t>(block.seed) % alignof(uint64_t) == 0);
+        size_t m = 0;
+        for (uint32_t g = 0; g < block.games; ++g, ++games)
+        {
+            vector<RoleType> layout;
+            for (uint8_t s = 0; s < block.seats[g]; ++s)
+                layout.push_back(static_cast<RoleType>(block.roles[g * Game::MAX_PLAYERS + s]));
+            CHECK((block.seats[g] == 6 || block.roles[g * Game::MAX_PLAYERS + block.seats[g]] == NO_SEAT));
+            game.reset(block.seed[g], layout);
+            for (uint16_t k = 0; k < block.length[g]; ++k, ++m)
+            {
+                REQUIRE(game.turnSeat() == block.actor[m]);
+                Move move{static_cast<ActionType>(block.action[m]), block.target[m], block.option[m]};
+                applyMove(game, move);
+                if (block.blocker[m] != NO_SEAT)
+                    applyBlock(game, block.blocker[m], block.actor[m], move);
+            }
+            CHECK(game.winnerSeat().value_or(NO_SEAT) == block.winner[g]);
+        }
+        moves += m;
+        CHECK(m == block.moves);
+    }
+    CHECK(games == 300);
+
+    GameStats one = aggregate(file, 1), three = aggregate(file, 3);
+    CHECK(one.games == 300);
+    CHECK(one.moves == moves);
+    CHECK(memcmp(&one, &three, sizeof(GameStats)) == 0);
+    uint64_t decided = 0, wins = 0;
+    for (size_t r = 0; r < ROLE_COUNT; ++r)
+        for (size_t s = 0; s < Game::MAX_PLAYERS; ++s)
+        {
+            wins += one.won[r][s];
+            decided += s == 0 ? one.played[r][s] : 0;
+        }
+    CHECK(wins == one.games - one.abandoned);
+    CHECK(decided == one.games - one.abandoned); // every game has a seat 1
+    CHECK(one.blocked[static_cast<size_t>(ActionType::Gather)] == 0);
+    CHECK(one.investingBarons <= one.barons);
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    CHECK_THROWS_AS(RecordFile{path}, runtime_error);
+    std::filesystem::remove(path);
+}
+
+/**
+ * The opening book holds one searched move per position of its first plies, the same on any number of threads,
+ * and a bot plays from it until the game leaves the book.
+ */
+TEST_CASE("Opening book lookups")
+{
+    QuietLogger quiet;
+    vector<RoleType> layout = {RoleType::Governor, RoleType::Spy, RoleType::Baron, RoleType::General, RoleType::Judge, RoleType::Merchant};
+    vector<BookEntry> entries = buildOpeningBook(layout, 4, 4, 1, 3);
+    vector<BookEntry> threaded = buildOpeningBook(layout, 4, 4, 3, 3);
+    REQUIRE(entries.size() == threaded.size());
+    CHECK(memcmp(entries.data(), threaded.data(), entries.size() * sizeof(BookEntry)) == 0);
+    CHECK(std::is_sorted(entries.begin(), entries.end(), [](const BookEntry &a, const BookEntry &b)
+                         { return a.key < b.key; }));
+
+    string path = (std::filesystem::temp_directory_path() / ("coup_book_" + to_string(getpid()) + ".book")).string();
+    writeOpeningBook(path, entries);
+    {
+        OpeningBook book(path);
+        CHECK(book.size() == entries.size());
+        for (const BookEntry &entry : entries)
+        {
+            const BookEntry *found = book.find(entry.key);
+            REQUIRE(found != nullptr);
+            CHECK(memcmp(found, &entry, sizeof(BookEntry)) == 0);
+        }
+        CHECK(book.find(entries.back().key + 1) == nullptr);
+
+        Game game;
+        game.reset(42, layout);
+        Game other;
+        other.reset(7, layout);
+        CHECK(positionKey(game) == positionKey(other)); // the seed is not part of the position
+        BookBot bot(book, 1, 2);
+        for (int ply = 0; ply < 4; ++ply)
+        {
+            optional<Move> expected = book.lookup(game);
+            REQUIRE(expected.has_value());
+            Move move = bot.choose(game);
+            CHECK(move == *expected);
+            applyMove(game, move);
+        }
+        CHECK(bot.bookMoves() == 4);
+        CHECK_FALSE(book.lookup(game).has_value()); // past the book's depth
+        applyMove(game, bot.choose(game));
+        CHECK(bot.bookMoves() == 4);
+    }
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    CHECK_THROWS_AS(OpeningBook{path}, runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Endgame tablebase plays endings perfectly")
+{
+    QuietLogger quiet;
+    vector<uint8_t> entries = buildTablebase(1, {RoleType::Governor, RoleType::Judge});
+    vector<uint8_t> threaded = buildTablebase(3, {RoleType::Judge, RoleType::Governor});
+    CHECK(entries == threaded);
+
+    string path = (std::filesystem::temp_directory_path() / ("coup_tb_" + to_string(getpid()) + ".tb")).string();
+    writeTablebase(path, entries);
+    {
+        Tablebase tables(path);
+        Game game;
+        game.reset(1, {RoleType::Governor, RoleType::Judge});
+        GameImage image;
+        game.captureImage(image);
+        image.seats[0].coins = 7; // a coup wins on the spot
+        game.restoreImage(image);
+        optional<EndgameProbe> probe = tables.probe(game);
+        REQUIRE(probe.has_value());
+        CHECK(probe->result == EndgameResult::Win);
+        CHECK(probe->distance == 1);
+
+        // The same ending after a third player was eliminated: seats and turn order do not matter.
+        Game three;
+        three.reset(1, {RoleType::Judge, RoleType::Spy, RoleType::Governor});
+        GameImage wide;
+        three.captureImage(wide);
+        wide.seats[1].flags = 0;
+        wide.turn = 2;
+        wide.seats[2].coins = 7;
+        three.restoreImage(wide);
+        REQUIRE(tables.probe(three).has_value());
+        CHECK(tables.probe(three)->distance == 1);
+        wide.seats[1].flags = SeatImage::InGame;
+        three.restoreImage(wide);
+        CHECK_FALSE(tables.probe(three).has_value()); // three players left
+
+        Game other;
+        other.reset(1, {RoleType::Baron, RoleType::Spy});
+        CHECK_FALSE(tables.probe(other).has_value()); // a pair that was not built
+
+        // From positions of random games, the side the table gives the win wins within the distance, whatever the
+        // other side plays and blocks.
+        RandomBot random(5);
+        EndgameBot bot(tables, 2, 1);
+        std::mt19937 blocks(11);
+        Game playout;
+        size_t checked = 0;
+        for (uint64_t seed = 1; seed <= 20; ++seed)
+        {
+            game.reset(seed, {seed % 2 ? RoleType::Governor : RoleType::Judge, RoleType::Judge});
+            for (int ply = 0; ply < 60 && !game.isOver(); ++ply)
+            {
+                optional<EndgameProbe> start = tables.probe(game);
+                if (start && start->result != EndgameResult::Draw && ply % 3 == 0)
+                {
+                    game.captureImage(image);
+                    playout.restoreImage(image);
+                    size_t winner = start->result == EndgameResult::Win ? game.turnSeat() : 1 - game.turnSeat();
+                    for (unsigned moves = 0; moves < start->distance && !playout.isOver(); ++moves)
+                    {
+                        size_t actor = playout.turnSeat(), other = 1 - actor;
+                        Move move = actor == winner ? bot.choose(playout) : random.choose(playout);
+                        bool block = other == winner ? bot.block(playout, other, move)
+                                                     : canBlock(playout, other, move) && blocks() % 2 == 0;
+                        applyMove(playout, move);
+                        if (block)
+                            applyBlock(playout, 1 - actor, actor, move);
+                    }
+                    REQUIRE(playout.isOver());
+                    CHECK(playout.winnerSeat() == winner);
+                    ++checked;
+                }
+                applyMove(game, random.choose(game));
+            }
+        }
+        CHECK(checked > 50);
+        CHECK(bot.tableMoves() > 0);
+    }
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    CHECK_THROWS_AS(Tablebase{path}, runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Network evaluator: kernels, batching queue, search and training data")
+{
+    QuietLogger quiet;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> uniform(-1, 1);
+    GemmKernel original = gemmKernel();
+    if (gemmSupported(GemmKernel::Avx2))
+    {
+        // Every row count exercises the 6-row blocks and the tails; 40 columns end with an 8-wide block, 45 and 5
+        // with columns no vector covers.
+        for (size_t cols : {40, 128, 45, 5})
+            for (size_t rows = 1; rows <= 13; ++rows)
+            {
+                vector<float> x(rows * FEATURE_COUNT), w(FEATURE_COUNT * cols), bias(cols), scalar(rows * cols), avx2(rows * cols);
+                for (vector<float> *v : {&x, &w, &bias})
+                    for (float &value : *v)
+                        value = uniform(rng);
+                setGemmKernel(GemmKernel::Scalar);
+                gemm(x.data(), w.data(), bias.data(), scalar.data(), rows, FEATURE_COUNT, cols, true);
+                setGemmKernel(GemmKernel::Avx2);
+                gemm(x.data(), w.data(), bias.data(), avx2.data(), rows, FEATURE_COUNT, cols, true);
+                for (size_t i = 0; i < scalar.size(); ++i)
+                    CHECK(avx2[i] == doctest::Approx(scalar[i]).epsilon(1e-4));
+            }
+    }
+    else
+        CHECK_THROWS_AS(setGemmKernel(GemmKernel::Avx2), invalid_argument);
+    setGemmKernel(original);
+
+    vector<RoleType> layout = {RoleType::Governor, RoleType::Spy, RoleType::Baron, RoleType::General, RoleType::Judge, RoleType::Merchant};
+    Network network(5);
+    Game game;
+    game.reset(1, layout);
+    RandomBot random(2);
+    vector<float> features(10 * FEATURE_COUNT);
+    for (size_t i = 0; i < 10; ++i)
+    {
+        encodeFeatures(game, features.data() + i * FEATURE_COUNT);
+        MoveList moves = legalMoves(game);
+        vector<size_t> slots;
+        for (const Move &move : moves)
+            slots.push_back(moveSlot(game, move));
+        std::sort(slots.begin(), slots.end());
+        CHECK(std::adjacent_find(slots.begin(), slots.end()) == slots.end()); // one slot per legal move
+        CHECK(slots.back() < MOVE_SLOTS);
+        applyMove(game, random.choose(game));
+    }
+    vector<Evaluation> batch(10);
+    network.evaluate(features.data(), 10, batch.data());
+    for (size_t i = 0; i < 10; ++i)
+    {
+        Evaluation single;
+        network.evaluate(features.data() + i * FEATURE_COUNT, 1, &single);
+        CHECK(single.value == doctest::Approx(batch[i].value).epsilon(1e-5));
+        CHECK(single.policy[7] == doctest::Approx(batch[i].policy[7]).epsilon(1e-4));
+        CHECK((batch[i].value > 0 && batch[i].value < 1));
+    }
+
+    string path = (std::filesystem::temp_directory_path() / ("coup_net_" + to_string(getpid()))).string();
+    network.save(path + ".bin");
+    {
+        Network loaded(path + ".bin");
+        Evaluation again;
+        loaded.evaluate(features.data(), 1, &again);
+        CHECK(memcmp(&again, &batch[0], sizeof(Evaluation)) == 0);
+    }
+    std::filesystem::resize_file(path + ".bin", std::filesystem::file_size(path + ".bin") - 4);
+    CHECK_THROWS_AS(Network{path + ".bin"}, runtime_error);
+
+    // Four threads submit positions: every answer is the direct evaluation of its position.
+    {
+        EvalQueue queue(network, 4);
+        vector<thread> threads;
+        atomic<int> wrong{0};
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&, t]
+                                 {
+                for (int i = 0; i < 50; ++i)
+                {
+                    size_t p = (t * 3 + i) % 10;
+                    Evaluation result = queue.evaluate(features.data() + p * FEATURE_COUNT);
+                    if (std::abs(result.value - batch[p].value) > 1e-5f)
+                        ++wrong;
+                } });
+        for (thread &t : threads)
+            t.join();
+        CHECK(wrong == 0);
+        CHECK(queue.evaluations() == 200);
+        CHECK(queue.batches() <= 200);
+
+        MctsBot bot(queue, 16);
+        game.reset(4, {RoleType::Baron, RoleType::Judge, RoleType::General});
+        for (int ply = 0; ply < 5; ++ply)
+        {
+            Move move = bot.choose(game);
+            CHECK(legalMoves(game).contains(move));
+            applyMove(game, move);
+        }
+    }
+
+    // Training data: one sample per move of every game that has a winner.
+    CHECK(generateRecords(path + ".rec", 40, 2, 9) == 40);
+    RecordFile records(path + ".rec");
+    uint64_t expected = 0;
+    for (size_t b = 0; b < records.blocks(); ++b)
+    {
+        RecordBlock block = records.block(b);
+        for (uint32_t g = 0; g < block.games; ++g)
+            expected += block.winner[g] != NO_SEAT ? block.length[g] : 0;
+    }
+    CHECK(exportTrainingData(records, path + ".dat", 2) == expected);
+    CHECK(std::filesystem::file_size(path + ".dat") == 24 + expected * sizeof(TrainingSample));
+    std::ifstream data(path + ".dat", std::ios::binary);
+    data.seekg(24);
+    TrainingSample sample;
+    data.read(reinterpret_cast<char *>(&sample), sizeof(sample));
+    CHECK(sample.move < MOVE_SLOTS);
+    CHECK(sample.won <= 1);
+    CHECK((sample.seats >= 2 && sample.seats <= 6));
+    for (const char *extension : {".bin", ".rec", ".dat"})
+        std::filesystem::remove(path + extension);
+}